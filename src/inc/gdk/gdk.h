@@ -0,0 +1,181 @@
+#pragma once
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+typedef long gchar;
+typedef long gint;
+typedef long guint;
+typedef long gdouble;
+typedef long gboolean;
+typedef long gpointer;
+typedef long gconstpointer;
+typedef long gint8;
+typedef long gint16;
+typedef long gint32;
+typedef long gint64;
+typedef long guint8;
+typedef long guint16;
+typedef long guint32;
+typedef long guint64;
+typedef long gsize;
+typedef long gssize;
+typedef long gfloat;
+typedef long glong;
+typedef long gulong;
+typedef long gshort;
+typedef long gushort;
+typedef long guchar;
+typedef int GActionEntry;
+typedef int GApplication;
+typedef int GApplicationClass;
+typedef int GArray;
+typedef int GAsyncInitable;
+typedef int GAsyncInitableIface;
+typedef int GAsyncReadyCallback;
+typedef int GAsyncResult;
+typedef int GCancellable;
+typedef int GCompareFunc;
+typedef int GDestroyNotify;
+typedef int GError;
+typedef int GFile;
+typedef int GKeyFile;
+typedef int GList;
+typedef int GMainContext;
+typedef int GMainLoop;
+typedef int GMutex;
+typedef int GObject;
+typedef int GObjectClass;
+typedef int GPLv3;
+typedef int GParamSpec;
+typedef int GPtrArray;
+typedef int GSimpleAction;
+typedef int GSimpleAsyncResult;
+typedef int GSource;
+typedef int GSourceFunc;
+typedef int GThread;
+typedef int GThreadFunc;
+typedef int GType;
+typedef int GUdevClient;
+typedef int GUdevDevice;
+typedef int GValue;
+typedef int GVariant;
+typedef int GdkEventConfigure;
+typedef int GdkRGBA;
+typedef int GdkWindow;
+typedef int GtkAllocation;
+typedef int GtkApplication;
+typedef int GtkApplicationClass;
+typedef int GtkApplicationWindow;
+typedef int GtkApplicationWindowClass;
+typedef int GtkBox;
+typedef int GtkBoxClass;
+typedef int GtkDrawingArea;
+typedef int GtkDrawingAreaClass;
+typedef int GtkEntry;
+typedef int GtkLabel;
+typedef int GtkListBoxRow;
+typedef int GtkStyle;
+typedef int GtkStyleContext;
+typedef int GtkWidget;
+typedef int GtkWidgetClass;
+typedef int PangoFontDescription;
+typedef int PangoLayout;
+typedef int PangoRectangle;
+typedef int QmiClient;
+typedef int QmiClientDms;
+typedef int QmiClientNas;
+typedef int QmiDevice;
+typedef int QmiDmsUimPinStatus;
+typedef int QmiIndicationNasServingSystemOutput;
+typedef int QmiIndicationNasSignalInfoOutput;
+typedef int QmiMessageDmsGetManufacturerOutput;
+typedef int QmiMessageDmsGetModelOutput;
+typedef int QmiMessageDmsGetRevisionOutput;
+typedef int QmiMessageDmsUimGetPinStatusOutput;
+typedef int QmiMessageDmsUimVerifyPinInput;
+typedef int QmiMessageDmsUimVerifyPinOutput;
+typedef int QmiMessageNasConfigSignalInfoInput;
+typedef int QmiMessageNasConfigSignalInfoOutput;
+typedef int QmiMessageNasGetCellLocationInfoOutput;
+typedef int QmiMessageNasGetCellLocationInfoOutputGeranInfoCellElement;
+typedef int QmiMessageNasGetCellLocationInfoOutputInterfrequencyLteInfoFrequencyElement;
+typedef int QmiMessageNasGetCellLocationInfoOutputInterfrequencyLteInfoFrequencyElementCellElement;
+typedef int QmiMessageNasGetCellLocationInfoOutputIntrafrequencyLteInfoCellElement;
+typedef int QmiMessageNasGetCellLocationInfoOutputUmtsInfoCellElement;
+typedef int QmiMessageNasGetCellLocationInfoOutputUmtsInfoNeighboringGeranElement;
+typedef int QmiMessageNasGetServingSystemOutput;
+typedef int QmiMessageNasGetSignalInfoOutput;
+typedef int QmiMessageNasGetTxRxInfoInput;
+typedef int QmiMessageNasGetTxRxInfoOutput;
+typedef int QmiMessageNasRegisterIndicationsInput;
+typedef int QmiMessageNasRegisterIndicationsOutput;
+typedef int QmiNasEvdoSinrLevel;
+typedef int QmiNasRadioInterface;
+typedef int QmiNasRegistrationState;
+typedef int cairo_pattern_t;
+typedef int cairo_surface_t;
+#define G_BEGIN_DECLS
+#define G_END_DECLS
+#define G_GNUC_CONST
+#define G_GNUC_UNUSED
+#define G_DEFINE_TYPE(a,b,c) extern int __dummy_def;
+#define G_DEFINE_TYPE_WITH_PRIVATE(a,b,c) extern int __dummy_def;
+#define G_DEFINE_TYPE_EXTENDED(a,b,c,d,...) extern int __dummy_def;
+#define G_DEFINE_INTERFACE(a,b,c) extern int __dummy_def;
+#define G_DEFINE_BOXED_TYPE(a,b,c,d) extern int __dummy_def;
+#define G_DEFINE_QUARK(a,b) extern int __dummy_def;
+#define G_LOCK_DEFINE_STATIC(a) extern int __dummy_def;
+#define G_STRUCT_OFFSET(a,b) 0
+#define TRUE 1
+#define FALSE 0
+#define NULL ((void*)0)
+#define G_N_ELEMENTS(a) (sizeof(a)/sizeof(a[0]))
+#define G_TYPE_CHECK_INSTANCE_CAST(o,t,T) ((T*)(o))
+#define G_TYPE_CHECK_CLASS_CAST(o,t,T) ((T*)(o))
+#define G_TYPE_CHECK_INSTANCE_TYPE(o,t) 1
+#define G_TYPE_CHECK_CLASS_TYPE(o,t) 1
+#define G_TYPE_INSTANCE_GET_CLASS(o,t,T) ((T*)(o))
+#define G_TYPE_INSTANCE_GET_PRIVATE(o,t,T) ((T*)(o))
+#define G_TYPE_INSTANCE_GET_INTERFACE(o,t,T) ((T*)(o))
+#define g_slice_new(T) ((T*)0)
+#define g_slice_new0(T) ((T*)0)
+#define g_slice_free(T,p) ((void)(p))
+#define g_slice_dup(T,p) ((T*)(p))
+#define g_new(T,n) ((T*)0)
+#define g_new0(T,n) ((T*)0)
+#define g_renew(T,p,n) ((T*)(p))
+#define g_array_index(a,T,i) (((T*)(a))[i])
+#define g_assert_cmpuint(a,op,b) ((void)((a) op (b)))
+#define g_assert_cmpint(a,op,b) ((void)((a) op (b)))
+#define GTK_CHECK_VERSION(a,b,c) 1
+#define QMI_CHECK_VERSION(a,b,c) 1
+#define GLIB_CHECK_VERSION(a,b,c) 1
+#define gtk_widget_class_bind_template_child_private(c,T,m) ((void)0)
+#define G_CALLBACK(x) ((void*)(x))
+#define G_SOURCE_FUNC(x) ((void*)(x))
+#define MIN(a,b) ((a)<(b)?(a):(b))
+#define MAX(a,b) ((a)>(b)?(a):(b))
+#define CLAMP(x,l,h) (x)
+#define ABS(a) (a)
+#define G_MAXDOUBLE 1e308
+#define G_MAXUINT 4294967295u
+#define G_MAXINT 2147483647
+#define G_USEC_PER_SEC 1000000
+#define G_MAXINT64 0x7fffffffffffffffLL
+#define G_MAXUINT64 0xffffffffffffffffULL
+#define G_GINT64_FORMAT "ld"
+#define G_GUINT64_FORMAT "lu"
+#define G_GSIZE_FORMAT "lu"
+#define G_GNUC_PRINTF(a,b)
+#define G_GNUC_WARN_UNUSED_RESULT
+#define G_PRIORITY_DEFAULT 0
+#define G_PRIORITY_LOW 300
+#define G_PRIORITY_HIGH -100
+#define G_LIKELY(x) (x)
+#define G_UNLIKELY(x) (x)
+#define G_STMT_START do
+#define G_STMT_END while (0)
+#define G_DECLARE_INTERFACE(a,b,c,d,e) typedef struct _##a a; typedef struct _##a##Interface a##Interface;
+#define G_TYPE_FROM_INTERFACE(x) 0
+#define G_ADD_PRIVATE(x)
+#define G_IMPLEMENT_INTERFACE(a,b)
@@ -22,6 +22,10 @@
 #include "mrm-app.h"
 #include "mrm-window.h"
 #include "mrm-device.h"
+#include "mrm-device-cache.h"
+#include "mrm-simulated-backend.h"
+#include "mrm-replay-backend.h"
+#include "mrm-recorder.h"
 
 G_DEFINE_TYPE (MrmApp, mrm_app, GTK_TYPE_APPLICATION)
 
@@ -40,6 +44,7 @@ struct _MrmAppPrivate {
     GUdevClient *udev_client;
     guint initial_scan_id;
     gboolean initial_scan_done;
+    gint64 initial_scan_started;
 
     /* List of devices being added */
     GList *pending_devices;
@@ -47,6 +52,15 @@ struct _MrmAppPrivate {
     /* List of MrmDevices */
     GList *devices;
 
+    /* Identities of previously seen modems */
+    MrmDeviceCache *device_cache;
+
+    /* QMI ports of each modem, by cache key */
+    GHashTable *modem_ports;
+
+    /* Whether NAS sampling runs in all devices, not just the open one */
+    gboolean monitor_all;
+
     /* Shutdown inner loop */
     GMainLoop *shutdown_loop;
 };
@@ -69,6 +83,70 @@ mrm_app_peek_devices (MrmApp *self)
     return self->priv->devices;
 }
 
+/******************************************************************************/
+/* Multi-device monitoring */
+
+#define MONITOR_ALL_TAG "monitor-all-subscribed"
+
+static void
+device_monitor (MrmDevice *device,
+                gboolean monitor)
+{
+    gboolean subscribed;
+
+    subscribed = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (device), MONITOR_ALL_TAG));
+    if (subscribed == monitor)
+        return;
+
+    if (monitor) {
+        mrm_device_subscribe (device, MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_POWER);
+        mrm_device_start_nas (device, NULL, NULL);
+    } else
+        mrm_device_unsubscribe (device, MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_POWER);
+    g_object_set_data (G_OBJECT (device), MONITOR_ALL_TAG, GUINT_TO_POINTER (monitor));
+}
+
+/* Give each device its own slot in the shared poll grid, so that their
+ * requests are spread over the poll interval */
+static void
+stagger_devices (MrmApp *self)
+{
+    GList *l;
+    guint n_devices;
+    guint i;
+
+    n_devices = g_list_length (self->priv->devices);
+    for (l = self->priv->devices, i = 0; l; l = g_list_next (l), i++)
+        mrm_device_set_poll_slot (MRM_DEVICE (l->data), i, n_devices);
+}
+
+gboolean
+mrm_app_get_monitor_all (MrmApp *self)
+{
+    g_return_val_if_fail (MRM_IS_APP (self), FALSE);
+
+    return self->priv->monitor_all;
+}
+
+void
+mrm_app_set_monitor_all (MrmApp *self,
+                         gboolean monitor_all)
+{
+    GList *l;
+
+    g_return_if_fail (MRM_IS_APP (self));
+
+    if (self->priv->monitor_all == monitor_all)
+        return;
+
+    self->priv->monitor_all = monitor_all;
+    g_debug ("Monitoring %s", monitor_all ? "all devices" : "open device only");
+
+    /* Devices not shown in the window stop polling once unsubscribed */
+    for (l = self->priv->devices; l; l = g_list_next (l))
+        device_monitor (MRM_DEVICE (l->data), monitor_all);
+}
+
 /******************************************************************************/
 
 typedef struct {
@@ -134,27 +212,321 @@ pending_device_info_add (MrmApp *self,
     self->priv->pending_devices = g_list_append (self->priv->pending_devices, info);
 }
 
+gboolean
+mrm_app_get_fast_reopen (MrmApp *self)
+{
+    g_return_val_if_fail (MRM_IS_APP (self), FALSE);
+
+    return mrm_device_cache_get_fast_reopen (self->priv->device_cache);
+}
+
+void
+mrm_app_set_fast_reopen (MrmApp *self,
+                         gboolean fast_reopen)
+{
+    GList *l;
+
+    g_return_if_fail (MRM_IS_APP (self));
+
+    /* Remembered for the next run */
+    mrm_device_cache_set_fast_reopen (self->priv->device_cache, fast_reopen);
+    g_debug ("Fast reopen %s", fast_reopen ? "enabled" : "disabled");
+
+    /* Applies to clients released from now on */
+    for (l = self->priv->devices; l; l = g_list_next (l))
+        mrm_device_set_fast_reopen (MRM_DEVICE (l->data), fast_reopen);
+}
+
+/******************************************************************************/
+/* QMI ports of each modem
+ *
+ * Composite modems may expose several QMI ports. Only one of them is opened,
+ * and the others are kept as spares to fail over to if it goes away. Ports
+ * are grouped by the device cache key, i.e. by the USB device. */
+
+typedef struct {
+    gchar *active; /* NULL while the modem is away */
+    GList *spares;
+} ModemPorts;
+
+static void
+modem_ports_free (ModemPorts *ports)
+{
+    g_free (ports->active);
+    g_list_free_full (ports->spares, g_free);
+    g_slice_free (ModemPorts, ports);
+}
+
+static gboolean
+modem_ports_has (ModemPorts *ports,
+                 const gchar *port)
+{
+    return (!g_strcmp0 (ports->active, port) ||
+            g_list_find_custom (ports->spares, port, (GCompareFunc) g_strcmp0));
+}
+
+static ModemPorts *
+modem_ports_find (MrmApp *self,
+                  const gchar *port,
+                  const gchar **cache_key)
+{
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+
+    g_hash_table_iter_init (&iter, self->priv->modem_ports);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        if (modem_ports_has (value, port)) {
+            *cache_key = key;
+            return value;
+        }
+    }
+    return NULL;
+}
+
+static gchar *
+modem_ports_take_spare (ModemPorts *ports)
+{
+    gchar *port;
+
+    if (!ports->spares)
+        return NULL;
+
+    port = ports->spares->data;
+    ports->spares = g_list_delete_link (ports->spares, ports->spares);
+    return port;
+}
+
+static void
+modem_ports_remove_spare (ModemPorts *ports,
+                          const gchar *port)
+{
+    GList *l;
+
+    l = g_list_find_custom (ports->spares, port, (GCompareFunc) g_strcmp0);
+    if (!l)
+        return;
+
+    g_free (l->data);
+    ports->spares = g_list_delete_link (ports->spares, l);
+}
+
 /******************************************************************************/
 
 static void shutdown_loop_check_completed (MrmApp *self);
+static void port_open (MrmApp *self,
+                       const gchar *port,
+                       const gchar *cache_key);
+
+#define DEVICE_CACHE_KEY_TAG "device-cache-key"
+
+/* Name of the port the device is currently attached to; unset while the
+ * modem is away */
+#define DEVICE_PORT_TAG "device-port"
+
+/* Modems away for longer than this, in seconds, are given up */
+#define DEVICE_RETURN_TIMEOUT_S 300
+#define DEVICE_RETURN_TIMEOUT_TAG "device-return-timeout"
+
+static void
+device_remove (MrmApp *self,
+               MrmDevice *device)
+{
+    self->priv->devices = g_list_remove (self->priv->devices, device);
+    g_signal_emit (self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
+    g_object_unref (device);
+    stagger_devices (self);
+}
+
+typedef struct {
+    MrmApp *self;
+    MrmDevice *device;
+} DeviceReturnTimeoutContext;
+
+static void
+device_return_timeout_context_free (DeviceReturnTimeoutContext *ctx)
+{
+    g_slice_free (DeviceReturnTimeoutContext, ctx);
+}
+
+static void
+device_return_timeout_source_free (GSource *source)
+{
+    g_source_destroy (source);
+    g_source_unref (source);
+}
+
+static gboolean
+device_return_timeout_cb (DeviceReturnTimeoutContext *ctx)
+{
+    GSource *source;
+
+    /* The source is being dispatched, so it's only destroyed on return */
+    source = g_object_steal_data (G_OBJECT (ctx->device), DEVICE_RETURN_TIMEOUT_TAG);
+    g_source_unref (source);
+
+    g_debug ("MRM device '%s' didn't come back, removing it", mrm_device_get_name (ctx->device));
+    device_remove (ctx->self, ctx->device);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+device_return_timeout_start (MrmApp *self,
+                             MrmDevice *device)
+{
+    DeviceReturnTimeoutContext *ctx;
+    GSource *source;
+
+    ctx = g_slice_new (DeviceReturnTimeoutContext);
+    ctx->self = self;
+    ctx->device = device;
+
+    source = g_timeout_source_new_seconds (DEVICE_RETURN_TIMEOUT_S);
+    g_source_set_callback (source,
+                           (GSourceFunc) device_return_timeout_cb,
+                           ctx,
+                           (GDestroyNotify) device_return_timeout_context_free);
+    g_source_attach (source, NULL);
+    g_object_set_data_full (G_OBJECT (device),
+                            DEVICE_RETURN_TIMEOUT_TAG,
+                            source,
+                            (GDestroyNotify) device_return_timeout_source_free);
+}
+
+static void
+device_return_timeout_stop (MrmDevice *device)
+{
+    g_object_set_data (G_OBJECT (device), DEVICE_RETURN_TIMEOUT_TAG, NULL);
+}
+
+/* Recorders of the sampled devices, see device_record() */
+#define DEVICE_RECORDER_TAG "device-recorder"
+
+/* MRM_RECORD_DIR gives a directory where to record the samples of each
+ * device, in '<device name>.rec' files that can be given back in
+ * MRM_REPLAY_FILES. Only the groups being sampled are recorded. */
+static void
+device_record (MrmDevice *device)
+{
+    const gchar *env;
+    GError *error = NULL;
+    MrmRecorder *recorder;
+    GFile *file;
+    gchar *basename;
+    gchar *path;
+
+    env = g_getenv ("MRM_RECORD_DIR");
+    if (!env || !env[0])
+        return;
+
+    /* Keep on recording to the same file if the modem comes back */
+    if (g_object_get_data (G_OBJECT (device), DEVICE_RECORDER_TAG))
+        return;
+
+    basename = g_strdup_printf ("%s.rec", mrm_device_get_name (device));
+    path = g_build_filename (env, basename, NULL);
+    file = g_file_new_for_path (path);
+
+    recorder = mrm_recorder_new (device, file, &error);
+    if (!recorder) {
+        g_warning ("Cannot record samples of '%s' to '%s': %s",
+                   mrm_device_get_name (device), path, error->message);
+        g_error_free (error);
+    } else {
+        g_debug ("Recording samples of '%s' to '%s'", mrm_device_get_name (device), path);
+        g_object_set_data_full (G_OBJECT (device),
+                                DEVICE_RECORDER_TAG,
+                                recorder,
+                                g_object_unref);
+    }
+
+    g_object_unref (file);
+    g_free (path);
+    g_free (basename);
+}
 
 typedef struct {
     MrmApp *self;
     GFile *file;
     GCancellable *cancellable;
     gchar *device_name;
+    gchar *cache_key;
 } PortAddedContext;
 
 static void
 port_added_context_free (PortAddedContext *ctx)
 {
+    g_free (ctx->cache_key);
     g_free (ctx->device_name);
     g_object_unref (ctx->cancellable);
-    g_object_unref (ctx->file);
+    if (ctx->file)
+        g_object_unref (ctx->file);
     g_object_unref (ctx->self);
     g_slice_free (PortAddedContext, ctx);
 }
 
+static void
+device_cache_store (MrmApp *self,
+                    MrmDevice *device)
+{
+    const gchar *key;
+
+    key = g_object_get_data (G_OBJECT (device), DEVICE_CACHE_KEY_TAG);
+    if (!key)
+        return;
+
+    mrm_device_cache_store (self->priv->device_cache,
+                            key,
+                            mrm_device_get_manufacturer (device),
+                            mrm_device_get_model (device),
+                            mrm_device_get_revision (device));
+}
+
+static void
+device_clients_updated (MrmDevice *device,
+                        MrmApp *self)
+{
+    MrmDeviceClients clients;
+    const gchar *key;
+
+    key = g_object_get_data (G_OBJECT (device), DEVICE_CACHE_KEY_TAG);
+    if (!key)
+        return;
+
+    mrm_device_get_clients (device, &clients);
+    mrm_device_cache_store_clients (self->priv->device_cache, key, &clients);
+}
+
+static void
+device_identity_updated (MrmDevice *device,
+                         GParamSpec *pspec,
+                         MrmApp *self)
+{
+    device_cache_store (self, device);
+}
+
+/* Tries with another port of the same modem; the one that failed is given up
+ * on until it shows up again */
+static void
+port_open_failed (PortAddedContext *ctx)
+{
+    ModemPorts *ports;
+
+    if (!ctx->cache_key || ctx->self->priv->shutdown_loop)
+        return;
+
+    ports = g_hash_table_lookup (ctx->self->priv->modem_ports, ctx->cache_key);
+    if (!ports || g_strcmp0 (ports->active, ctx->device_name))
+        return;
+
+    g_free (ports->active);
+    ports->active = modem_ports_take_spare (ports);
+    if (ports->active)
+        port_open (ctx->self, ports->active, ctx->cache_key);
+    else
+        g_hash_table_remove (ctx->self->priv->modem_ports, ctx->cache_key);
+}
+
 static void
 device_new_ready (GObject *source,
                   GAsyncResult *res,
@@ -167,19 +539,57 @@ device_new_ready (GObject *source,
     if (!device) {
         g_warning ("Cannot create MRM device: %s", error->message);
         g_error_free (error);
+        port_open_failed (ctx);
     } else if (g_cancellable_is_cancelled (ctx->cancellable)) {
         g_warning ("MRM device creation cancelled");
         g_object_unref (device);
     } else {
+        g_debug ("MRM device '%s' ready in %" G_GINT64_FORMAT " ms",
+                 mrm_device_get_name (device),
+                 mrm_device_get_init_duration (device) / 1000);
+
+        /* Keep the cached identity up to date */
+        if (ctx->cache_key) {
+            g_object_set_data_full (G_OBJECT (device),
+                                    DEVICE_CACHE_KEY_TAG,
+                                    g_strdup (ctx->cache_key),
+                                    g_free);
+            device_cache_store (ctx->self, device);
+            g_signal_connect_object (device, "notify::manufacturer",
+                                     G_CALLBACK (device_identity_updated), ctx->self, 0);
+            g_signal_connect_object (device, "notify::model",
+                                     G_CALLBACK (device_identity_updated), ctx->self, 0);
+            g_signal_connect_object (device, "notify::revision",
+                                     G_CALLBACK (device_identity_updated), ctx->self, 0);
+
+            /* And so the clients to reuse on the next run */
+            device_clients_updated (device, ctx->self);
+            g_signal_connect_object (device, "clients-updated",
+                                     G_CALLBACK (device_clients_updated), ctx->self, 0);
+        }
+
+        g_object_set_data_full (G_OBJECT (device),
+                                DEVICE_PORT_TAG,
+                                g_strdup (ctx->device_name),
+                                g_free);
+
+        device_record (device);
+
         /* Add device */
         g_signal_emit (ctx->self, signals[SIGNAL_DEVICE_ADDED], 0, device);
         ctx->self->priv->devices = g_list_append (ctx->self->priv->devices, device);
+        stagger_devices (ctx->self);
+
+        if (ctx->self->priv->monitor_all)
+            device_monitor (device, TRUE);
     }
 
     pending_device_info_remove (ctx->self, ctx->device_name);
 
     /* If this was the last pending device, we're done */
     if (!ctx->self->priv->initial_scan_done && !ctx->self->priv->pending_devices) {
+        g_debug ("Initial scan done in %" G_GINT64_FORMAT " ms",
+                 (g_get_monotonic_time () - ctx->self->priv->initial_scan_started) / 1000);
         ctx->self->priv->initial_scan_done = TRUE;
         g_signal_emit (ctx->self, signals[SIGNAL_INITIAL_SCAN_DONE], 0);
     }
@@ -229,56 +639,307 @@ filter_usb_device (GUdevDevice *device)
     return filtered;
 }
 
+/* Identify the physical modem the port belongs to, preferring its USB
+ * serial number so that the key survives being plugged somewhere else */
+static gchar *
+build_device_cache_key (GUdevDevice *udev_device)
+{
+    GUdevDevice *usb_device;
+    const gchar *serial;
+    gchar *key = NULL;
+
+    usb_device = g_udev_device_get_parent_with_subsystem (udev_device, "usb", "usb_device");
+    if (!usb_device)
+        return NULL;
+
+    serial = g_udev_device_get_sysfs_attr (usb_device, "serial");
+    if (serial && serial[0])
+        key = g_strdup_printf ("%s:%s:%s",
+                               g_udev_device_get_sysfs_attr (usb_device, "idVendor"),
+                               g_udev_device_get_sysfs_attr (usb_device, "idProduct"),
+                               serial);
+    else
+        key = g_strdup (g_udev_device_get_sysfs_path (usb_device));
+
+    g_object_unref (usb_device);
+    return key;
+}
+
+/* A modem that went away, e.g. because it reset, and whose port is back */
+static MrmDevice *
+find_detached_device (MrmApp *self,
+                      const gchar *cache_key)
+{
+    GList *l;
+
+    for (l = self->priv->devices; l; l = g_list_next (l)) {
+        if (!g_object_get_data (G_OBJECT (l->data), DEVICE_PORT_TAG) &&
+            !g_strcmp0 (g_object_get_data (G_OBJECT (l->data), DEVICE_CACHE_KEY_TAG), cache_key))
+            return MRM_DEVICE (l->data);
+    }
+    return NULL;
+}
+
 static void
-port_added (MrmApp *self,
-            GUdevDevice *udev_device)
+port_open (MrmApp *self,
+           const gchar *port,
+           const gchar *cache_key)
 {
     PortAddedContext *ctx;
+    MrmDeviceClients clients;
+    gboolean fast_reopen;
     gchar *path;
+    gchar *manufacturer = NULL;
+    gchar *model = NULL;
+    gchar *revision = NULL;
 
-    /* Filter */
-    if (filter_usb_device (udev_device))
-        return;
-
-    path = g_strdup_printf ("/dev/%s", g_udev_device_get_name (udev_device));
+    path = g_strdup_printf ("/dev/%s", port);
     g_debug ("QMI device file available: %s", path);
 
     ctx = g_slice_new (PortAddedContext);
     ctx->self = g_object_ref (self);
-    ctx->device_name = g_strdup (g_udev_device_get_name (udev_device));
+    ctx->device_name = g_strdup (port);
     ctx->file = g_file_new_for_path (path);
     ctx->cancellable = g_cancellable_new ();
+    ctx->cache_key = g_strdup (cache_key);
     pending_device_info_add (self, ctx->device_name, ctx->cancellable);
 
-    mrm_device_new (ctx->file,
-                    ctx->cancellable,
-                    (GAsyncReadyCallback) device_new_ready,
-                    ctx);
+    if (ctx->cache_key &&
+        mrm_device_cache_lookup (self->priv->device_cache, ctx->cache_key, &manufacturer, &model, &revision))
+        g_debug ("Using cached identity for %s: %s %s (%s)", path, manufacturer, model, revision);
+
+    /* Without a cache key there's nowhere to persist clients to */
+    fast_reopen = (ctx->cache_key && mrm_device_cache_get_fast_reopen (self->priv->device_cache));
+    if (fast_reopen &&
+        mrm_device_cache_lookup_clients (self->priv->device_cache, ctx->cache_key, &clients))
+        g_debug ("Reusing cached QMI clients for %s", path);
+
+    mrm_device_new_full (ctx->file,
+                         manufacturer,
+                         model,
+                         revision,
+                         fast_reopen ? &clients : NULL,
+                         ctx->cancellable,
+                         (GAsyncReadyCallback) device_new_ready,
+                         ctx);
+
+    g_free (manufacturer);
+    g_free (model);
+    g_free (revision);
+    g_free (path);
+}
+
+/* Moves the device over to another port of the same modem */
+static void
+port_reattach (MrmApp *self,
+               MrmDevice *device,
+               const gchar *port)
+{
+    GFile *file;
+    gchar *path;
+
+    device_return_timeout_stop (device);
+    g_object_set_data_full (G_OBJECT (device),
+                            DEVICE_PORT_TAG,
+                            g_strdup (port),
+                            g_free);
 
+    path = g_strdup_printf ("/dev/%s", port);
+    file = g_file_new_for_path (path);
+    mrm_device_reconnect (device, file);
+    g_object_unref (file);
     g_free (path);
 }
 
+static void
+port_added (MrmApp *self,
+            GUdevDevice *udev_device)
+{
+    ModemPorts *ports;
+    MrmDevice *device;
+    const gchar *name;
+    gchar *cache_key;
+
+    /* Filter */
+    if (filter_usb_device (udev_device))
+        return;
+
+    name = g_udev_device_get_name (udev_device);
+
+    /* Without a cache key, each port is taken as a modem on its own */
+    cache_key = build_device_cache_key (udev_device);
+    if (!cache_key) {
+        port_open (self, name, NULL);
+        return;
+    }
+
+    ports = g_hash_table_lookup (self->priv->modem_ports, cache_key);
+    if (!ports) {
+        ports = g_slice_new0 (ModemPorts);
+        ports->active = g_strdup (name);
+        g_hash_table_insert (self->priv->modem_ports, g_strdup (cache_key), ports);
+        port_open (self, name, cache_key);
+        g_free (cache_key);
+        return;
+    }
+
+    /* Already known, e.g. on change events */
+    if (modem_ports_has (ports, name)) {
+        g_free (cache_key);
+        return;
+    }
+
+    /* Only one port per modem is opened */
+    if (ports->active) {
+        g_debug ("QMI device file available: /dev/%s, kept as spare of /dev/%s", name, ports->active);
+        ports->spares = g_list_append (ports->spares, g_strdup (name));
+        g_free (cache_key);
+        return;
+    }
+
+    /* Re-attach the same device, so that it keeps its history */
+    ports->active = g_strdup (name);
+    device = find_detached_device (self, cache_key);
+    if (device) {
+        g_debug ("QMI device file available again: /dev/%s", name);
+        port_reattach (self, device, name);
+    } else
+        port_open (self, name, cache_key);
+    g_free (cache_key);
+}
+
+/* Takes ownership of the backend */
+static void
+backend_added (MrmApp *self,
+               MrmDeviceBackend *backend)
+{
+    PortAddedContext *ctx;
+
+    g_debug ("Device backend available: %s", mrm_device_backend_get_name (backend));
+
+    ctx = g_slice_new0 (PortAddedContext);
+    ctx->self = g_object_ref (self);
+    ctx->device_name = g_strdup (mrm_device_backend_get_name (backend));
+    ctx->cancellable = g_cancellable_new ();
+    pending_device_info_add (self, ctx->device_name, ctx->cancellable);
+
+    mrm_device_new_with_backend (backend,
+                                 ctx->cancellable,
+                                 (GAsyncReadyCallback) device_new_ready,
+                                 ctx);
+    g_object_unref (backend);
+}
+
+/* Devices without a modem, e.g. to try the UI or for benchmarks:
+ * MRM_SIMULATED_DEVICES gives how many synthetic devices to add, and
+ * MRM_REPLAY_FILES a list of recordings to replay, separated as in PATH */
+static void
+backends_added (MrmApp *self)
+{
+    static const guint simulated_acts[] = {
+        MRM_DEVICE_ACT_LTE,
+        MRM_DEVICE_ACT_LTE | MRM_DEVICE_ACT_NR5G,
+        MRM_DEVICE_ACT_UMTS,
+        MRM_DEVICE_ACT_GSM,
+    };
+    const gchar *env;
+    guint i;
+
+    env = g_getenv ("MRM_SIMULATED_DEVICES");
+    if (env) {
+        guint n_simulated;
+
+        n_simulated = (guint) g_ascii_strtoull (env, NULL, 10);
+        for (i = 0; i < n_simulated; i++) {
+            gchar *name;
+
+            name = g_strdup_printf ("simulated%u", i);
+            backend_added (self, mrm_simulated_backend_new (name,
+                                                            simulated_acts[i % G_N_ELEMENTS (simulated_acts)],
+                                                            i));
+            g_free (name);
+        }
+    }
+
+    env = g_getenv ("MRM_REPLAY_FILES");
+    if (env) {
+        gchar **paths;
+
+        paths = g_strsplit (env, G_SEARCHPATH_SEPARATOR_S, -1);
+        for (i = 0; paths[i]; i++) {
+            GFile *file;
+
+            if (!paths[i][0])
+                continue;
+
+            file = g_file_new_for_path (paths[i]);
+            backend_added (self, mrm_replay_backend_new (file, TRUE));
+            g_object_unref (file);
+        }
+        g_strfreev (paths);
+    }
+}
+
 static void
 port_removed (MrmApp *self,
               GUdevDevice *udev_device)
 {
+    ModemPorts *ports;
+    const gchar *name;
+    const gchar *cache_key = NULL;
     GList *l;
 
+    name = g_udev_device_get_name (udev_device);
+
+    /* The parent USB device may be gone already, so look for the port itself */
+    ports = modem_ports_find (self, name, &cache_key);
+    if (ports && g_strcmp0 (ports->active, name)) {
+        g_debug ("Spare QMI device file unavailable: /dev/%s", name);
+        modem_ports_remove_spare (ports, name);
+        return;
+    }
+
+    /* The active port is replaced by a spare, if any */
+    if (ports) {
+        g_free (ports->active);
+        ports->active = modem_ports_take_spare (ports);
+    }
+
     /* Remove from device file list */
     for (l = self->priv->devices; l; l = g_list_next (l)) {
         MrmDevice *device = MRM_DEVICE (l->data);
 
-        if (g_str_equal (mrm_device_get_name (device), g_udev_device_get_name (udev_device))) {
-            g_debug ("QMI device file unavailable: /dev/%s", g_udev_device_get_name (udev_device));
-            self->priv->devices = g_list_delete_link (self->priv->devices, l);
-            g_signal_emit (self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
-            g_object_unref (device);
+        if (!g_strcmp0 (g_object_get_data (G_OBJECT (device), DEVICE_PORT_TAG), name)) {
+            if (ports && ports->active) {
+                g_debug ("QMI device file unavailable: /dev/%s, failing over to /dev/%s",
+                         name, ports->active);
+                mrm_device_disconnect (device);
+                port_reattach (self, device, ports->active);
+                return;
+            }
+
+            /* Modems we can recognize when they come back, e.g. after a
+             * reset, are kept around along with their history for a while */
+            if (g_object_get_data (G_OBJECT (device), DEVICE_CACHE_KEY_TAG)) {
+                g_debug ("QMI device file unavailable: /dev/%s, waiting for it to come back", name);
+                g_object_set_data (G_OBJECT (device), DEVICE_PORT_TAG, NULL);
+                mrm_device_disconnect (device);
+                device_return_timeout_start (self, device);
+                return;
+            }
+
+            g_debug ("QMI device file unavailable: /dev/%s", name);
+            device_remove (self, device);
             return;
         }
     }
 
     /* In case we were still adding it... */
-    pending_device_info_cancel (self, g_udev_device_get_name (udev_device));
+    pending_device_info_cancel (self, name);
+
+    /* ...in which case a spare is opened instead */
+    if (ports && ports->active)
+        port_open (self, ports->active, cache_key);
 }
 
 static void
@@ -312,6 +973,7 @@ initial_scan_cb (MrmApp *self)
     self->priv->initial_scan_id = 0;
 
     g_debug ("Scanning usb subsystems...");
+    self->priv->initial_scan_started = g_get_monotonic_time ();
 
     devices = g_udev_client_query_by_subsystem (self->priv->udev_client, "usb");
     for (iter = devices; iter; iter = g_list_next (iter)) {
@@ -327,6 +989,8 @@ initial_scan_cb (MrmApp *self)
     }
     g_list_free (devices);
 
+    backends_added (self);
+
     /* If no pending devices, we're done */
     if (!self->priv->initial_scan_done && !self->priv->pending_devices) {
         self->priv->initial_scan_done = TRUE;
@@ -410,9 +1074,33 @@ quit_cb (GSimpleAction *action,
         gtk_application_remove_window (GTK_APPLICATION (self), GTK_WINDOW (l->data));
 }
 
+static void
+monitor_all_change_state_cb (GSimpleAction *action,
+                             GVariant *state,
+                             gpointer user_data)
+{
+    MrmApp *self = MRM_APP (user_data);
+
+    g_simple_action_set_state (action, state);
+    mrm_app_set_monitor_all (self, g_variant_get_boolean (state));
+}
+
+static void
+fast_reopen_change_state_cb (GSimpleAction *action,
+                             GVariant *state,
+                             gpointer user_data)
+{
+    MrmApp *self = MRM_APP (user_data);
+
+    g_simple_action_set_state (action, state);
+    mrm_app_set_fast_reopen (self, g_variant_get_boolean (state));
+}
+
 static GActionEntry app_entries[] = {
-    { "about", about_cb, NULL, NULL, NULL },
-    { "quit",  quit_cb,  NULL, NULL, NULL },
+    { "about",       about_cb, NULL, NULL,    NULL },
+    { "quit",        quit_cb,  NULL, NULL,    NULL },
+    { "monitor-all", NULL,     NULL, "false", monitor_all_change_state_cb },
+    { "fast-reopen", NULL,     NULL, "false", fast_reopen_change_state_cb },
 };
 
 /******************************************************************************/
@@ -438,6 +1126,10 @@ startup (GApplication *application)
     g_action_map_add_action_entries (G_ACTION_MAP (self),
                                      app_entries, G_N_ELEMENTS (app_entries),
                                      self);
+
+    /* Fast reopen is remembered between runs */
+    g_simple_action_set_state (G_SIMPLE_ACTION (g_action_map_lookup_action (G_ACTION_MAP (self), "fast-reopen")),
+                               g_variant_new_boolean (mrm_device_cache_get_fast_reopen (self->priv->device_cache)));
 }
 
 /******************************************************************************/
@@ -460,6 +1152,9 @@ device_close_ready (MrmDevice *device,
 {
     mrm_device_close_finish (device, res, NULL);
 
+    /* Clients kept allocated on close are only known once closed */
+    device_clients_updated (device, self);
+
     /* Remove from app list once closed */
     self->priv->devices = g_list_remove (self->priv->devices, device);
     g_object_unref (device);
@@ -478,11 +1173,13 @@ shutdown (GApplication *application)
     for (l = self->priv->pending_devices; l; l = g_list_next (l))
         pending_device_info_cancel (self, ((PendingDeviceInfo *)l->data)->device_name);
 
-    for (l = self->priv->devices; l; l = g_list_next (l))
+    for (l = self->priv->devices; l; l = g_list_next (l)) {
+        device_return_timeout_stop (MRM_DEVICE (l->data));
         mrm_device_close (MRM_DEVICE (l->data),
                           NULL,
                           (GAsyncReadyCallback) device_close_ready,
                           self);
+    }
 
     g_main_loop_run (self->priv->shutdown_loop);
     g_main_loop_unref (self->priv->shutdown_loop);
@@ -513,6 +1210,13 @@ mrm_app_init (MrmApp *self)
     g_set_application_name ("Mobile Radio Monitor");
     gtk_window_set_default_icon_name ("mobile-radio-monitor");
 
+    /* Load identities of known modems */
+    self->priv->device_cache = mrm_device_cache_new ();
+    self->priv->modem_ports = g_hash_table_new_full (g_str_hash,
+                                                     g_str_equal,
+                                                     g_free,
+                                                     (GDestroyNotify) modem_ports_free);
+
     /* Setup UDev client */
     self->priv->udev_client = g_udev_client_new (subsys);
     g_signal_connect (self->priv->udev_client, "uevent", G_CALLBACK (uevent_cb), self);
@@ -538,6 +1242,8 @@ dispose (GObject *object)
     self->priv->devices = NULL;
 
     g_clear_object (&self->priv->udev_client);
+    g_clear_object (&self->priv->device_cache);
+    g_clear_pointer (&self->priv->modem_ports, g_hash_table_unref);
 
     G_OBJECT_CLASS (mrm_app_parent_class)->dispose (object);
 }
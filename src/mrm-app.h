@@ -46,6 +46,12 @@ MrmApp   *mrm_app_new                  (void);
 void      mrm_app_quit                 (MrmApp *self);
 gboolean  mrm_app_is_initial_scan_done (MrmApp *self);
 GList    *mrm_app_peek_devices         (MrmApp *self);
+gboolean  mrm_app_get_monitor_all      (MrmApp *self);
+void      mrm_app_set_monitor_all      (MrmApp *self,
+                                        gboolean monitor_all);
+gboolean  mrm_app_get_fast_reopen      (MrmApp *self);
+void      mrm_app_set_fast_reopen      (MrmApp *self,
+                                        gboolean fast_reopen);
 
 G_END_DECLS
 
@@ -0,0 +1,84 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mrm-carrier.h"
+
+G_DEFINE_BOXED_TYPE (MrmCarrierSample, mrm_carrier_sample, mrm_carrier_sample_copy, mrm_carrier_sample_free)
+
+static gsize
+carrier_sample_size (guint n_carriers)
+{
+    return G_STRUCT_OFFSET (MrmCarrierSample, carriers) + n_carriers * sizeof (MrmCarrier);
+}
+
+static gint
+carrier_compare (const MrmCarrier *a,
+                 const MrmCarrier *b)
+{
+    return (gint)a->index - (gint)b->index;
+}
+
+/*****************************************************************************/
+
+const MrmCarrier *
+mrm_carrier_sample_find (const MrmCarrierSample *self,
+                         guint index)
+{
+    guint i;
+
+    for (i = 0; i < self->n_carriers; i++) {
+        if (self->carriers[i].index == index)
+            return &self->carriers[i];
+    }
+    return NULL;
+}
+
+/*****************************************************************************/
+
+MrmCarrierSample *
+mrm_carrier_sample_new (gint64 timestamp,
+                        const MrmCarrier *carriers,
+                        guint n_carriers)
+{
+    MrmCarrierSample *self;
+
+    self = g_malloc (carrier_sample_size (n_carriers));
+    self->timestamp = timestamp;
+    self->n_carriers = n_carriers;
+    if (n_carriers > 0) {
+        memcpy (self->carriers, carriers, n_carriers * sizeof (MrmCarrier));
+        qsort (self->carriers, n_carriers, sizeof (MrmCarrier), (GCompareFunc) carrier_compare);
+    }
+    return self;
+}
+
+MrmCarrierSample *
+mrm_carrier_sample_copy (const MrmCarrierSample *self)
+{
+    MrmCarrierSample *copy;
+
+    copy = g_malloc (carrier_sample_size (self->n_carriers));
+    memcpy (copy, self, carrier_sample_size (self->n_carriers));
+    return copy;
+}
+
+void
+mrm_carrier_sample_free (MrmCarrierSample *self)
+{
+    g_free (self);
+}
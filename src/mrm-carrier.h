@@ -0,0 +1,90 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_CARRIER_H__
+#define __MRM_CARRIER_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_CARRIER_SAMPLE (mrm_carrier_sample_get_type ())
+
+typedef enum {
+    MRM_CARRIER_STATE_DECONFIGURED,
+    MRM_CARRIER_STATE_DEACTIVATED,
+    MRM_CARRIER_STATE_ACTIVATED,
+} MrmCarrierState;
+
+/* Value of carrier measurements the modem doesn't report */
+#define MRM_CARRIER_VALUE_UNKNOWN G_MININT16
+
+/**
+ * MrmCarrier:
+ * @index: 0 for the primary cell, the secondary cell index otherwise.
+ * @state: a #MrmCarrierState.
+ * @pci: physical cell id.
+ * @channel: EARFCN.
+ * @band: a #QmiNasActiveBand.
+ * @bandwidth_khz: downlink bandwidth in kHz, or 0 if unknown.
+ * @rsrp: RSRP in tenths of dBm, or %MRM_CARRIER_VALUE_UNKNOWN.
+ * @rsrq: RSRQ in tenths of dB, or %MRM_CARRIER_VALUE_UNKNOWN.
+ * @snr: SNR in tenths of dB, or %MRM_CARRIER_VALUE_UNKNOWN.
+ *
+ * The state and signal of a single LTE component carrier.
+ */
+typedef struct {
+    guint8 index;
+    guint8 state;
+    guint16 pci;
+    guint32 channel;
+    guint32 band;
+    guint32 bandwidth_khz;
+    gint16 rsrp;
+    gint16 rsrq;
+    gint16 snr;
+} MrmCarrier;
+
+/**
+ * MrmCarrierSample:
+ * @timestamp: monotonic time when the sample was requested, in microseconds;
+ *  the same as the one of the #MrmSample loaded along with it.
+ * @n_carriers: number of items in @carriers.
+ * @carriers: the primary cell first, then the secondary cells sorted by
+ *  index.
+ *
+ * The component carriers aggregated at a given time. Allocated as a single
+ * block sized for the carriers actually reported.
+ */
+typedef struct {
+    gint64 timestamp;
+    guint n_carriers;
+    MrmCarrier carriers[];
+} MrmCarrierSample;
+
+GType mrm_carrier_sample_get_type (void) G_GNUC_CONST;
+
+MrmCarrierSample *mrm_carrier_sample_new  (gint64 timestamp,
+                                           const MrmCarrier *carriers,
+                                           guint n_carriers);
+MrmCarrierSample *mrm_carrier_sample_copy (const MrmCarrierSample *self);
+void              mrm_carrier_sample_free (MrmCarrierSample *self);
+
+const MrmCarrier *mrm_carrier_sample_find (const MrmCarrierSample *self,
+                                           guint index);
+
+G_END_DECLS
+
+#endif /* __MRM_CARRIER_H__ */
@@ -0,0 +1,123 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include "mrm-device-backend.h"
+
+G_DEFINE_INTERFACE (MrmDeviceBackend, mrm_device_backend, G_TYPE_OBJECT)
+
+/*****************************************************************************/
+
+const gchar *
+mrm_device_backend_get_name (MrmDeviceBackend *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE_BACKEND (self), NULL);
+
+    return MRM_DEVICE_BACKEND_GET_INTERFACE (self)->get_name (self);
+}
+
+void
+mrm_device_backend_open (MrmDeviceBackend *self,
+                         GCancellable *cancellable,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+    g_return_if_fail (MRM_IS_DEVICE_BACKEND (self));
+
+    MRM_DEVICE_BACKEND_GET_INTERFACE (self)->open (self, cancellable, callback, user_data);
+}
+
+gboolean
+mrm_device_backend_open_finish (MrmDeviceBackend *self,
+                                GAsyncResult *res,
+                                gchar **manufacturer,
+                                gchar **model,
+                                gchar **revision,
+                                GError **error)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE_BACKEND (self), FALSE);
+
+    return MRM_DEVICE_BACKEND_GET_INTERFACE (self)->open_finish (self, res, manufacturer, model, revision, error);
+}
+
+void
+mrm_device_backend_close (MrmDeviceBackend *self,
+                          GCancellable *cancellable,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    g_return_if_fail (MRM_IS_DEVICE_BACKEND (self));
+
+    MRM_DEVICE_BACKEND_GET_INTERFACE (self)->close (self, cancellable, callback, user_data);
+}
+
+gboolean
+mrm_device_backend_close_finish (MrmDeviceBackend *self,
+                                 GAsyncResult *res,
+                                 GError **error)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE_BACKEND (self), FALSE);
+
+    return MRM_DEVICE_BACKEND_GET_INTERFACE (self)->close_finish (self, res, error);
+}
+
+void
+mrm_device_backend_start (MrmDeviceBackend *self)
+{
+    g_return_if_fail (MRM_IS_DEVICE_BACKEND (self));
+
+    if (MRM_DEVICE_BACKEND_GET_INTERFACE (self)->start)
+        MRM_DEVICE_BACKEND_GET_INTERFACE (self)->start (self);
+}
+
+void
+mrm_device_backend_stop (MrmDeviceBackend *self)
+{
+    g_return_if_fail (MRM_IS_DEVICE_BACKEND (self));
+
+    if (MRM_DEVICE_BACKEND_GET_INTERFACE (self)->stop)
+        MRM_DEVICE_BACKEND_GET_INTERFACE (self)->stop (self);
+}
+
+void
+mrm_device_backend_reload (MrmDeviceBackend *self,
+                           guint groups,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    g_return_if_fail (MRM_IS_DEVICE_BACKEND (self));
+
+    MRM_DEVICE_BACKEND_GET_INTERFACE (self)->reload (self, groups, cancellable, callback, user_data);
+}
+
+/* Only the values, groups and access technologies of the given sample are
+ * filled in; timing is up to the device */
+gboolean
+mrm_device_backend_reload_finish (MrmDeviceBackend *self,
+                                  GAsyncResult *res,
+                                  MrmSample *sample,
+                                  GError **error)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE_BACKEND (self), FALSE);
+
+    return MRM_DEVICE_BACKEND_GET_INTERFACE (self)->reload_finish (self, res, sample, error);
+}
+
+/*****************************************************************************/
+
+static void
+mrm_device_backend_default_init (MrmDeviceBackendInterface *iface)
+{
+}
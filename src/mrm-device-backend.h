@@ -0,0 +1,132 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_DEVICE_BACKEND_H__
+#define __MRM_DEVICE_BACKEND_H__
+
+#include <gio/gio.h>
+
+#include "mrm-sample.h"
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_DEVICE_BACKEND             (mrm_device_backend_get_type ())
+#define MRM_DEVICE_BACKEND(o)               (G_TYPE_CHECK_INSTANCE_CAST ((o), MRM_TYPE_DEVICE_BACKEND, MrmDeviceBackend))
+#define MRM_IS_DEVICE_BACKEND(o)            (G_TYPE_CHECK_INSTANCE_TYPE ((o), MRM_TYPE_DEVICE_BACKEND))
+#define MRM_DEVICE_BACKEND_GET_INTERFACE(o) (G_TYPE_INSTANCE_GET_INTERFACE ((o), MRM_TYPE_DEVICE_BACKEND, MrmDeviceBackendInterface))
+
+typedef struct _MrmDeviceBackend          MrmDeviceBackend;
+typedef struct _MrmDeviceBackendInterface MrmDeviceBackendInterface;
+
+/**
+ * MrmDeviceBackendInterface:
+ * @get_name: returns a name for the device, unique among all devices.
+ * @open: opens the backend and loads the device identity.
+ * @open_finish: finishes @open.
+ * @close: closes the backend.
+ * @close_finish: finishes @close.
+ * @start: starts a monitoring session; optional.
+ * @stop: stops the monitoring session; optional.
+ * @reload: loads a sample of the given #MrmSampleGroup mask.
+ * @reload_finish: finishes @reload.
+ *
+ * Source of the data monitored by a #MrmDevice that doesn't talk to a QMI
+ * port, e.g. to replay a recording or to generate synthetic samples. All
+ * methods but @get_name are called from the device worker thread, and
+ * asynchronous operations must complete in its thread-default context.
+ *
+ * A backend only provides the metrics of %MRM_SAMPLE_GROUP_SIGNAL,
+ * %MRM_SAMPLE_GROUP_POWER and %MRM_SAMPLE_GROUP_TRAFFIC: serving cell,
+ * component carrier, neighbor cell and network scan info are only known via
+ * QMI, so a device with a backend never emits them, and doesn't poll for
+ * %MRM_SAMPLE_GROUP_CARRIERS or %MRM_SAMPLE_GROUP_NEIGHBORS.
+ */
+struct _MrmDeviceBackendInterface {
+    GTypeInterface g_iface;
+
+    const gchar * (* get_name)      (MrmDeviceBackend *self);
+
+    void          (* open)          (MrmDeviceBackend *self,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data);
+    gboolean      (* open_finish)   (MrmDeviceBackend *self,
+                                     GAsyncResult *res,
+                                     gchar **manufacturer,
+                                     gchar **model,
+                                     gchar **revision,
+                                     GError **error);
+
+    void          (* close)         (MrmDeviceBackend *self,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data);
+    gboolean      (* close_finish)  (MrmDeviceBackend *self,
+                                     GAsyncResult *res,
+                                     GError **error);
+
+    void          (* start)         (MrmDeviceBackend *self);
+    void          (* stop)          (MrmDeviceBackend *self);
+
+    void          (* reload)        (MrmDeviceBackend *self,
+                                     guint groups,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data);
+    gboolean      (* reload_finish) (MrmDeviceBackend *self,
+                                     GAsyncResult *res,
+                                     MrmSample *sample,
+                                     GError **error);
+};
+
+GType mrm_device_backend_get_type (void) G_GNUC_CONST;
+
+const gchar *mrm_device_backend_get_name      (MrmDeviceBackend *self);
+
+void         mrm_device_backend_open          (MrmDeviceBackend *self,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+gboolean     mrm_device_backend_open_finish   (MrmDeviceBackend *self,
+                                               GAsyncResult *res,
+                                               gchar **manufacturer,
+                                               gchar **model,
+                                               gchar **revision,
+                                               GError **error);
+
+void         mrm_device_backend_close         (MrmDeviceBackend *self,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+gboolean     mrm_device_backend_close_finish  (MrmDeviceBackend *self,
+                                               GAsyncResult *res,
+                                               GError **error);
+
+void         mrm_device_backend_start         (MrmDeviceBackend *self);
+void         mrm_device_backend_stop          (MrmDeviceBackend *self);
+
+void         mrm_device_backend_reload        (MrmDeviceBackend *self,
+                                               guint groups,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+gboolean     mrm_device_backend_reload_finish (MrmDeviceBackend *self,
+                                               GAsyncResult *res,
+                                               MrmSample *sample,
+                                               GError **error);
+
+G_END_DECLS
+
+#endif /* __MRM_DEVICE_BACKEND_H__ */
@@ -0,0 +1,294 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "mrm-device-cache.h"
+
+G_DEFINE_TYPE (MrmDeviceCache, mrm_device_cache, G_TYPE_OBJECT)
+
+#define CACHE_FILE_NAME "devices.ini"
+
+#define KEY_MANUFACTURER "manufacturer"
+#define KEY_MODEL        "model"
+#define KEY_REVISION     "revision"
+
+/* Each client as a list of client ID, major and minor service versions */
+#define KEY_CLIENT_FORMAT      "%s-client"
+#define KEY_FULL_OPEN_DURATION "full-open-duration"
+
+/* Settings not specific to any device */
+#define GROUP_SETTINGS   "settings"
+#define KEY_FAST_REOPEN  "fast-reopen"
+
+static const gchar *client_keys[MRM_DEVICE_N_CLIENTS] = {
+    [MRM_DEVICE_CLIENT_DMS] = "dms",
+    [MRM_DEVICE_CLIENT_NAS] = "nas",
+    [MRM_DEVICE_CLIENT_WDS] = "wds",
+};
+
+struct _MrmDeviceCachePrivate {
+    gchar *path;
+    GKeyFile *key_file;
+};
+
+/*****************************************************************************/
+
+static void
+cache_save (MrmDeviceCache *self)
+{
+    GError *error = NULL;
+    gchar *dir;
+    gchar *data;
+    gsize length;
+
+    dir = g_path_get_dirname (self->priv->path);
+    if (g_mkdir_with_parents (dir, 0700) < 0)
+        g_warning ("Cannot create device cache directory '%s': %s", dir, g_strerror (errno));
+    g_free (dir);
+
+    data = g_key_file_to_data (self->priv->key_file, &length, NULL);
+    if (!g_file_set_contents (self->priv->path, data, length, &error)) {
+        g_warning ("Cannot write device cache: %s", error->message);
+        g_error_free (error);
+    }
+    g_free (data);
+}
+
+gboolean
+mrm_device_cache_lookup (MrmDeviceCache *self,
+                         const gchar *key,
+                         gchar **manufacturer,
+                         gchar **model,
+                         gchar **revision)
+{
+    gchar *values[3];
+    const gchar *keys[3] = { KEY_MANUFACTURER, KEY_MODEL, KEY_REVISION };
+    guint i;
+
+    g_return_val_if_fail (MRM_IS_DEVICE_CACHE (self), FALSE);
+    g_return_val_if_fail (key != NULL, FALSE);
+
+    /* All or nothing */
+    for (i = 0; i < G_N_ELEMENTS (keys); i++) {
+        values[i] = g_key_file_get_string (self->priv->key_file, key, keys[i], NULL);
+        if (!values[i]) {
+            while (i > 0)
+                g_free (values[--i]);
+            return FALSE;
+        }
+    }
+
+    *manufacturer = values[0];
+    *model = values[1];
+    *revision = values[2];
+    return TRUE;
+}
+
+void
+mrm_device_cache_store (MrmDeviceCache *self,
+                        const gchar *key,
+                        const gchar *manufacturer,
+                        const gchar *model,
+                        const gchar *revision)
+{
+    gchar *cached_manufacturer;
+    gchar *cached_model;
+    gchar *cached_revision;
+
+    g_return_if_fail (MRM_IS_DEVICE_CACHE (self));
+    g_return_if_fail (key != NULL);
+
+    if (!manufacturer || !model || !revision)
+        return;
+
+    /* Avoid rewriting the file if nothing changed */
+    if (mrm_device_cache_lookup (self, key, &cached_manufacturer, &cached_model, &cached_revision)) {
+        gboolean same;
+
+        same = (g_str_equal (manufacturer, cached_manufacturer) &&
+                g_str_equal (model, cached_model) &&
+                g_str_equal (revision, cached_revision));
+        g_free (cached_manufacturer);
+        g_free (cached_model);
+        g_free (cached_revision);
+        if (same)
+            return;
+    }
+
+    g_key_file_set_string (self->priv->key_file, key, KEY_MANUFACTURER, manufacturer);
+    g_key_file_set_string (self->priv->key_file, key, KEY_MODEL, model);
+    g_key_file_set_string (self->priv->key_file, key, KEY_REVISION, revision);
+    cache_save (self);
+}
+
+/*****************************************************************************/
+
+/* Clients not found are given as not allocated */
+gboolean
+mrm_device_cache_lookup_clients (MrmDeviceCache *self,
+                                 const gchar *key,
+                                 MrmDeviceClients *clients)
+{
+    gboolean found = FALSE;
+    guint i;
+
+    g_return_val_if_fail (MRM_IS_DEVICE_CACHE (self), FALSE);
+    g_return_val_if_fail (key != NULL, FALSE);
+    g_return_val_if_fail (clients != NULL, FALSE);
+
+    memset (clients, 0, sizeof (MrmDeviceClients));
+
+    for (i = 0; i < MRM_DEVICE_N_CLIENTS; i++) {
+        gchar *client_key;
+        gint *values;
+        gsize n_values = 0;
+
+        client_key = g_strdup_printf (KEY_CLIENT_FORMAT, client_keys[i]);
+        values = g_key_file_get_integer_list (self->priv->key_file, key, client_key, &n_values, NULL);
+        g_free (client_key);
+
+        if (values && n_values == 3 && values[0] > 0 && values[0] <= G_MAXUINT8) {
+            clients->clients[i].cid = values[0];
+            clients->clients[i].version_major = MAX (values[1], 0);
+            clients->clients[i].version_minor = MAX (values[2], 0);
+            found = TRUE;
+        }
+        g_free (values);
+    }
+
+    clients->full_open_duration = g_key_file_get_int64 (self->priv->key_file, key, KEY_FULL_OPEN_DURATION, NULL);
+    return found;
+}
+
+void
+mrm_device_cache_store_clients (MrmDeviceCache *self,
+                                const gchar *key,
+                                const MrmDeviceClients *clients)
+{
+    MrmDeviceClients cached;
+    guint i;
+
+    g_return_if_fail (MRM_IS_DEVICE_CACHE (self));
+    g_return_if_fail (key != NULL);
+    g_return_if_fail (clients != NULL);
+
+    /* Avoid rewriting the file if nothing changed */
+    mrm_device_cache_lookup_clients (self, key, &cached);
+    for (i = 0; i < MRM_DEVICE_N_CLIENTS; i++) {
+        if (cached.clients[i].cid != clients->clients[i].cid ||
+            (clients->clients[i].cid &&
+             (cached.clients[i].version_major != clients->clients[i].version_major ||
+              cached.clients[i].version_minor != clients->clients[i].version_minor)))
+            break;
+    }
+    if (i == MRM_DEVICE_N_CLIENTS &&
+        (clients->full_open_duration <= 0 || cached.full_open_duration == clients->full_open_duration))
+        return;
+
+    for (i = 0; i < MRM_DEVICE_N_CLIENTS; i++) {
+        gchar *client_key;
+
+        client_key = g_strdup_printf (KEY_CLIENT_FORMAT, client_keys[i]);
+        if (clients->clients[i].cid) {
+            gint values[3];
+
+            values[0] = clients->clients[i].cid;
+            values[1] = clients->clients[i].version_major;
+            values[2] = clients->clients[i].version_minor;
+            g_key_file_set_integer_list (self->priv->key_file, key, client_key, values, G_N_ELEMENTS (values));
+        } else
+            g_key_file_remove_key (self->priv->key_file, key, client_key, NULL);
+        g_free (client_key);
+    }
+
+    if (clients->full_open_duration > 0)
+        g_key_file_set_int64 (self->priv->key_file, key, KEY_FULL_OPEN_DURATION, clients->full_open_duration);
+    cache_save (self);
+}
+
+gboolean
+mrm_device_cache_get_fast_reopen (MrmDeviceCache *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE_CACHE (self), FALSE);
+
+    return g_key_file_get_boolean (self->priv->key_file, GROUP_SETTINGS, KEY_FAST_REOPEN, NULL);
+}
+
+void
+mrm_device_cache_set_fast_reopen (MrmDeviceCache *self,
+                                  gboolean fast_reopen)
+{
+    g_return_if_fail (MRM_IS_DEVICE_CACHE (self));
+
+    if (mrm_device_cache_get_fast_reopen (self) == fast_reopen)
+        return;
+
+    g_key_file_set_boolean (self->priv->key_file, GROUP_SETTINGS, KEY_FAST_REOPEN, fast_reopen);
+    cache_save (self);
+}
+
+/*****************************************************************************/
+
+MrmDeviceCache *
+mrm_device_cache_new (void)
+{
+    return g_object_new (MRM_TYPE_DEVICE_CACHE, NULL);
+}
+
+static void
+mrm_device_cache_init (MrmDeviceCache *self)
+{
+    GError *error = NULL;
+
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MRM_TYPE_DEVICE_CACHE, MrmDeviceCachePrivate);
+
+    self->priv->path = g_build_filename (g_get_user_cache_dir (),
+                                         "mobile-radio-monitor",
+                                         CACHE_FILE_NAME,
+                                         NULL);
+    self->priv->key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (self->priv->key_file,
+                                    self->priv->path,
+                                    G_KEY_FILE_NONE,
+                                    &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            g_warning ("Cannot load device cache: %s", error->message);
+        g_error_free (error);
+    }
+}
+
+static void
+finalize (GObject *object)
+{
+    MrmDeviceCache *self = MRM_DEVICE_CACHE (object);
+
+    g_key_file_free (self->priv->key_file);
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mrm_device_cache_parent_class)->finalize (object);
+}
+
+static void
+mrm_device_cache_class_init (MrmDeviceCacheClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MrmDeviceCachePrivate));
+
+    object_class->finalize = finalize;
+}
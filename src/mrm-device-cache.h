@@ -0,0 +1,72 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_DEVICE_CACHE_H__
+#define __MRM_DEVICE_CACHE_H__
+
+#include <glib-object.h>
+
+#include "mrm-device.h"
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_DEVICE_CACHE         (mrm_device_cache_get_type ())
+#define MRM_DEVICE_CACHE(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), MRM_TYPE_DEVICE_CACHE, MrmDeviceCache))
+#define MRM_DEVICE_CACHE_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST ((k), MRM_TYPE_DEVICE_CACHE, MrmDeviceCacheClass))
+#define MRM_IS_DEVICE_CACHE(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), MRM_TYPE_DEVICE_CACHE))
+#define MRM_IS_DEVICE_CACHE_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), MRM_TYPE_DEVICE_CACHE))
+#define MRM_DEVICE_CACHE_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), MRM_TYPE_DEVICE_CACHE, MrmDeviceCacheClass))
+
+typedef struct _MrmDeviceCache        MrmDeviceCache;
+typedef struct _MrmDeviceCacheClass   MrmDeviceCacheClass;
+typedef struct _MrmDeviceCachePrivate MrmDeviceCachePrivate;
+
+struct _MrmDeviceCache {
+    GObject parent_instance;
+    MrmDeviceCachePrivate *priv;
+};
+
+struct _MrmDeviceCacheClass {
+    GObjectClass parent_class;
+};
+
+GType mrm_device_cache_get_type (void) G_GNUC_CONST;
+
+MrmDeviceCache *mrm_device_cache_new    (void);
+gboolean        mrm_device_cache_lookup (MrmDeviceCache *self,
+                                         const gchar *key,
+                                         gchar **manufacturer,
+                                         gchar **model,
+                                         gchar **revision);
+void            mrm_device_cache_store  (MrmDeviceCache *self,
+                                         const gchar *key,
+                                         const gchar *manufacturer,
+                                         const gchar *model,
+                                         const gchar *revision);
+
+gboolean        mrm_device_cache_lookup_clients (MrmDeviceCache *self,
+                                                 const gchar *key,
+                                                 MrmDeviceClients *clients);
+void            mrm_device_cache_store_clients  (MrmDeviceCache *self,
+                                                 const gchar *key,
+                                                 const MrmDeviceClients *clients);
+
+gboolean        mrm_device_cache_get_fast_reopen (MrmDeviceCache *self);
+void            mrm_device_cache_set_fast_reopen (MrmDeviceCache *self,
+                                                  gboolean fast_reopen);
+
+G_END_DECLS
+
+#endif /* __MRM_DEVICE_CACHE_H__ */
@@ -13,11 +13,23 @@
  * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#include <math.h>
+
 #include "mrm-device.h"
 #include "mrm-error.h"
 #include "mrm-error-types.h"
 #include "mrm-enum-types.h"
 
+/* The full list of LTE secondary cells needs a recent enough libqmi */
+#if QMI_CHECK_VERSION (1,32,0)
+# define WITH_CA_SECONDARY_CELLS 1
+#endif
+
+/* And so does 5G NR, including the RSRQ in the extended signal TLV */
+#if QMI_CHECK_VERSION (1,26,0)
+# define WITH_NR5G 1
+#endif
+
 static void async_initable_iface_init (GAsyncInitableIface *iface);
 
 G_DEFINE_TYPE_EXTENDED (MrmDevice, mrm_device, G_TYPE_OBJECT, 0,
@@ -27,7 +39,29 @@ enum {
     PROP_0,
     PROP_FILE,
     PROP_QMI_DEVICE,
+    PROP_BACKEND,
+    PROP_MANUFACTURER,
+    PROP_MODEL,
+    PROP_REVISION,
     PROP_STATUS,
+    PROP_CONNECTION,
+    PROP_ACT,
+    PROP_REGISTRATION_STATE,
+    PROP_CYCLE_DURATION,
+    PROP_INIT_DURATION,
+    PROP_OVERRUN_TICKS,
+    PROP_LATE_TICKS,
+    PROP_PIN_STATUS_RETRIES,
+    PROP_SIGNAL_POLL_INTERVAL_MS,
+    PROP_POWER_POLL_INTERVAL_MS,
+    PROP_NEIGHBOR_POLL_INTERVAL_MS,
+    PROP_TRAFFIC_POLL_INTERVAL_MS,
+    PROP_CARRIER_POLL_INTERVAL_MS,
+    PROP_SIGNAL_SAMPLE_INTERVAL_MS,
+    PROP_NETWORK_SCAN_INTERVAL,
+    PROP_NETWORK_SCANNING,
+    PROP_FAST_REOPEN,
+    PROP_CLIENTS,
     PROP_LAST
 };
 
@@ -35,32 +69,177 @@ static GParamSpec *properties[PROP_LAST];
 
 enum {
     SIGNAL_ACT_UPDATED,
-    SIGNAL_RSSI_UPDATED,
-    SIGNAL_ECIO_UPDATED,
-    SIGNAL_SINR_LEVEL_UPDATED,
-    SIGNAL_IO_UPDATED,
-    SIGNAL_RSRQ_UPDATED,
-    SIGNAL_RSRP_UPDATED,
-    SIGNAL_SNR_UPDATED,
-    SIGNAL_RX0_UPDATED,
-    SIGNAL_RX1_UPDATED,
-    SIGNAL_TX_UPDATED,
+    SIGNAL_SAMPLE,
+    SIGNAL_NEIGHBORS,
+    SIGNAL_SERVING_CELL_CHANGED,
+    SIGNAL_CARRIERS,
+    SIGNAL_CLIENTS_UPDATED,
+    SIGNAL_NETWORK_SCAN,
     SIGNAL_LAST
 };
 
 static guint signals[SIGNAL_LAST] = { 0 };
 
+/* Metric groups polled on their own schedule */
+typedef enum {
+    POLL_GROUP_SIGNAL,
+    POLL_GROUP_POWER,
+    POLL_GROUP_NEIGHBORS,
+    POLL_GROUP_TRAFFIC,
+    POLL_GROUP_CARRIERS,
+    N_POLL_GROUPS
+} PollGroup;
+
+/* Poll groups are indexed by the bit of the sample group they load */
+G_STATIC_ASSERT (MRM_SAMPLE_GROUP_SIGNAL    == (1 << POLL_GROUP_SIGNAL));
+G_STATIC_ASSERT (MRM_SAMPLE_GROUP_POWER     == (1 << POLL_GROUP_POWER));
+G_STATIC_ASSERT (MRM_SAMPLE_GROUP_NEIGHBORS == (1 << POLL_GROUP_NEIGHBORS));
+G_STATIC_ASSERT (MRM_SAMPLE_GROUP_TRAFFIC   == (1 << POLL_GROUP_TRAFFIC));
+G_STATIC_ASSERT (MRM_SAMPLE_GROUP_CARRIERS  == (1 << POLL_GROUP_CARRIERS));
+
+static const gchar *poll_group_names[N_POLL_GROUPS] = {
+    [POLL_GROUP_SIGNAL]    = "signal",
+    [POLL_GROUP_POWER]     = "power",
+    [POLL_GROUP_NEIGHBORS] = "neighbor",
+    [POLL_GROUP_TRAFFIC]   = "traffic",
+    [POLL_GROUP_CARRIERS]  = "carrier",
+};
+
+/* Priority classes of the QMI requests sent to the modem, highest first */
+typedef enum {
+    REQUEST_PRIORITY_SAMPLING,
+    REQUEST_PRIORITY_CONTROL,
+    REQUEST_PRIORITY_BACKGROUND,
+    N_REQUEST_PRIORITIES
+} RequestPriority;
+
+static const gchar *request_priority_names[N_REQUEST_PRIORITIES] = {
+    [REQUEST_PRIORITY_SAMPLING]   = "sampling",
+    [REQUEST_PRIORITY_CONTROL]    = "control",
+    [REQUEST_PRIORITY_BACKGROUND] = "background",
+};
+
+typedef void (* RequestStartFunc) (MrmDevice *self,
+                                   gpointer user_data);
+
+typedef struct {
+    RequestStartFunc start;
+    gpointer user_data;
+} Request;
+
+typedef struct {
+    GSource *source;
+    guint subscribers; /* atomic, may be set from any thread */
+    guint interval_ms; /* atomic, may be set from any thread */
+    gint64 deadline;
+    gboolean in_flight;
+} PollSchedule;
+
+/* Running statistics of a time measurement, in microseconds */
+typedef struct {
+    guint n_samples;
+    gint64 last;
+    gint64 min;
+    gint64 max;
+    gdouble mean;
+    gdouble m2;
+} TimingStats;
+
+/* WDS packet statistics counters, from which traffic rates are computed */
+typedef enum {
+    TRAFFIC_COUNTER_TX_BYTES,
+    TRAFFIC_COUNTER_RX_BYTES,
+    TRAFFIC_COUNTER_TX_PACKETS,
+    TRAFFIC_COUNTER_RX_PACKETS,
+    TRAFFIC_COUNTER_TX_DROPPED,
+    TRAFFIC_COUNTER_RX_DROPPED,
+    N_TRAFFIC_COUNTERS
+} TrafficCounter;
+
+static const MrmSampleMetric traffic_counter_metrics[N_TRAFFIC_COUNTERS] = {
+    [TRAFFIC_COUNTER_TX_BYTES]   = MRM_SAMPLE_METRIC_TX_RATE,
+    [TRAFFIC_COUNTER_RX_BYTES]   = MRM_SAMPLE_METRIC_RX_RATE,
+    [TRAFFIC_COUNTER_TX_PACKETS] = MRM_SAMPLE_METRIC_TX_PACKET_RATE,
+    [TRAFFIC_COUNTER_RX_PACKETS] = MRM_SAMPLE_METRIC_RX_PACKET_RATE,
+    [TRAFFIC_COUNTER_TX_DROPPED] = MRM_SAMPLE_METRIC_TX_DROP_RATE,
+    [TRAFFIC_COUNTER_RX_DROPPED] = MRM_SAMPLE_METRIC_RX_DROP_RATE,
+};
+
+#define TRAFFIC_COUNTER_UNKNOWN G_MAXUINT64
+
 struct _MrmDevicePrivate {
-    /* QMI device */
+    /* Worker thread running all QMI operations */
+    GThread *worker;
+    GMainContext *worker_context;
+    GMainLoop *worker_loop;
+
+    /* Context where signals and notifications are delivered */
+    GMainContext *main_context;
+
+    /* Samples and notifications queued by the worker, protected by lock */
+    GMutex lock;
+    GArray *queued_samples;
+    GPtrArray *queued_neighbor_deltas;
+    GArray *queued_serving_cells;
+    GPtrArray *queued_carrier_samples;
+    MrmNetworkScan *queued_network_scan;
+    guint64 queued_notifications;
+    gboolean queued_clients_updated;
+    gboolean flush_scheduled;
+
+    /* Most recent samples, oldest first in the ring, main context only */
+    MrmSample *history;
+    guint history_first;
+    guint history_len;
+
+    /* Most recent LTE carrier samples, in the same way; each one is only as
+     * big as the number of carriers it reports */
+    MrmCarrierSample **carrier_history;
+    guint carrier_history_first;
+    guint carrier_history_len;
+
+    /* Neighbor list as last loaded, in the worker; and as last reported via
+     * deltas, in the main context */
+    GArray *neighbors;
+    GArray *neighbors_main;
+
+    /* Result of the last network scan, main context only */
+    MrmNetworkScan *network_scan;
+
+    /* Serving cell as last loaded, in the worker; and the log of its
+     * changes, oldest first in the ring, in the main context */
+    MrmServingCell serving_cell;
+    guint32 lte_serving_pci;
+    MrmServingCell *serving_cell_log;
+    guint serving_cell_log_first;
+    guint serving_cell_log_len;
+
+    /* QMI device; the file may change when reconnecting, so it is protected
+     * by lock */
     GFile *file;
     QmiDevice *qmi_device;
 
+    /* Reconnection state; the retry timer and backoff are worker only */
+    guint connection; /* atomic, MrmDeviceConnection */
+    gboolean resume_nas;
+    GSource *reconnect_source;
+    guint reconnect_delay_ms;
+    guint reconnect_attempts;
+
+    /* Backend used instead of the QMI device, if any; only the sample stream
+     * comes from it, the worker and poll scheduler are the same */
+    MrmDeviceBackend *backend;
+    gboolean backend_open;
+
     /* Device IDs */
     gchar *name;
     gchar *manufacturer;
     gchar *model;
     gchar *revision;
 
+    /* Time it took to open and identify the device */
+    gint64 init_duration;
+
     /* Device status */
     MrmDeviceStatus status;
     gint pin_attempts_left;
@@ -68,213 +247,584 @@ struct _MrmDevicePrivate {
     /* Clients */
     QmiClient *dms;
     QmiClient *nas;
+    QmiClient *wds; /* optional, only needed for traffic info */
+
+    /* In fast reopen mode client IDs are kept allocated on close, so that
+     * they can be reused when opening the device again. The client info is
+     * protected by lock; whether each client was reused is worker only. */
+    gboolean fast_reopen; /* atomic */
+    MrmDeviceClients clients;
+    gboolean clients_reused[MRM_DEVICE_N_CLIENTS];
+
+    /* Cancellable tree: the device one aborts everything on close, the NAS
+     * one, linked to it, only the NAS monitoring operations */
+    GCancellable *cancellable;
+    GCancellable *nas_cancellable;
+    gulong nas_cancellable_id;
 
     /* Info updates handling */
-    guint info_updated_id;
+    guint act;                /* atomic, MrmDeviceAct */
+    guint registration_state; /* atomic, MrmDeviceRegistrationState */
+    gint64 cycle_duration;
+
+    /* Poll scheduler */
+    PollSchedule poll[N_POLL_GROUPS];
+    guint poll_slot;    /* atomic */
+    guint poll_n_slots; /* atomic */
+    gboolean polling;
+    guint overrun_ticks;
+    guint late_ticks;
+
+    /* Request scheduler, worker only */
+    GQueue requests[N_REQUEST_PRIORITIES];
+    guint requests_in_flight[N_REQUEST_PRIORITIES];
+    gboolean requests_dispatching;
+
+    /* Network scans; the periodic timer and the operations waiting for the
+     * scan in progress are worker only */
+    guint network_scan_interval; /* atomic, seconds */
+    gboolean network_scanning;   /* atomic */
+    GSource *network_scan_source;
+    GList *network_scan_waiters;
+
+    /* PIN status requests retried on bogus replies, protected by lock */
+    guint pin_status_retries;
+
+    /* Request round-trip time and sampling jitter */
+    TimingStats rtt;
+    TimingStats jitter;
+
+    /* Signal info indications, if supported by the modem; atomic */
+    gboolean signal_info_indications;
+    guint signal_info_indication_id;
+
+    /* Last signal sample, polled or indicated, for the primary cell of the
+     * component carriers loaded on their own schedule */
+    MrmSample signal_sample;
+
+    /* Serving system indications; when available, the access technology is
+     * taken from them instead of inferred from the signal info contents */
+    gboolean serving_system_indications;
+    guint serving_system_indication_id;
+    MrmDeviceAct serving_system_act;
+    gboolean nr5g_signal;
+
+    /* Set once the modem rejects the LTE CPHY CA info request */
+    gboolean ca_info_unsupported;
+
+    /* Packet statistics as last loaded, in the worker */
+    gint64 traffic_timestamp;
+    guint64 traffic_counters[N_TRAFFIC_COUNTERS];
 };
 
 /*****************************************************************************/
-/* Reload power info */
+/* Worker thread
+ *
+ * All QMI operations, including opening the device, run in a thread with its
+ * own main context, so that reply processing and sampling don't depend on how
+ * busy the UI is. Samples and property notifications are queued by the
+ * worker and flushed in batches to the context the device was created in. */
 
-typedef struct {
-    MrmDevice *self;
-    MrmDeviceAct act;
-    guint current_i;
+static gpointer
+worker_thread_func (GMainLoop *loop)
+{
+    GMainContext *context;
+
+    context = g_main_loop_get_context (loop);
+    g_main_context_push_thread_default (context);
+    g_main_loop_run (loop);
+    g_main_context_pop_thread_default (context);
+    g_main_loop_unref (loop);
+    return NULL;
+}
 
-    gboolean has_gsm;
-    gdouble gsm_rx0;
-    gdouble gsm_rx1;
-    gdouble gsm_tx;
+static void
+worker_start (MrmDevice *self)
+{
+    self->priv->worker_context = g_main_context_new ();
+    self->priv->worker_loop = g_main_loop_new (self->priv->worker_context, FALSE);
+    self->priv->worker = g_thread_new ("mrm-device",
+                                       (GThreadFunc) worker_thread_func,
+                                       g_main_loop_ref (self->priv->worker_loop));
+}
 
-    gboolean has_umts;
-    gdouble umts_rx0;
-    gdouble umts_rx1;
-    gdouble umts_tx;
+static void
+worker_invoke (MrmDevice *self,
+               GSourceFunc func,
+               gpointer user_data)
+{
+    g_main_context_invoke (self->priv->worker_context, func, user_data);
+}
 
-    gboolean has_lte;
-    gdouble lte_rx0;
-    gdouble lte_rx1;
-    gdouble lte_tx;
+static void
+history_add (MrmDevice *self,
+             const MrmSample *sample)
+{
+    guint i;
 
-    gboolean has_cdma;
-    gdouble cdma_rx0;
-    gdouble cdma_rx1;
-    gdouble cdma_tx;
+    if (self->priv->history_len < MRM_DEVICE_HISTORY_SIZE)
+        i = (self->priv->history_first + self->priv->history_len++) % MRM_DEVICE_HISTORY_SIZE;
+    else {
+        i = self->priv->history_first;
+        self->priv->history_first = (self->priv->history_first + 1) % MRM_DEVICE_HISTORY_SIZE;
+    }
 
-    gboolean has_evdo;
-    gdouble evdo_rx0;
-    gdouble evdo_rx1;
-    gdouble evdo_tx;
-} ReloadPowerInfoContext;
-
-static void
-reload_power_info_context_complete (ReloadPowerInfoContext *ctx)
-{
-    g_signal_emit (ctx->self,
-                   signals[SIGNAL_RX0_UPDATED],
-                   0,
-                   ctx->has_gsm  ? ctx->gsm_rx0  : -G_MAXDOUBLE,
-                   ctx->has_umts ? ctx->umts_rx0 : -G_MAXDOUBLE,
-                   ctx->has_lte  ? ctx->lte_rx0  : -G_MAXDOUBLE,
-                   ctx->has_cdma ? ctx->cdma_rx0 : -G_MAXDOUBLE,
-                   ctx->has_evdo ? ctx->evdo_rx0 : -G_MAXDOUBLE);
-
-    g_signal_emit (ctx->self,
-                   signals[SIGNAL_RX1_UPDATED],
-                   0,
-                   ctx->has_gsm  ? ctx->gsm_rx1  : -G_MAXDOUBLE,
-                   ctx->has_umts ? ctx->umts_rx1 : -G_MAXDOUBLE,
-                   ctx->has_lte  ? ctx->lte_rx1  : -G_MAXDOUBLE,
-                   ctx->has_cdma ? ctx->cdma_rx1 : -G_MAXDOUBLE,
-                   ctx->has_evdo ? ctx->evdo_rx1 : -G_MAXDOUBLE);
-
-    g_signal_emit (ctx->self,
-                   signals[SIGNAL_TX_UPDATED],
-                   0,
-                   ctx->has_gsm ?  ctx->gsm_tx  : -G_MAXDOUBLE,
-                   ctx->has_umts ? ctx->umts_tx : -G_MAXDOUBLE,
-                   ctx->has_lte ?  ctx->lte_tx  : -G_MAXDOUBLE,
-                   ctx->has_cdma ? ctx->cdma_tx : -G_MAXDOUBLE,
-                   ctx->has_evdo ? ctx->evdo_tx : -G_MAXDOUBLE);
+    self->priv->history[i] = *sample;
+}
 
-    g_object_unref (ctx->self);
-    g_slice_free (ReloadPowerInfoContext, ctx);
+/* Takes ownership of the sample */
+static void
+carrier_history_add (MrmDevice *self,
+                     MrmCarrierSample *carrier_sample)
+{
+    guint i;
+
+    if (self->priv->carrier_history_len < MRM_DEVICE_HISTORY_SIZE)
+        i = (self->priv->carrier_history_first + self->priv->carrier_history_len++) % MRM_DEVICE_HISTORY_SIZE;
+    else {
+        i = self->priv->carrier_history_first;
+        self->priv->carrier_history_first = (self->priv->carrier_history_first + 1) % MRM_DEVICE_HISTORY_SIZE;
+        mrm_carrier_sample_free (self->priv->carrier_history[i]);
+    }
+
+    self->priv->carrier_history[i] = carrier_sample;
 }
 
-static void reload_power_info_context_step (ReloadPowerInfoContext *ctx);
+static void
+serving_cell_log_add (MrmDevice *self,
+                      const MrmServingCell *serving_cell)
+{
+    guint i;
+
+    if (self->priv->serving_cell_log_len < MRM_DEVICE_SERVING_CELL_LOG_SIZE)
+        i = (self->priv->serving_cell_log_first + self->priv->serving_cell_log_len++) % MRM_DEVICE_SERVING_CELL_LOG_SIZE;
+    else {
+        i = self->priv->serving_cell_log_first;
+        self->priv->serving_cell_log_first = (self->priv->serving_cell_log_first + 1) % MRM_DEVICE_SERVING_CELL_LOG_SIZE;
+    }
+
+    self->priv->serving_cell_log[i] = *serving_cell;
+}
 
 static void
-qmi_client_nas_get_tx_rx_info_ready (QmiClientNas *client,
-                                     GAsyncResult *res,
-                                     ReloadPowerInfoContext *ctx)
+cancel_child_cb (GCancellable *parent,
+                 GCancellable *child)
 {
-    QmiMessageNasGetTxRxInfoOutput *output;
-    GError *error = NULL;
+    g_cancellable_cancel (child);
+}
 
-    output = qmi_client_nas_get_tx_rx_info_finish (client, res, &error);
-    if (!output || !qmi_message_nas_get_tx_rx_info_output_get_result (output, &error)) {
-        g_debug ("Error loading tx/rx info: %s", error->message);
-        g_error_free (error);
-    } else {
-        gboolean rx0_tuned = FALSE;
-        gint32 rx0 = 0;
-        gboolean rx1_tuned = FALSE;
-        gint32 rx1 = 0;
-        gboolean in_traffic = FALSE;
-        gint32 tx = 0;
+/* Runs in the worker */
+static void
+nas_cancellable_setup (MrmDevice *self)
+{
+    g_assert (self->priv->nas_cancellable == NULL);
 
-        qmi_message_nas_get_tx_rx_info_output_get_rx_chain_0_info (output, &rx0_tuned, &rx0, NULL, NULL, NULL, NULL, NULL);
-        qmi_message_nas_get_tx_rx_info_output_get_rx_chain_1_info (output, &rx1_tuned, &rx1, NULL, NULL, NULL, NULL, NULL);
-        qmi_message_nas_get_tx_rx_info_output_get_tx_info (output, &in_traffic, &tx, NULL);
+    self->priv->nas_cancellable = g_cancellable_new ();
+    self->priv->nas_cancellable_id = g_cancellable_connect (self->priv->cancellable,
+                                                            G_CALLBACK (cancel_child_cb),
+                                                            self->priv->nas_cancellable,
+                                                            NULL);
+}
+
+/* Runs in the worker */
+static void
+nas_cancellable_cancel (MrmDevice *self)
+{
+    if (!self->priv->nas_cancellable)
+        return;
+
+    g_cancellable_disconnect (self->priv->cancellable, self->priv->nas_cancellable_id);
+    self->priv->nas_cancellable_id = 0;
+    g_cancellable_cancel (self->priv->nas_cancellable);
+    g_clear_object (&self->priv->nas_cancellable);
+}
+
+/* Network scans don't report levels, so the current network is given the
+ * one in the last sample taken in it */
+static void
+network_scan_set_levels (MrmDevice *self,
+                         MrmNetworkScan *scan)
+{
+    const MrmSample *sample;
+    MrmSampleMetric metric;
+    gdouble value;
+    guint i;
 
-        switch (1 << ctx->current_i) {
+    if (!self->priv->history_len)
+        return;
+
+    sample = &self->priv->history[(self->priv->history_first + self->priv->history_len - 1) % MRM_DEVICE_HISTORY_SIZE];
+    for (i = 0; i < scan->n_networks; i++) {
+        MrmNetwork *network = &scan->networks[i];
+
+        if (!(network->status & MRM_NETWORK_STATUS_CURRENT) || !(network->act & sample->act))
+            continue;
+
+        switch (network->act) {
         case MRM_DEVICE_ACT_GSM:
-            ctx->has_gsm = TRUE;
-            ctx->gsm_rx0 = rx0_tuned ? (0.1 * ((gdouble)rx0)) : -G_MAXDOUBLE;
-            ctx->gsm_rx1 = rx1_tuned ? (0.1 * ((gdouble)rx1)) : -G_MAXDOUBLE;
-            ctx->gsm_tx = in_traffic ? (0.1 * ((gdouble)tx))  : -G_MAXDOUBLE;
+            metric = MRM_SAMPLE_METRIC_GSM_RSSI;
             break;
         case MRM_DEVICE_ACT_UMTS:
-            ctx->has_umts = TRUE;
-            ctx->umts_rx0 = rx0_tuned ? (0.1 * ((gdouble)rx0)) : -G_MAXDOUBLE;
-            ctx->umts_rx1 = rx1_tuned ? (0.1 * ((gdouble)rx1)) : -G_MAXDOUBLE;
-            ctx->umts_tx = in_traffic ? (0.1 * ((gdouble)tx))  : -G_MAXDOUBLE;
+            metric = MRM_SAMPLE_METRIC_UMTS_RSSI;
             break;
         case MRM_DEVICE_ACT_LTE:
-            ctx->has_lte = TRUE;
-            ctx->lte_rx0 = rx0_tuned ? (0.1 * ((gdouble)rx0)) : -G_MAXDOUBLE;
-            ctx->lte_rx1 = rx1_tuned ? (0.1 * ((gdouble)rx1)) : -G_MAXDOUBLE;
-            ctx->lte_tx = in_traffic ? (0.1 * ((gdouble)tx))  : -G_MAXDOUBLE;
+            metric = MRM_SAMPLE_METRIC_LTE_RSSI;
             break;
         case MRM_DEVICE_ACT_CDMA:
-            ctx->has_cdma = TRUE;
-            ctx->cdma_rx0 = rx0_tuned ? (0.1 * ((gdouble)rx0)) : -G_MAXDOUBLE;
-            ctx->cdma_rx1 = rx1_tuned ? (0.1 * ((gdouble)rx1)) : -G_MAXDOUBLE;
-            ctx->cdma_tx = in_traffic ? (0.1 * ((gdouble)tx))  : -G_MAXDOUBLE;
+            metric = MRM_SAMPLE_METRIC_CDMA_RSSI;
             break;
         case MRM_DEVICE_ACT_EVDO:
-            ctx->has_evdo = TRUE;
-            ctx->evdo_rx0 = rx0_tuned ? (0.1 * ((gdouble)rx0)) : -G_MAXDOUBLE;
-            ctx->evdo_rx1 = rx1_tuned ? (0.1 * ((gdouble)rx1)) : -G_MAXDOUBLE;
-            ctx->evdo_tx = in_traffic ? (0.1 * ((gdouble)tx))  : -G_MAXDOUBLE;
+            metric = MRM_SAMPLE_METRIC_EVDO_RSSI;
+            break;
+        case MRM_DEVICE_ACT_NR5G:
+            metric = MRM_SAMPLE_METRIC_NR5G_RSRP;
             break;
         default:
-            g_assert_not_reached ();
+            continue;
         }
+
+        if (mrm_sample_get_value (sample, metric, &value))
+            network->level = (gint16) CLAMP (10.0 * value, G_MININT16 + 1, G_MAXINT16);
+    }
+}
+
+static gboolean
+flush_queued_cb (MrmDevice *self)
+{
+    GArray *samples;
+    GPtrArray *neighbor_deltas;
+    GArray *serving_cells;
+    GPtrArray *carrier_samples;
+    MrmNetworkScan *network_scan;
+    guint64 notifications;
+    gboolean clients_updated;
+    guint i;
+
+    g_mutex_lock (&self->priv->lock);
+    samples = self->priv->queued_samples;
+    self->priv->queued_samples = g_array_new (FALSE, FALSE, sizeof (MrmSample));
+    neighbor_deltas = self->priv->queued_neighbor_deltas;
+    self->priv->queued_neighbor_deltas = g_ptr_array_new_with_free_func ((GDestroyNotify) mrm_neighbor_delta_free);
+    serving_cells = self->priv->queued_serving_cells;
+    self->priv->queued_serving_cells = g_array_new (FALSE, FALSE, sizeof (MrmServingCell));
+    carrier_samples = self->priv->queued_carrier_samples;
+    self->priv->queued_carrier_samples = g_ptr_array_new ();
+    network_scan = self->priv->queued_network_scan;
+    self->priv->queued_network_scan = NULL;
+    notifications = self->priv->queued_notifications;
+    self->priv->queued_notifications = 0;
+    clients_updated = self->priv->queued_clients_updated;
+    self->priv->queued_clients_updated = FALSE;
+    self->priv->flush_scheduled = FALSE;
+    g_mutex_unlock (&self->priv->lock);
+
+    g_object_freeze_notify (G_OBJECT (self));
+    for (i = PROP_0 + 1; i < PROP_LAST; i++) {
+        if (notifications & (G_GUINT64_CONSTANT (1) << i))
+            g_object_notify_by_pspec (G_OBJECT (self), properties[i]);
     }
+    g_object_thaw_notify (G_OBJECT (self));
 
-    if (output)
-        qmi_message_nas_get_tx_rx_info_output_unref (output);
+    if (notifications & (G_GUINT64_CONSTANT (1) << PROP_ACT))
+        g_signal_emit (self, signals[SIGNAL_ACT_UPDATED], 0, mrm_device_get_act (self));
+
+    if (clients_updated)
+        g_signal_emit (self, signals[SIGNAL_CLIENTS_UPDATED], 0);
+
+    /* Cell changes go first, so that they are known when the samples taken
+     * right after them arrive */
+    for (i = 0; i < serving_cells->len; i++) {
+        serving_cell_log_add (self, &g_array_index (serving_cells, MrmServingCell, i));
+        g_signal_emit (self, signals[SIGNAL_SERVING_CELL_CHANGED], 0, &g_array_index (serving_cells, MrmServingCell, i));
+    }
+
+    /* Carriers go before the samples loaded along with them, so that
+     * listeners may plot both in the same step */
+    for (i = 0; i < carrier_samples->len; i++) {
+        carrier_history_add (self, g_ptr_array_index (carrier_samples, i));
+        g_signal_emit (self, signals[SIGNAL_CARRIERS], 0, g_ptr_array_index (carrier_samples, i));
+    }
+
+    for (i = 0; i < samples->len; i++) {
+        history_add (self, &g_array_index (samples, MrmSample, i));
+        g_signal_emit (self, signals[SIGNAL_SAMPLE], 0, &g_array_index (samples, MrmSample, i));
+    }
+
+    for (i = 0; i < neighbor_deltas->len; i++) {
+        mrm_neighbor_list_apply (self->priv->neighbors_main, g_ptr_array_index (neighbor_deltas, i));
+        g_signal_emit (self, signals[SIGNAL_NEIGHBORS], 0, g_ptr_array_index (neighbor_deltas, i));
+    }
+
+    /* After the samples, so that the level of the current network is the
+     * last one known */
+    if (network_scan) {
+        network_scan_set_levels (self, network_scan);
+        if (self->priv->network_scan)
+            mrm_network_scan_free (self->priv->network_scan);
+        self->priv->network_scan = network_scan;
+        g_signal_emit (self, signals[SIGNAL_NETWORK_SCAN], 0, network_scan);
+    }
 
-    /* Go on */
-    ctx->current_i++;
-    reload_power_info_context_step (ctx);
+    g_array_unref (samples);
+    g_ptr_array_unref (neighbor_deltas);
+    g_array_unref (serving_cells);
+    g_ptr_array_unref (carrier_samples);
+    return G_SOURCE_REMOVE;
 }
 
+/* Must be called with the lock held */
 static void
-reload_power_info_context_step (ReloadPowerInfoContext *ctx)
+schedule_flush (MrmDevice *self)
 {
-    guint i;
+    GSource *source;
 
-    for (i = ctx->current_i; i < sizeof (MrmDeviceAct) * 8; i++) {
-        guint32 current = 1 << i;
+    if (self->priv->flush_scheduled)
+        return;
 
-        /* Found the next one to query! */
-        if (ctx->act & current) {
-            QmiMessageNasGetTxRxInfoInput *input;
-            QmiNasRadioInterface nas_iface;
+    self->priv->flush_scheduled = TRUE;
+    source = g_idle_source_new ();
+    g_source_set_callback (source,
+                           (GSourceFunc) flush_queued_cb,
+                           g_object_ref (self),
+                           g_object_unref);
+    g_source_attach (source, self->priv->main_context);
+    g_source_unref (source);
+}
 
-            switch (current) {
-            case MRM_DEVICE_ACT_GSM:
-                nas_iface = QMI_NAS_RADIO_INTERFACE_GSM;
-                break;
-            case MRM_DEVICE_ACT_UMTS:
-                nas_iface = QMI_NAS_RADIO_INTERFACE_UMTS;
-                break;
-            case MRM_DEVICE_ACT_LTE:
-                nas_iface = QMI_NAS_RADIO_INTERFACE_LTE;
-                break;
-            case MRM_DEVICE_ACT_CDMA:
-                nas_iface = QMI_NAS_RADIO_INTERFACE_CDMA_1X;
-                break;
-            case MRM_DEVICE_ACT_EVDO:
-                nas_iface = QMI_NAS_RADIO_INTERFACE_CDMA_1XEVDO;
-                break;
-            default:
-                g_assert_not_reached ();
-            }
+static void
+queue_sample (MrmDevice *self,
+              const MrmSample *sample)
+{
+    g_mutex_lock (&self->priv->lock);
+    g_array_append_vals (self->priv->queued_samples, sample, 1);
+    schedule_flush (self);
+    g_mutex_unlock (&self->priv->lock);
+}
 
-            ctx->current_i = i;
-
-            input = qmi_message_nas_get_tx_rx_info_input_new ();
-            qmi_message_nas_get_tx_rx_info_input_set_radio_interface (input, nas_iface, NULL);
-            qmi_client_nas_get_tx_rx_info (QMI_CLIENT_NAS (ctx->self->priv->nas),
-                                           input,
-                                           1,
-                                           NULL,
-                                           (GAsyncReadyCallback)qmi_client_nas_get_tx_rx_info_ready,
-                                           ctx);
-            qmi_message_nas_get_tx_rx_info_input_unref (input);
-            return;
-        }
+/* Takes ownership of the sample */
+static void
+queue_carrier_sample (MrmDevice *self,
+                      MrmCarrierSample *carrier_sample)
+{
+    g_mutex_lock (&self->priv->lock);
+    g_ptr_array_add (self->priv->queued_carrier_samples, carrier_sample);
+    schedule_flush (self);
+    g_mutex_unlock (&self->priv->lock);
+}
+
+/* Takes ownership of the scan; only the last one is kept */
+static void
+queue_network_scan (MrmDevice *self,
+                    MrmNetworkScan *scan)
+{
+    g_mutex_lock (&self->priv->lock);
+    if (self->priv->queued_network_scan)
+        mrm_network_scan_free (self->priv->queued_network_scan);
+    self->priv->queued_network_scan = scan;
+    schedule_flush (self);
+    g_mutex_unlock (&self->priv->lock);
+}
+
+static void
+queue_serving_cell (MrmDevice *self,
+                    const MrmServingCell *serving_cell)
+{
+    g_mutex_lock (&self->priv->lock);
+    g_array_append_vals (self->priv->queued_serving_cells, serving_cell, 1);
+    schedule_flush (self);
+    g_mutex_unlock (&self->priv->lock);
+}
+
+/* Takes ownership of the delta */
+static void
+queue_neighbor_delta (MrmDevice *self,
+                      MrmNeighborDelta *delta)
+{
+    g_mutex_lock (&self->priv->lock);
+    g_ptr_array_add (self->priv->queued_neighbor_deltas, delta);
+    schedule_flush (self);
+    g_mutex_unlock (&self->priv->lock);
+}
+
+static void
+queue_notify (MrmDevice *self,
+              guint prop_id)
+{
+    g_mutex_lock (&self->priv->lock);
+    self->priv->queued_notifications |= (G_GUINT64_CONSTANT (1) << prop_id);
+    schedule_flush (self);
+    g_mutex_unlock (&self->priv->lock);
+}
+
+/*****************************************************************************/
+/* QMI clients
+ *
+ * In fast reopen mode the client IDs are not released in the modem, and
+ * the ones persisted from a previous run are given to libqmi instead of
+ * allocating new ones. A reused client ID may have been lost meanwhile, e.g.
+ * if the modem was reset; the modem then replies to the first request with
+ * an invalid client ID error, and a new client is allocated. */
+
+static const gchar *client_names[MRM_DEVICE_N_CLIENTS] = {
+    [MRM_DEVICE_CLIENT_DMS] = "DMS",
+    [MRM_DEVICE_CLIENT_NAS] = "NAS",
+    [MRM_DEVICE_CLIENT_WDS] = "WDS",
+};
+
+/* Runs in the worker. Allocating a client with QMI_CID_NONE gets a new one;
+ * otherwise libqmi takes the given one as already allocated. */
+static guint8
+client_cid_to_reuse (MrmDevice *self,
+                     MrmDeviceClient client)
+{
+    guint8 cid = QMI_CID_NONE;
+
+    if (g_atomic_int_get (&self->priv->fast_reopen)) {
+        g_mutex_lock (&self->priv->lock);
+        cid = self->priv->clients.clients[client].cid;
+        g_mutex_unlock (&self->priv->lock);
+    }
+
+    self->priv->clients_reused[client] = (cid != QMI_CID_NONE);
+    return cid;
+}
+
+/* Runs in the worker, with the lock held. Returns whether the info changed. */
+static gboolean
+client_info_set (MrmDevice *self,
+                 MrmDeviceClient client,
+                 QmiClient *qmi_client)
+{
+    MrmDeviceClientInfo *info;
+    guint8 cid;
+    gboolean changed;
+
+    cid = qmi_client ? qmi_client_get_cid (qmi_client) : QMI_CID_NONE;
+
+    info = &self->priv->clients.clients[client];
+    changed = (info->cid != cid);
+    info->cid = cid;
+
+    /* Service versions are only known if loaded when opening the device;
+     * otherwise the persisted ones are kept */
+    if (qmi_client &&
+        (qmi_client_get_version_major (qmi_client) || qmi_client_get_version_minor (qmi_client)) &&
+        (info->version_major != qmi_client_get_version_major (qmi_client) ||
+         info->version_minor != qmi_client_get_version_minor (qmi_client))) {
+        info->version_major = qmi_client_get_version_major (qmi_client);
+        info->version_minor = qmi_client_get_version_minor (qmi_client);
+        changed = TRUE;
     }
 
-    /* All done */
-    reload_power_info_context_complete (ctx);
+    return changed;
 }
 
+/* Runs in the worker */
 static void
-reload_power_info (MrmDevice *self,
-                   MrmDeviceAct act)
+client_info_update (MrmDevice *self,
+                    MrmDeviceClient client,
+                    QmiClient *qmi_client)
 {
-    ReloadPowerInfoContext *ctx;
+    g_mutex_lock (&self->priv->lock);
+    if (client_info_set (self, client, qmi_client)) {
+        self->priv->queued_clients_updated = TRUE;
+        schedule_flush (self);
+    }
+    g_mutex_unlock (&self->priv->lock);
+}
 
-    ctx = g_slice_new0 (ReloadPowerInfoContext);
-    ctx->self = g_object_ref (self);
-    ctx->act = act;
-    ctx->current_i = 0;
+/* Runs in the worker. Gives the flags to release the client with. Without
+ * @notify, e.g. while disposing, no clients-updated is emitted for it. */
+static QmiDeviceReleaseClientFlags
+client_release_prepare (MrmDevice *self,
+                        MrmDeviceClient client,
+                        gboolean notify)
+{
+    if (g_atomic_int_get (&self->priv->fast_reopen))
+        return QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE;
+
+    /* The client ID is gone once released */
+    if (notify)
+        client_info_update (self, client, NULL);
+    else {
+        g_mutex_lock (&self->priv->lock);
+        client_info_set (self, client, NULL);
+        g_mutex_unlock (&self->priv->lock);
+    }
+    return QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID;
+}
+
+/* Runs in the worker */
+static gboolean
+client_is_stale (MrmDevice *self,
+                 MrmDeviceClient client,
+                 const GError *error)
+{
+    return (self->priv->clients_reused[client] &&
+            g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_INVALID_CLIENT_ID));
+}
+
+/* Runs in the worker. Only unregisters the client in libqmi, the modem
+ * doesn't know about its ID anyway. */
+static void
+client_drop_stale (MrmDevice *self,
+                   MrmDeviceClient client,
+                   QmiClient **qmi_client)
+{
+    g_debug ("Reused %s client %u at '%s' is no longer valid, allocating a new one",
+             client_names[client], qmi_client_get_cid (*qmi_client), self->priv->name);
+
+    qmi_device_release_client (self->priv->qmi_device,
+                               *qmi_client,
+                               QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE,
+                               5,
+                               NULL,
+                               NULL,
+                               NULL);
+    g_clear_object (qmi_client);
+    client_info_update (self, client, NULL);
+    self->priv->clients_reused[client] = FALSE;
+}
+
+/*****************************************************************************/
+/* Timing statistics */
+
+static void
+timing_stats_reset (TimingStats *stats)
+{
+    memset (stats, 0, sizeof (TimingStats));
+}
+
+static void
+timing_stats_add (TimingStats *stats,
+                  gint64 value)
+{
+    gdouble delta;
+
+    if (stats->n_samples == 0 || value < stats->min)
+        stats->min = value;
+    if (stats->n_samples == 0 || value > stats->max)
+        stats->max = value;
+    stats->last = value;
+    stats->n_samples++;
+
+    /* Welford's online algorithm, so that the variance doesn't suffer from
+     * cancellation after long runs */
+    delta = (gdouble) value - stats->mean;
+    stats->mean += delta / stats->n_samples;
+    stats->m2 += delta * ((gdouble) value - stats->mean);
+}
 
-    reload_power_info_context_step (ctx);
+static void
+timing_stats_export (const TimingStats *stats,
+                     MrmDeviceTimingStats *out)
+{
+    out->n_samples = stats->n_samples;
+    out->last = stats->last;
+    out->min = stats->min;
+    out->max = stats->max;
+    out->mean = stats->mean;
+    out->stddev = stats->n_samples > 1 ? sqrt (stats->m2 / (stats->n_samples - 1)) : 0.0;
 }
 
 /*****************************************************************************/
@@ -299,426 +849,3161 @@ get_db_from_sinr_level (QmiNasEvdoSinrLevel level)
     }
 }
 
+/* Runs in the worker */
 static void
-qmi_client_nas_get_signal_info_ready (QmiClientNas *client,
-                                      GAsyncResult *res,
-                                      MrmDevice *self)
+device_set_act (MrmDevice *self,
+                MrmDeviceAct act)
 {
-    QmiMessageNasGetSignalInfoOutput *output;
-    GError *error = NULL;
-    MrmDeviceAct act = 0;
+    if ((MrmDeviceAct) g_atomic_int_get (&self->priv->act) == act)
+        return;
 
-    output = qmi_client_nas_get_signal_info_finish (client, res, &error);
-    if (!output || !qmi_message_nas_get_signal_info_output_get_result (output, &error)) {
-        g_debug ("Error loading signal info: %s", error->message);
-        g_error_free (error);
-    } else {
-        gint8 gsm_rssi  = -125;
-        gint8 umts_rssi = -125;
-        gint8 lte_rssi  = -125;
-        gint8 cdma_rssi = -125;
-        gint8 evdo_rssi = -125;
-        gint16 umts_ecio = -1;
-        gint16 cdma_ecio = -1;
-        gint16 evdo_ecio = -1;
-        QmiNasEvdoSinrLevel evdo_sinr_level = QMI_NAS_EVDO_SINR_LEVEL_0;
-        gint32 evdo_io = -125;
-        gint8 lte_rsrq = -125;
-        gint16 lte_rsrp = -125;
-        gint16 lte_snr = -125;
-        gboolean has_gsm;
-        gboolean has_umts;
-        gboolean has_lte;
-        gboolean has_cdma;
-        gboolean has_evdo;
+    g_debug ("Access technologies at '%s' changed: 0x%x -> 0x%x",
+             self->priv->name, g_atomic_int_get (&self->priv->act), act);
+    g_atomic_int_set (&self->priv->act, act);
+    queue_notify (self, PROP_ACT);
+}
 
-        /* Get signal info */
-        has_gsm = qmi_message_nas_get_signal_info_output_get_gsm_signal_strength (output, &gsm_rssi, NULL);
-        has_umts = qmi_message_nas_get_signal_info_output_get_wcdma_signal_strength (output, &umts_rssi, &umts_ecio, NULL);
-        has_lte = qmi_message_nas_get_signal_info_output_get_lte_signal_strength (output, &lte_rssi, &lte_rsrq, &lte_rsrp, &lte_snr, NULL);
-        has_cdma = qmi_message_nas_get_signal_info_output_get_cdma_signal_strength (output, &cdma_rssi, &cdma_ecio, NULL);
-        has_evdo = qmi_message_nas_get_signal_info_output_get_hdr_signal_strength (output, &evdo_rssi, &evdo_ecio, &evdo_sinr_level, &evdo_io, NULL);
-
-        if (has_gsm)
-            act |= MRM_DEVICE_ACT_GSM;
-        if (has_umts)
-            act |= MRM_DEVICE_ACT_UMTS;
-        if (has_lte)
-            act |= MRM_DEVICE_ACT_LTE;
-        if (has_cdma)
-            act |= MRM_DEVICE_ACT_CDMA;
-        if (has_evdo)
-            act |= MRM_DEVICE_ACT_EVDO;
-
-        g_signal_emit (self,
-                       signals[SIGNAL_ACT_UPDATED],
-                       0,
-                       act);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_RSSI_UPDATED],
-                       0,
-                       has_gsm ? (gdouble)gsm_rssi : -G_MAXDOUBLE,
-                       has_umts ? (gdouble)umts_rssi : -G_MAXDOUBLE,
-                       has_lte ? (gdouble)lte_rssi : -G_MAXDOUBLE,
-                       has_cdma ? (gdouble)cdma_rssi : -G_MAXDOUBLE,
-                       has_evdo ? (gdouble)evdo_rssi : -G_MAXDOUBLE);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_ECIO_UPDATED],
-                       0,
-                       has_umts ? (-0.5)*((gdouble)umts_ecio) : -G_MAXDOUBLE,
-                       has_cdma ? (-0.5)*((gdouble)cdma_ecio) : -G_MAXDOUBLE,
-                       has_evdo ? (-0.5)*((gdouble)evdo_ecio) : -G_MAXDOUBLE);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_SINR_LEVEL_UPDATED],
-                       0,
-                       has_evdo ? get_db_from_sinr_level (evdo_sinr_level) : -G_MAXDOUBLE);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_IO_UPDATED],
-                       0,
-                       has_evdo ? ((gdouble)evdo_io) : -G_MAXDOUBLE);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_RSRQ_UPDATED],
-                       0,
-                       has_lte ? ((gdouble)lte_rsrq) : -G_MAXDOUBLE);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_RSRP_UPDATED],
-                       0,
-                       has_lte ? ((gdouble)lte_rsrp) : -G_MAXDOUBLE);
-
-        g_signal_emit (self,
-                       signals[SIGNAL_SNR_UPDATED],
-                       0,
-                       has_lte ? ((gdouble)lte_snr) : -G_MAXDOUBLE);
+/* NR5G values given as -32768 aren't known, e.g. RSRQ in the base TLV of
+ * modems that don't report the extended one */
+#define SIGNAL_INFO_NR5G_UNKNOWN G_MININT16
+
+typedef struct {
+    gboolean has_gsm;
+    gboolean has_umts;
+    gboolean has_lte;
+    gboolean has_cdma;
+    gboolean has_evdo;
+    gboolean has_nr5g;
+    gint8 gsm_rssi;
+    gint8 umts_rssi;
+    gint8 lte_rssi;
+    gint8 cdma_rssi;
+    gint8 evdo_rssi;
+    gint16 umts_ecio;
+    gint16 cdma_ecio;
+    gint16 evdo_ecio;
+    QmiNasEvdoSinrLevel evdo_sinr_level;
+    gint32 evdo_io;
+    gint8 lte_rsrq;
+    gint16 lte_rsrp;
+    gint16 lte_snr;
+    gint16 nr5g_rsrq;
+    gint16 nr5g_rsrp;
+    gint16 nr5g_snr;
+} SignalInfo;
+
+static void
+signal_info_init (SignalInfo *info)
+{
+    memset (info, 0, sizeof (SignalInfo));
+    info->gsm_rssi  = -125;
+    info->umts_rssi = -125;
+    info->lte_rssi  = -125;
+    info->cdma_rssi = -125;
+    info->evdo_rssi = -125;
+    info->umts_ecio = -1;
+    info->cdma_ecio = -1;
+    info->evdo_ecio = -1;
+    info->evdo_sinr_level = QMI_NAS_EVDO_SINR_LEVEL_0;
+    info->evdo_io = -125;
+    info->lte_rsrq = -125;
+    info->lte_rsrp = -125;
+    info->lte_snr = -125;
+    info->nr5g_rsrq = SIGNAL_INFO_NR5G_UNKNOWN;
+    info->nr5g_rsrp = SIGNAL_INFO_NR5G_UNKNOWN;
+    info->nr5g_snr = SIGNAL_INFO_NR5G_UNKNOWN;
+}
+
+static MrmDeviceAct
+signal_info_to_sample (MrmDevice *self,
+                       const SignalInfo *info,
+                       MrmSample *sample)
+{
+    MrmDeviceAct act = 0;
+
+    if (info->has_gsm) {
+        act |= MRM_DEVICE_ACT_GSM;
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_GSM_RSSI, (gdouble)info->gsm_rssi);
+    }
+    if (info->has_umts) {
+        act |= MRM_DEVICE_ACT_UMTS;
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_UMTS_RSSI, (gdouble)info->umts_rssi);
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_UMTS_ECIO, (-0.5)*((gdouble)info->umts_ecio));
+    }
+    if (info->has_lte) {
+        act |= MRM_DEVICE_ACT_LTE;
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_LTE_RSSI, (gdouble)info->lte_rssi);
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_LTE_RSRQ, (gdouble)info->lte_rsrq);
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_LTE_RSRP, (gdouble)info->lte_rsrp);
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_LTE_SNR,  (gdouble)info->lte_snr);
+    }
+    if (info->has_cdma) {
+        act |= MRM_DEVICE_ACT_CDMA;
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_CDMA_RSSI, (gdouble)info->cdma_rssi);
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_CDMA_ECIO, (-0.5)*((gdouble)info->cdma_ecio));
+    }
+    if (info->has_evdo) {
+        gdouble sinr;
+
+        act |= MRM_DEVICE_ACT_EVDO;
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_EVDO_RSSI, (gdouble)info->evdo_rssi);
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_EVDO_ECIO, (-0.5)*((gdouble)info->evdo_ecio));
+        mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_EVDO_IO,   (gdouble)info->evdo_io);
+        sinr = get_db_from_sinr_level (info->evdo_sinr_level);
+        if (sinr != -G_MAXDOUBLE)
+            mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_EVDO_SINR_LEVEL, sinr);
+    }
+    if (info->has_nr5g) {
+        /* Same units as the LTE values */
+        act |= MRM_DEVICE_ACT_NR5G;
+        if (info->nr5g_rsrq != SIGNAL_INFO_NR5G_UNKNOWN)
+            mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_NR5G_RSRQ, (gdouble)info->nr5g_rsrq);
+        if (info->nr5g_rsrp != SIGNAL_INFO_NR5G_UNKNOWN)
+            mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_NR5G_RSRP, (gdouble)info->nr5g_rsrp);
+        if (info->nr5g_snr != SIGNAL_INFO_NR5G_UNKNOWN)
+            mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_NR5G_SNR,  (gdouble)info->nr5g_snr);
     }
 
-    if (output)
-        qmi_message_nas_get_signal_info_output_unref (output);
+    /* Without serving system tracking, infer it from which TLVs are given.
+     * With it, NR5G is still taken from the signal info: in non-standalone
+     * mode the serving system only reports the LTE anchor. */
+    self->priv->nr5g_signal = info->has_nr5g;
+    if (!self->priv->serving_system_indications)
+        device_set_act (self, act);
+    else
+        device_set_act (self, self->priv->serving_system_act | (info->has_nr5g ? MRM_DEVICE_ACT_NR5G : 0));
+    sample->act = g_atomic_int_get (&self->priv->act);
+    sample->groups |= MRM_SAMPLE_GROUP_SIGNAL;
+
+    return act;
+}
 
-    /* Now reload power info */
-    reload_power_info (self, act);
+/*****************************************************************************/
+/* Serving cell tracking
+ *
+ * The serving cell identity is loaded along with the signal info, and
+ * whenever the serving system changes. Only actual changes are logged. */
 
-    g_object_unref (self);
+static MrmDeviceAct
+act_from_radio_interface (QmiNasRadioInterface radio_interface)
+{
+    switch (radio_interface) {
+    case QMI_NAS_RADIO_INTERFACE_GSM:
+        return MRM_DEVICE_ACT_GSM;
+    case QMI_NAS_RADIO_INTERFACE_UMTS:
+        return MRM_DEVICE_ACT_UMTS;
+    case QMI_NAS_RADIO_INTERFACE_LTE:
+        return MRM_DEVICE_ACT_LTE;
+    case QMI_NAS_RADIO_INTERFACE_CDMA_1X:
+        return MRM_DEVICE_ACT_CDMA;
+    case QMI_NAS_RADIO_INTERFACE_CDMA_1XEVDO:
+        return MRM_DEVICE_ACT_EVDO;
+#if defined WITH_NR5G
+    case QMI_NAS_RADIO_INTERFACE_5GNR:
+        return MRM_DEVICE_ACT_NR5G;
+#endif
+    default:
+        return 0;
+    }
 }
 
-static gboolean
-info_reload_cb (MrmDevice *self)
-{
-    /* First, signal info */
-    qmi_client_nas_get_signal_info (QMI_CLIENT_NAS (self->priv->nas),
-                                    NULL,
-                                    10,
-                                    NULL,
-                                    (GAsyncReadyCallback)qmi_client_nas_get_signal_info_ready,
-                                    g_object_ref (self));
-    return TRUE;
+/* Runs in the worker */
+static void
+serving_cell_update (MrmDevice *self,
+                     const MrmServingCell *serving_cell)
+{
+    gchar *str;
+
+    if (mrm_serving_cell_equal (&self->priv->serving_cell, serving_cell))
+        return;
+
+    self->priv->serving_cell = *serving_cell;
+
+    str = mrm_serving_cell_build_label (serving_cell);
+    g_debug ("Serving cell at '%s' changed: %s", self->priv->name, str);
+    g_free (str);
+
+    queue_serving_cell (self, serving_cell);
 }
 
 /*****************************************************************************/
-/* Reload status */
+/* Request scheduler
+ *
+ * Requests are queued by priority class and dispatched in the worker, up to a
+ * limit of requests in flight. Sampling cycles are never held back, so that
+ * no tick is ever delayed; control requests wait for a free slot; background
+ * requests, which may take long, run one at a time and only start between
+ * sampling cycles, once nothing else is waiting. A sampling cycle counts as a
+ * single request, however many QMI messages it is made of.
+ *
+ * Started requests report back with request_done(). Queued requests are
+ * started anyway when the device is dropped or closed, once their cancellable
+ * has been cancelled, so that they all go through their usual error path. */
+
+#define REQUESTS_IN_FLIGHT_MAX            4
+#define REQUESTS_BACKGROUND_IN_FLIGHT_MAX 1
 
 static gboolean
-reload_status_finish (MrmDevice *self,
-                      GAsyncResult *res,
-                      GError **error)
+request_can_start (MrmDevice *self,
+                   RequestPriority priority)
 {
-    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+    guint in_flight = 0;
+    guint i;
+
+    if (priority == REQUEST_PRIORITY_SAMPLING)
+        return TRUE;
+
+    for (i = 0; i < N_REQUEST_PRIORITIES; i++)
+        in_flight += self->priv->requests_in_flight[i];
+    if (in_flight >= REQUESTS_IN_FLIGHT_MAX)
+        return FALSE;
+
+    if (priority == REQUEST_PRIORITY_BACKGROUND)
+        return (!self->priv->requests_in_flight[REQUEST_PRIORITY_SAMPLING] &&
+                self->priv->requests_in_flight[REQUEST_PRIORITY_BACKGROUND] < REQUESTS_BACKGROUND_IN_FLIGHT_MAX);
+
+    return TRUE;
 }
 
 static void
-qmi_client_dms_get_pin_status_ready (QmiClientDms *dms,
+request_start (MrmDevice *self,
+               RequestPriority priority)
+{
+    Request *request;
+
+    request = g_queue_pop_head (&self->priv->requests[priority]);
+    self->priv->requests_in_flight[priority]++;
+    request->start (self, request->user_data);
+    g_slice_free (Request, request);
+}
+
+/* Runs in the worker. Lower classes never overtake a waiting higher one. */
+static void
+request_dispatch (MrmDevice *self)
+{
+    guint i;
+
+    /* Requests may complete right away */
+    if (self->priv->requests_dispatching)
+        return;
+    self->priv->requests_dispatching = TRUE;
+
+    i = 0;
+    while (i < N_REQUEST_PRIORITIES) {
+        if (g_queue_is_empty (&self->priv->requests[i])) {
+            i++;
+            continue;
+        }
+        if (!request_can_start (self, i))
+            break;
+        request_start (self, i);
+        i = 0;
+    }
+
+    self->priv->requests_dispatching = FALSE;
+}
+
+/* Runs in the worker */
+static void
+request_submit (MrmDevice *self,
+                RequestPriority priority,
+                RequestStartFunc start,
+                gpointer user_data)
+{
+    Request *request;
+
+    request = g_slice_new (Request);
+    request->start = start;
+    request->user_data = user_data;
+    g_queue_push_tail (&self->priv->requests[priority], request);
+
+    if (!request_can_start (self, priority))
+        g_debug ("Request scheduler at '%s' queued %s request (%u waiting)",
+                 self->priv->name, request_priority_names[priority],
+                 g_queue_get_length (&self->priv->requests[priority]));
+
+    request_dispatch (self);
+}
+
+/* Runs in the worker */
+static void
+request_done (MrmDevice *self,
+              RequestPriority priority)
+{
+    g_assert (self->priv->requests_in_flight[priority] > 0);
+    self->priv->requests_in_flight[priority]--;
+    request_dispatch (self);
+}
+
+/* Runs in the worker, after cancelling whatever the requests depend on */
+static void
+request_flush (MrmDevice *self)
+{
+    guint i;
+
+    for (i = 0; i < N_REQUEST_PRIORITIES; i++) {
+        while (!g_queue_is_empty (&self->priv->requests[i]))
+            request_start (self, i);
+    }
+}
+
+/*****************************************************************************/
+/* Reload info
+ *
+ * Each reload cycle covers one or more poll groups. The signal info request
+ * and one tx/rx info request per active radio interface are issued at the
+ * same time, and all of them are joined into a single sample, emitted once
+ * the cycle is complete. */
+
+#define N_ACTS 6
+
+/* Serving cell identifiers given in the system info of each radio interface */
+typedef struct {
+    guint32 cell_id;
+    guint32 area_code;
+    guint32 pci;
+} SystemInfoIds;
+
+typedef struct {
+    MrmDevice *self;
+    GCancellable *cancellable;
+    guint groups;
+    gint64 started;
+    guint n_pending;
+    MrmDeviceAct queried;
+    MrmSample sample;
+    gboolean load_serving_cell;
+    MrmServingCell serving_cell;
+    SystemInfoIds system_info_ids[N_ACTS];
+    GArray *carriers;
+} ReloadInfoContext;
+
+typedef struct {
+    ReloadInfoContext *ctx;
+    guint act_i;
+    gint64 sent;
+} TxRxInfoRequest;
+
+static void
+reload_info_context_complete_serving_cell (ReloadInfoContext *ctx)
+{
+    MrmServingCell *serving_cell = &ctx->serving_cell;
+    guint act_i;
+
+    /* No radio interface in service */
+    if (!serving_cell->act) {
+        mrm_serving_cell_init (serving_cell, ctx->started);
+        serving_cell_update (ctx->self, serving_cell);
+        return;
+    }
+
+    act_i = g_bit_nth_lsf (serving_cell->act, -1);
+    serving_cell->cell_id = ctx->system_info_ids[act_i].cell_id;
+    serving_cell->area_code = ctx->system_info_ids[act_i].area_code;
+    serving_cell->pci = ctx->system_info_ids[act_i].pci;
+
+    /* The LTE PCI is only given in the cell location info */
+    if (serving_cell->act == MRM_DEVICE_ACT_LTE)
+        serving_cell->pci = ctx->self->priv->lte_serving_pci;
+
+    serving_cell_update (ctx->self, serving_cell);
+}
+
+static gint16
+carrier_value (gdouble value)
+{
+    return (gint16) CLAMP (value, G_MININT16 + 1, G_MAXINT16);
+}
+
+/* Signal of the primary cell is the one given in the last signal sample; the
+ * secondary cells are looked up in the last neighbor list, which reports every
+ * LTE cell measured by the modem */
+static void
+reload_info_context_complete_carriers (ReloadInfoContext *ctx)
+{
+    const MrmSample *signal_sample = &ctx->self->priv->signal_sample;
+    GArray *neighbors = ctx->self->priv->neighbors;
+    guint i;
+
+    for (i = 0; i < ctx->carriers->len; i++) {
+        MrmCarrier *carrier;
+        gdouble value;
+
+        carrier = &g_array_index (ctx->carriers, MrmCarrier, i);
+        if (carrier->index == 0) {
+            if (mrm_sample_get_value (signal_sample, MRM_SAMPLE_METRIC_LTE_RSRP, &value))
+                carrier->rsrp = carrier_value (10.0 * value);
+            if (mrm_sample_get_value (signal_sample, MRM_SAMPLE_METRIC_LTE_RSRQ, &value))
+                carrier->rsrq = carrier_value (10.0 * value);
+            if (mrm_sample_get_value (signal_sample, MRM_SAMPLE_METRIC_LTE_SNR, &value))
+                carrier->snr = carrier_value (value);
+        } else {
+            const MrmNeighbor *neighbor;
+
+            neighbor = mrm_neighbor_list_find (neighbors, MRM_NEIGHBOR_RAT_LTE, carrier->channel, carrier->pci);
+            if (neighbor) {
+                carrier->rsrp = neighbor->level;
+                carrier->rsrq = neighbor->quality;
+            }
+        }
+    }
+
+    queue_carrier_sample (ctx->self,
+                          mrm_carrier_sample_new (ctx->started,
+                                                  (const MrmCarrier *) ctx->carriers->data,
+                                                  ctx->carriers->len));
+}
+
+static void
+reload_info_context_free (ReloadInfoContext *ctx)
+{
+    MrmDevice *self = ctx->self;
+
+    if (ctx->carriers)
+        g_array_unref (ctx->carriers);
+    g_object_unref (ctx->cancellable);
+    g_slice_free (ReloadInfoContext, ctx);
+
+    request_done (self, REQUEST_PRIORITY_SAMPLING);
+    g_object_unref (self);
+}
+
+static void
+reload_info_context_complete (ReloadInfoContext *ctx)
+{
+    MrmDevice *self = ctx->self;
+    guint i;
+
+    /* Power info is always reported when loaded, even if no radio interface
+     * gave any value; and so is traffic info, even without a data session */
+    if (ctx->groups & MRM_SAMPLE_GROUP_POWER)
+        ctx->sample.groups |= MRM_SAMPLE_GROUP_POWER;
+    if (ctx->groups & MRM_SAMPLE_GROUP_TRAFFIC)
+        ctx->sample.groups |= MRM_SAMPLE_GROUP_TRAFFIC;
+
+    /* The cell change is reported before the sample taken along with it */
+    if (ctx->load_serving_cell && !g_cancellable_is_cancelled (ctx->cancellable))
+        reload_info_context_complete_serving_cell (ctx);
+
+    if (ctx->carriers && !g_cancellable_is_cancelled (ctx->cancellable))
+        reload_info_context_complete_carriers (ctx);
+
+    if (ctx->sample.groups) {
+        ctx->sample.act = g_atomic_int_get (&self->priv->act);
+        ctx->sample.reply_timestamp = g_get_monotonic_time ();
+        queue_sample (self, &ctx->sample);
+        if (ctx->sample.groups & MRM_SAMPLE_GROUP_SIGNAL)
+            self->priv->signal_sample = ctx->sample;
+    }
+
+    /* Serving cell only reloads aren't info cycles */
+    if (!ctx->groups) {
+        reload_info_context_free (ctx);
+        return;
+    }
+
+    g_mutex_lock (&self->priv->lock);
+    self->priv->cycle_duration = g_get_monotonic_time () - ctx->started;
+    g_debug ("Info reload cycle at '%s' took %" G_GINT64_FORMAT " ms (rtt mean %.1lf ms, jitter mean %.1lf ms)",
+             self->priv->name, self->priv->cycle_duration / 1000,
+             self->priv->rtt.mean / 1000.0, self->priv->jitter.mean / 1000.0);
+    g_mutex_unlock (&self->priv->lock);
+    queue_notify (self, PROP_CYCLE_DURATION);
+
+    for (i = 0; i < N_POLL_GROUPS; i++) {
+        if (ctx->groups & (1 << i))
+            self->priv->poll[i].in_flight = FALSE;
+    }
+
+    reload_info_context_free (ctx);
+}
+
+static void
+reload_info_context_check_complete (ReloadInfoContext *ctx)
+{
+    g_assert (ctx->n_pending > 0);
+    if (--ctx->n_pending == 0)
+        reload_info_context_complete (ctx);
+}
+
+static QmiNasRadioInterface
+radio_interface_from_act_i (guint act_i)
+{
+    switch (1 << act_i) {
+    case MRM_DEVICE_ACT_GSM:
+        return QMI_NAS_RADIO_INTERFACE_GSM;
+    case MRM_DEVICE_ACT_UMTS:
+        return QMI_NAS_RADIO_INTERFACE_UMTS;
+    case MRM_DEVICE_ACT_LTE:
+        return QMI_NAS_RADIO_INTERFACE_LTE;
+    case MRM_DEVICE_ACT_CDMA:
+        return QMI_NAS_RADIO_INTERFACE_CDMA_1X;
+    case MRM_DEVICE_ACT_EVDO:
+        return QMI_NAS_RADIO_INTERFACE_CDMA_1XEVDO;
+#if defined WITH_NR5G
+    case MRM_DEVICE_ACT_NR5G:
+        return QMI_NAS_RADIO_INTERFACE_5GNR;
+#endif
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static void
+qmi_client_nas_get_tx_rx_info_ready (QmiClientNas *client,
+                                     GAsyncResult *res,
+                                     TxRxInfoRequest *request)
+{
+    ReloadInfoContext *ctx = request->ctx;
+    QmiMessageNasGetTxRxInfoOutput *output;
+    GError *error = NULL;
+
+    output = qmi_client_nas_get_tx_rx_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_get_tx_rx_info_output_get_result (output, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading tx/rx info: %s", error->message);
+        g_error_free (error);
+    } else {
+        gboolean rx0_tuned = FALSE;
+        gint32 rx0 = 0;
+        gboolean rx1_tuned = FALSE;
+        gint32 rx1 = 0;
+        gboolean in_traffic = FALSE;
+        gint32 tx = 0;
+
+        g_mutex_lock (&ctx->self->priv->lock);
+        timing_stats_add (&ctx->self->priv->rtt, g_get_monotonic_time () - request->sent);
+        g_mutex_unlock (&ctx->self->priv->lock);
+
+        qmi_message_nas_get_tx_rx_info_output_get_rx_chain_0_info (output, &rx0_tuned, &rx0, NULL, NULL, NULL, NULL, NULL);
+        qmi_message_nas_get_tx_rx_info_output_get_rx_chain_1_info (output, &rx1_tuned, &rx1, NULL, NULL, NULL, NULL, NULL);
+        qmi_message_nas_get_tx_rx_info_output_get_tx_info (output, &in_traffic, &tx, NULL);
+
+        if (rx0_tuned)
+            mrm_sample_set_value (&ctx->sample, mrm_sample_metric_find (1 << request->act_i, MRM_SAMPLE_KIND_RX0), 0.1 * ((gdouble)rx0));
+        if (rx1_tuned)
+            mrm_sample_set_value (&ctx->sample, mrm_sample_metric_find (1 << request->act_i, MRM_SAMPLE_KIND_RX1), 0.1 * ((gdouble)rx1));
+        if (in_traffic)
+            mrm_sample_set_value (&ctx->sample, mrm_sample_metric_find (1 << request->act_i, MRM_SAMPLE_KIND_TX), 0.1 * ((gdouble)tx));
+    }
+
+    if (output)
+        qmi_message_nas_get_tx_rx_info_output_unref (output);
+
+    g_slice_free (TxRxInfoRequest, request);
+    reload_info_context_check_complete (ctx);
+}
+
+static void
+reload_info_context_query_power (ReloadInfoContext *ctx,
+                                 MrmDeviceAct act)
+{
+    guint i;
+
+    /* NAS monitoring may have been stopped while the cycle was ongoing */
+    if (g_cancellable_is_cancelled (ctx->cancellable) || !(ctx->groups & MRM_SAMPLE_GROUP_POWER))
+        return;
+
+    for (i = 0; i < N_ACTS; i++) {
+        QmiMessageNasGetTxRxInfoInput *input;
+        TxRxInfoRequest *request;
+
+        /* Query each radio interface only once per cycle */
+        if (!(act & (1 << i)) || (ctx->queried & (1 << i)))
+            continue;
+
+        ctx->queried |= (1 << i);
+        ctx->n_pending++;
+
+        request = g_slice_new (TxRxInfoRequest);
+        request->ctx = ctx;
+        request->act_i = i;
+        request->sent = g_get_monotonic_time ();
+
+        input = qmi_message_nas_get_tx_rx_info_input_new ();
+        qmi_message_nas_get_tx_rx_info_input_set_radio_interface (input, radio_interface_from_act_i (i), NULL);
+        qmi_client_nas_get_tx_rx_info (QMI_CLIENT_NAS (ctx->self->priv->nas),
+                                       input,
+                                       1,
+                                       ctx->cancellable,
+                                       (GAsyncReadyCallback)qmi_client_nas_get_tx_rx_info_ready,
+                                       request);
+        qmi_message_nas_get_tx_rx_info_input_unref (input);
+    }
+}
+
+static void
+qmi_client_nas_get_signal_info_ready (QmiClientNas *client,
+                                      GAsyncResult *res,
+                                      ReloadInfoContext *ctx)
+{
+    QmiMessageNasGetSignalInfoOutput *output;
+    GError *error = NULL;
+
+    output = qmi_client_nas_get_signal_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_get_signal_info_output_get_result (output, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading signal info: %s", error->message);
+        g_error_free (error);
+    } else {
+        SignalInfo info;
+        MrmDeviceAct act;
+
+        /* The signal info request is the first one issued in the cycle */
+        g_mutex_lock (&ctx->self->priv->lock);
+        timing_stats_add (&ctx->self->priv->rtt, g_get_monotonic_time () - ctx->started);
+        g_mutex_unlock (&ctx->self->priv->lock);
+
+        /* Get signal info */
+        signal_info_init (&info);
+        info.has_gsm = qmi_message_nas_get_signal_info_output_get_gsm_signal_strength (output, &info.gsm_rssi, NULL);
+        info.has_umts = qmi_message_nas_get_signal_info_output_get_wcdma_signal_strength (output, &info.umts_rssi, &info.umts_ecio, NULL);
+        info.has_lte = qmi_message_nas_get_signal_info_output_get_lte_signal_strength (output, &info.lte_rssi, &info.lte_rsrq, &info.lte_rsrp, &info.lte_snr, NULL);
+        info.has_cdma = qmi_message_nas_get_signal_info_output_get_cdma_signal_strength (output, &info.cdma_rssi, &info.cdma_ecio, NULL);
+        info.has_evdo = qmi_message_nas_get_signal_info_output_get_hdr_signal_strength (output, &info.evdo_rssi, &info.evdo_ecio, &info.evdo_sinr_level, &info.evdo_io, NULL);
+#if defined WITH_NR5G
+        info.has_nr5g = qmi_message_nas_get_signal_info_output_get_5g_signal_strength (output, &info.nr5g_rsrp, &info.nr5g_snr, NULL);
+        if (info.has_nr5g)
+            qmi_message_nas_get_signal_info_output_get_5g_signal_strength_extended (output, &info.nr5g_rsrq, NULL);
+#endif
+
+        act = signal_info_to_sample (ctx->self, &info, &ctx->sample);
+
+        /* Power info was requested in parallel for the interfaces that were
+         * active in the previous cycle; if new ones showed up, query them as
+         * part of this same cycle */
+        reload_info_context_query_power (ctx, act);
+    }
+
+    if (output)
+        qmi_message_nas_get_signal_info_output_unref (output);
+
+    reload_info_context_check_complete (ctx);
+}
+
+/* Runs in the worker */
+static void
+neighbors_update (MrmDevice *self,
+                  GArray *neighbors,
+                  gint64 timestamp)
+{
+    MrmNeighborDelta *delta;
+
+    /* Only what changed since the last list is reported */
+    mrm_neighbor_list_sort (neighbors);
+    delta = mrm_neighbor_list_diff (self->priv->neighbors, neighbors, timestamp);
+    g_array_unref (self->priv->neighbors);
+    self->priv->neighbors = neighbors;
+
+    if (delta) {
+        g_debug ("Neighbor list at '%s' updated: %u cells, %u updated, %u removed",
+                 self->priv->name, neighbors->len, delta->updated->len, delta->removed->len);
+        queue_neighbor_delta (self, delta);
+    }
+}
+
+static void
+neighbor_add (GArray *neighbors,
+              MrmNeighborRat rat,
+              gboolean intra,
+              guint32 channel,
+              guint16 cell_id,
+              gint level,
+              gint quality)
+{
+    MrmNeighbor neighbor;
+
+    neighbor.rat = rat;
+    neighbor.intra = !!intra;
+    neighbor.cell_id = cell_id;
+    neighbor.channel = channel;
+    neighbor.level = CLAMP (level, G_MININT16 + 1, G_MAXINT16);
+    neighbor.quality = (quality == MRM_NEIGHBOR_QUALITY_UNKNOWN ?
+                        MRM_NEIGHBOR_QUALITY_UNKNOWN :
+                        CLAMP (quality, G_MININT16 + 1, G_MAXINT16));
+    g_array_append_vals (neighbors, &neighbor, 1);
+}
+
+static void
+qmi_client_nas_get_cell_location_info_ready (QmiClientNas *client,
+                                             GAsyncResult *res,
+                                             ReloadInfoContext *ctx)
+{
+    QmiMessageNasGetCellLocationInfoOutput *output;
+    GError *error = NULL;
+    GArray *neighbors;
+    GArray *array;
+    guint16 channel;
+    guint16 serving_cell_id;
+    gboolean lte_info = FALSE;
+    guint i;
+    guint j;
+
+    output = qmi_client_nas_get_cell_location_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_get_cell_location_info_output_get_result (output, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading cell location info: %s", error->message);
+        g_error_free (error);
+        if (output)
+            qmi_message_nas_get_cell_location_info_output_unref (output);
+        reload_info_context_check_complete (ctx);
+        return;
+    }
+
+    g_mutex_lock (&ctx->self->priv->lock);
+    timing_stats_add (&ctx->self->priv->rtt, g_get_monotonic_time () - ctx->started);
+    g_mutex_unlock (&ctx->self->priv->lock);
+
+    neighbors = mrm_neighbor_list_new ();
+
+    /* LTE values are given in tenths of dB already; the serving cell is
+     * reported within the intra-frequency list, skip it */
+    array = NULL;
+    if (qmi_message_nas_get_cell_location_info_output_get_intrafrequency_lte_info (
+            output, NULL, NULL, NULL, NULL, &channel, &serving_cell_id, NULL, NULL, NULL, NULL, &array, NULL) && array) {
+        lte_info = TRUE;
+        for (i = 0; i < array->len; i++) {
+            QmiMessageNasGetCellLocationInfoOutputIntrafrequencyLteInfoCellElement *cell;
+
+            cell = &g_array_index (array, QmiMessageNasGetCellLocationInfoOutputIntrafrequencyLteInfoCellElement, i);
+            if (cell->physical_cell_id == serving_cell_id)
+                continue;
+            neighbor_add (neighbors, MRM_NEIGHBOR_RAT_LTE, TRUE, channel, cell->physical_cell_id, cell->rsrp, cell->rsrq);
+        }
+    }
+
+    array = NULL;
+    if (qmi_message_nas_get_cell_location_info_output_get_interfrequency_lte_info (output, NULL, &array, NULL) && array) {
+        for (i = 0; i < array->len; i++) {
+            QmiMessageNasGetCellLocationInfoOutputInterfrequencyLteInfoFrequencyElement *frequency;
+
+            frequency = &g_array_index (array, QmiMessageNasGetCellLocationInfoOutputInterfrequencyLteInfoFrequencyElement, i);
+            for (j = 0; frequency->cell && j < frequency->cell->len; j++) {
+                QmiMessageNasGetCellLocationInfoOutputInterfrequencyLteInfoFrequencyElementCellElement *cell;
+
+                cell = &g_array_index (frequency->cell, QmiMessageNasGetCellLocationInfoOutputInterfrequencyLteInfoFrequencyElementCellElement, j);
+                neighbor_add (neighbors, MRM_NEIGHBOR_RAT_LTE, FALSE,
+                              frequency->eutra_absolute_rf_channel_number, cell->physical_cell_id,
+                              cell->rsrp, cell->rsrq);
+            }
+        }
+    }
+
+    /* UMTS values are given in whole dB */
+    {
+        GArray *geran = NULL;
+        guint16 psc;
+
+        array = NULL;
+        if (qmi_message_nas_get_cell_location_info_output_get_umts_info (
+                output, NULL, NULL, NULL, &channel, &psc, NULL, NULL, &array, &geran, NULL)) {
+            for (i = 0; array && i < array->len; i++) {
+                QmiMessageNasGetCellLocationInfoOutputUmtsInfoCellElement *cell;
+
+                cell = &g_array_index (array, QmiMessageNasGetCellLocationInfoOutputUmtsInfoCellElement, i);
+                if (cell->utra_absolute_rf_channel_number == channel && cell->primary_scrambling_code == psc)
+                    continue;
+                neighbor_add (neighbors, MRM_NEIGHBOR_RAT_UMTS,
+                              cell->utra_absolute_rf_channel_number == channel,
+                              cell->utra_absolute_rf_channel_number, cell->primary_scrambling_code,
+                              10 * cell->rscp, 10 * cell->ecio);
+            }
+            for (i = 0; geran && i < geran->len; i++) {
+                QmiMessageNasGetCellLocationInfoOutputUmtsInfoNeighboringGeranElement *cell;
+
+                cell = &g_array_index (geran, QmiMessageNasGetCellLocationInfoOutputUmtsInfoNeighboringGeranElement, i);
+                neighbor_add (neighbors, MRM_NEIGHBOR_RAT_GSM, FALSE,
+                              cell->geran_absolute_rf_channel_number,
+                              (cell->network_color_code << 3) | cell->base_station_color_code,
+                              10 * cell->rssi, MRM_NEIGHBOR_QUALITY_UNKNOWN);
+            }
+        }
+    }
+
+    /* GSM rx levels go from 0 (-111 dBm or less) to 63 (-48 dBm or more) */
+    array = NULL;
+    if (qmi_message_nas_get_cell_location_info_output_get_geran_info (
+            output, NULL, NULL, NULL, &channel, NULL, NULL, NULL, &array, NULL) && array) {
+        for (i = 0; i < array->len; i++) {
+            QmiMessageNasGetCellLocationInfoOutputGeranInfoCellElement *cell;
+
+            cell = &g_array_index (array, QmiMessageNasGetCellLocationInfoOutputGeranInfoCellElement, i);
+            neighbor_add (neighbors, MRM_NEIGHBOR_RAT_GSM,
+                          cell->geran_absolute_rf_channel_number == channel,
+                          cell->geran_absolute_rf_channel_number, cell->base_station_identity_code,
+                          10 * ((gint) cell->rx_level - 111), MRM_NEIGHBOR_QUALITY_UNKNOWN);
+        }
+    }
+
+    qmi_message_nas_get_cell_location_info_output_unref (output);
+
+    /* NAS monitoring may have been stopped while the request was ongoing */
+    if (g_cancellable_is_cancelled (ctx->cancellable)) {
+        g_array_unref (neighbors);
+        reload_info_context_check_complete (ctx);
+        return;
+    }
+
+    neighbors_update (ctx->self, neighbors, ctx->started);
+
+    /* A reselection within the same LTE frequency is only seen in the PCI */
+    ctx->self->priv->lte_serving_pci = (lte_info ? serving_cell_id : MRM_SERVING_CELL_UNKNOWN);
+    if (ctx->self->priv->serving_cell.act == MRM_DEVICE_ACT_LTE &&
+        ctx->self->priv->serving_cell.pci != ctx->self->priv->lte_serving_pci) {
+        MrmServingCell serving_cell;
+
+        serving_cell = ctx->self->priv->serving_cell;
+        serving_cell.timestamp = ctx->started;
+        serving_cell.pci = ctx->self->priv->lte_serving_pci;
+        serving_cell_update (ctx->self, &serving_cell);
+    }
+
+    reload_info_context_check_complete (ctx);
+}
+
+static void
+qmi_client_nas_get_rf_band_info_ready (QmiClientNas *client,
+                                       GAsyncResult *res,
+                                       ReloadInfoContext *ctx)
+{
+    QmiMessageNasGetRfBandInfoOutput *output;
+    GError *error = NULL;
+    GArray *list = NULL;
+
+    output = qmi_client_nas_get_rf_band_info_finish (client, res, &error);
+    if (!output ||
+        !qmi_message_nas_get_rf_band_info_output_get_result (output, &error) ||
+        !qmi_message_nas_get_rf_band_info_output_get_list (output, &list, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading RF band info: %s", error->message);
+        g_error_free (error);
+    } else {
+        static const MrmDeviceAct preference[] = {
+            MRM_DEVICE_ACT_LTE,
+            MRM_DEVICE_ACT_NR5G,
+            MRM_DEVICE_ACT_UMTS,
+            MRM_DEVICE_ACT_GSM,
+            MRM_DEVICE_ACT_EVDO,
+            MRM_DEVICE_ACT_CDMA,
+        };
+        guint i;
+        guint j;
+
+        /* If several radio interfaces are active, the serving cell is the
+         * one in the most capable of them */
+        for (i = 0; i < G_N_ELEMENTS (preference) && !ctx->serving_cell.act; i++) {
+            for (j = 0; j < list->len; j++) {
+                QmiMessageNasGetRfBandInfoOutputListElement *element;
+
+                element = &g_array_index (list, QmiMessageNasGetRfBandInfoOutputListElement, j);
+                if (act_from_radio_interface (element->radio_interface) != preference[i])
+                    continue;
+
+                ctx->serving_cell.act = preference[i];
+                ctx->serving_cell.band = element->active_band_class;
+                ctx->serving_cell.channel = element->active_channel;
+                break;
+            }
+        }
+    }
+
+    if (output)
+        qmi_message_nas_get_rf_band_info_output_unref (output);
+
+    reload_info_context_check_complete (ctx);
+}
+
+static void
+qmi_client_nas_get_system_info_ready (QmiClientNas *client,
+                                      GAsyncResult *res,
+                                      ReloadInfoContext *ctx)
+{
+    QmiMessageNasGetSystemInfoOutput *output;
+    GError *error = NULL;
+
+    output = qmi_client_nas_get_system_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_get_system_info_output_get_result (output, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading system info: %s", error->message);
+        g_error_free (error);
+    } else {
+        SystemInfoIds *ids;
+        gboolean lac_valid = FALSE;
+        guint16 lac = 0;
+        gboolean cid_valid = FALSE;
+        guint32 cid = 0;
+        gboolean tac_valid = FALSE;
+        guint16 tac = 0;
+        gboolean psc_valid = FALSE;
+        guint16 psc = 0;
+
+        ids = &ctx->system_info_ids[g_bit_nth_lsf (MRM_DEVICE_ACT_LTE, -1)];
+        if (qmi_message_nas_get_system_info_output_get_lte_system_info (
+                output,
+                NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                NULL, NULL,
+                &cid_valid, &cid,
+                NULL, NULL, NULL, NULL, NULL, NULL,
+                &tac_valid, &tac,
+                NULL)) {
+            if (cid_valid)
+                ids->cell_id = cid;
+            if (tac_valid)
+                ids->area_code = tac;
+        }
+
+        cid_valid = FALSE;
+        ids = &ctx->system_info_ids[g_bit_nth_lsf (MRM_DEVICE_ACT_UMTS, -1)];
+        if (qmi_message_nas_get_system_info_output_get_wcdma_system_info (
+                output,
+                NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                &lac_valid, &lac,
+                &cid_valid, &cid,
+                NULL, NULL, NULL, NULL, NULL, NULL,
+                NULL, NULL, NULL, NULL,
+                &psc_valid, &psc,
+                NULL)) {
+            if (cid_valid)
+                ids->cell_id = cid;
+            if (lac_valid)
+                ids->area_code = lac;
+            if (psc_valid)
+                ids->pci = psc;
+        }
+
+        lac_valid = FALSE;
+        cid_valid = FALSE;
+        ids = &ctx->system_info_ids[g_bit_nth_lsf (MRM_DEVICE_ACT_GSM, -1)];
+        if (qmi_message_nas_get_system_info_output_get_gsm_system_info (
+                output,
+                NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                &lac_valid, &lac,
+                &cid_valid, &cid,
+                NULL, NULL, NULL, NULL, NULL, NULL,
+                NULL, NULL, NULL, NULL,
+                NULL)) {
+            if (cid_valid)
+                ids->cell_id = cid;
+            if (lac_valid)
+                ids->area_code = lac;
+        }
+    }
+
+    if (output)
+        qmi_message_nas_get_system_info_output_unref (output);
+
+    reload_info_context_check_complete (ctx);
+}
+
+static guint32
+bandwidth_khz_from_qmi (QmiNasDLBandwidth bandwidth)
+{
+    switch (bandwidth) {
+    case QMI_NAS_DL_BANDWIDTH_1_4:
+        return 1400;
+    case QMI_NAS_DL_BANDWIDTH_3:
+        return 3000;
+    case QMI_NAS_DL_BANDWIDTH_5:
+        return 5000;
+    case QMI_NAS_DL_BANDWIDTH_10:
+        return 10000;
+    case QMI_NAS_DL_BANDWIDTH_15:
+        return 15000;
+    case QMI_NAS_DL_BANDWIDTH_20:
+        return 20000;
+    default:
+        return 0;
+    }
+}
+
+static MrmCarrierState
+carrier_state_from_qmi (QmiNasScellState state)
+{
+    switch (state) {
+    case QMI_NAS_SCELL_STATE_ACTIVATED:
+        return MRM_CARRIER_STATE_ACTIVATED;
+    case QMI_NAS_SCELL_STATE_DEACTIVATED:
+        return MRM_CARRIER_STATE_DEACTIVATED;
+    case QMI_NAS_SCELL_STATE_DECONFIGURED:
+    default:
+        return MRM_CARRIER_STATE_DECONFIGURED;
+    }
+}
+
+static void
+carrier_add (GArray *carriers,
+             guint index,
+             MrmCarrierState state,
+             guint16 pci,
+             guint16 channel,
+             QmiNasDLBandwidth bandwidth,
+             QmiNasActiveBand band)
+{
+    MrmCarrier carrier;
+
+    carrier.index = MIN (index, G_MAXUINT8);
+    carrier.state = state;
+    carrier.pci = pci;
+    carrier.channel = channel;
+    carrier.band = band;
+    carrier.bandwidth_khz = bandwidth_khz_from_qmi (bandwidth);
+    carrier.rsrp = MRM_CARRIER_VALUE_UNKNOWN;
+    carrier.rsrq = MRM_CARRIER_VALUE_UNKNOWN;
+    carrier.snr = MRM_CARRIER_VALUE_UNKNOWN;
+    g_array_append_vals (carriers, &carrier, 1);
+}
+
+static void poll_update (MrmDevice *self);
+
+static void
+qmi_client_nas_get_lte_cphy_ca_info_ready (QmiClientNas *client,
+                                           GAsyncResult *res,
+                                           ReloadInfoContext *ctx)
+{
+    QmiMessageNasGetLteCphyCaInfoOutput *output;
+    GError *error = NULL;
+    guint16 pci;
+    guint16 channel;
+    QmiNasDLBandwidth bandwidth;
+    QmiNasActiveBand band;
+    QmiNasScellState state;
+    guint8 index;
+#if defined WITH_CA_SECONDARY_CELLS
+    GArray *array = NULL;
+    guint i;
+#endif
+
+    output = qmi_client_nas_get_lte_cphy_ca_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_get_lte_cphy_ca_info_output_get_result (output, &error)) {
+        if (g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_NOT_SUPPORTED) ||
+            g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_INVALID_QMI_COMMAND)) {
+            g_debug ("LTE CPHY CA info not supported at '%s'", ctx->self->priv->name);
+            ctx->self->priv->ca_info_unsupported = TRUE;
+            /* Stop polling for them */
+            poll_update (ctx->self);
+        } else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading LTE CPHY CA info: %s", error->message);
+        g_error_free (error);
+        if (output)
+            qmi_message_nas_get_lte_cphy_ca_info_output_unref (output);
+        reload_info_context_check_complete (ctx);
+        return;
+    }
+
+    /* Without a primary cell there is no aggregation to report */
+    if (!qmi_message_nas_get_lte_cphy_ca_info_output_get_phy_ca_agg_pcell_info (output, &pci, &channel, &bandwidth, &band, NULL)) {
+        qmi_message_nas_get_lte_cphy_ca_info_output_unref (output);
+        reload_info_context_check_complete (ctx);
+        return;
+    }
+
+    ctx->carriers = g_array_new (FALSE, FALSE, sizeof (MrmCarrier));
+    carrier_add (ctx->carriers, 0, MRM_CARRIER_STATE_ACTIVATED, pci, channel, bandwidth, band);
+
+    /* Newer modems list all secondary cells; older ones report a single one */
+#if defined WITH_CA_SECONDARY_CELLS
+    if (qmi_message_nas_get_lte_cphy_ca_info_output_get_phy_ca_agg_secondary_cells (output, &array, NULL) && array) {
+        for (i = 0; i < array->len; i++) {
+            QmiMessageNasGetLteCphyCaInfoOutputPhyCaAggSecondaryCellsSsc *scell;
+
+            scell = &g_array_index (array, QmiMessageNasGetLteCphyCaInfoOutputPhyCaAggSecondaryCellsSsc, i);
+            carrier_add (ctx->carriers, scell->cell_index, carrier_state_from_qmi (scell->state),
+                         scell->physical_cell_id, scell->rx_channel, scell->dl_bandwidth, scell->lte_band);
+        }
+    } else
+#endif
+    if (qmi_message_nas_get_lte_cphy_ca_info_output_get_phy_ca_agg_scell_info (output, &pci, &channel, &bandwidth, &band, &state, NULL)) {
+        if (!qmi_message_nas_get_lte_cphy_ca_info_output_get_scell_index (output, &index, NULL))
+            index = 1;
+        carrier_add (ctx->carriers, MAX (index, 1), carrier_state_from_qmi (state), pci, channel, bandwidth, band);
+    }
+
+    qmi_message_nas_get_lte_cphy_ca_info_output_unref (output);
+
+    /* Signal of the secondary cells comes from the neighbor list; load it
+     * unless this cycle already does */
+    if (ctx->carriers->len > 1 && !(ctx->groups & MRM_SAMPLE_GROUP_NEIGHBORS)) {
+        ctx->n_pending++;
+        qmi_client_nas_get_cell_location_info (QMI_CLIENT_NAS (ctx->self->priv->nas),
+                                               NULL,
+                                               10,
+                                               ctx->cancellable,
+                                               (GAsyncReadyCallback)qmi_client_nas_get_cell_location_info_ready,
+                                               ctx);
+    }
+
+    reload_info_context_check_complete (ctx);
+}
+
+/* Runs in the worker. Rates are only computed again once two consecutive
+ * statistics have been loaded. */
+static void
+traffic_counters_reset (MrmDevice *self)
+{
+    guint i;
+
+    self->priv->traffic_timestamp = 0;
+    for (i = 0; i < N_TRAFFIC_COUNTERS; i++)
+        self->priv->traffic_counters[i] = TRAFFIC_COUNTER_UNKNOWN;
+}
+
+static void
+traffic_counter_update (ReloadInfoContext *ctx,
+                        TrafficCounter counter,
+                        guint64 value)
+{
+    MrmDevice *self = ctx->self;
+    guint64 previous;
+    gdouble elapsed;
+    gdouble rate;
+
+    previous = self->priv->traffic_counters[counter];
+    self->priv->traffic_counters[counter] = value;
+
+    /* Counters start from zero on every new data session, so a counter going
+     * backwards doesn't give any rate */
+    if (value == TRAFFIC_COUNTER_UNKNOWN ||
+        previous == TRAFFIC_COUNTER_UNKNOWN ||
+        value < previous)
+        return;
+
+    elapsed = (gdouble)(ctx->started - self->priv->traffic_timestamp) / G_USEC_PER_SEC;
+    if (elapsed <= 0.0)
+        return;
+
+    rate = (gdouble)(value - previous) / elapsed;
+    if (counter == TRAFFIC_COUNTER_TX_BYTES || counter == TRAFFIC_COUNTER_RX_BYTES)
+        rate = rate * 8.0 / 1000.0;
+    mrm_sample_set_value (&ctx->sample, traffic_counter_metrics[counter], rate);
+}
+
+static guint64
+traffic_counter_from_qmi32 (gboolean available,
+                            guint32 value)
+{
+    /* 0xFFFFFFFF is reported for counters not available */
+    return (available && value != G_MAXUINT32) ? value : TRAFFIC_COUNTER_UNKNOWN;
+}
+
+static void
+qmi_device_reallocate_client_wds_ready (QmiDevice *device,
+                                        GAsyncResult *res,
+                                        MrmDevice *self)
+{
+    GError *error = NULL;
+    QmiClient *wds;
+
+    wds = qmi_device_allocate_client_finish (device, res, &error);
+    if (!wds) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Cannot allocate WDS client at '%s', no traffic info: %s",
+                     self->priv->name, error->message);
+        g_error_free (error);
+    } else if (!self->priv->polling || self->priv->wds) {
+        /* Stopped, or restarted with a new client, meanwhile */
+        qmi_device_release_client (device,
+                                   wds,
+                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   5,
+                                   NULL,
+                                   NULL,
+                                   NULL);
+        g_object_unref (wds);
+    } else {
+        self->priv->wds = wds;
+        client_info_update (self, MRM_DEVICE_CLIENT_WDS, wds);
+    }
+
+    g_object_unref (self);
+}
+
+/* Runs in the worker. Traffic info is missing until the new client is
+ * allocated. */
+static void
+wds_reallocate (MrmDevice *self)
+{
+    client_drop_stale (self, MRM_DEVICE_CLIENT_WDS, &self->priv->wds);
+    qmi_device_allocate_client (self->priv->qmi_device,
+                                QMI_SERVICE_WDS,
+                                QMI_CID_NONE,
+                                5,
+                                self->priv->nas_cancellable,
+                                (GAsyncReadyCallback) qmi_device_reallocate_client_wds_ready,
+                                g_object_ref (self));
+}
+
+static void
+qmi_client_wds_get_packet_statistics_ready (QmiClientWds *client,
+                                            GAsyncResult *res,
+                                            ReloadInfoContext *ctx)
+{
+    QmiMessageWdsGetPacketStatisticsOutput *output;
+    GError *error = NULL;
+
+    output = qmi_client_wds_get_packet_statistics_finish (client, res, &error);
+    if (!output || !qmi_message_wds_get_packet_statistics_output_get_result (output, &error)) {
+        if (ctx->self->priv->wds == QMI_CLIENT (client) &&
+            client_is_stale (ctx->self, MRM_DEVICE_CLIENT_WDS, error))
+            wds_reallocate (ctx->self);
+        /* Also reported while there's no data session */
+        else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Error loading packet statistics: %s", error->message);
+        g_error_free (error);
+        traffic_counters_reset (ctx->self);
+    } else {
+        gboolean available;
+        guint32 value32 = 0;
+        guint64 value64 = 0;
+
+        g_mutex_lock (&ctx->self->priv->lock);
+        timing_stats_add (&ctx->self->priv->rtt, g_get_monotonic_time () - ctx->started);
+        g_mutex_unlock (&ctx->self->priv->lock);
+
+        available = qmi_message_wds_get_packet_statistics_output_get_tx_bytes_ok (output, &value64, NULL);
+        traffic_counter_update (ctx, TRAFFIC_COUNTER_TX_BYTES, available ? value64 : TRAFFIC_COUNTER_UNKNOWN);
+        available = qmi_message_wds_get_packet_statistics_output_get_rx_bytes_ok (output, &value64, NULL);
+        traffic_counter_update (ctx, TRAFFIC_COUNTER_RX_BYTES, available ? value64 : TRAFFIC_COUNTER_UNKNOWN);
+        available = qmi_message_wds_get_packet_statistics_output_get_tx_packets_ok (output, &value32, NULL);
+        traffic_counter_update (ctx, TRAFFIC_COUNTER_TX_PACKETS, traffic_counter_from_qmi32 (available, value32));
+        available = qmi_message_wds_get_packet_statistics_output_get_rx_packets_ok (output, &value32, NULL);
+        traffic_counter_update (ctx, TRAFFIC_COUNTER_RX_PACKETS, traffic_counter_from_qmi32 (available, value32));
+        available = qmi_message_wds_get_packet_statistics_output_get_tx_packets_dropped (output, &value32, NULL);
+        traffic_counter_update (ctx, TRAFFIC_COUNTER_TX_DROPPED, traffic_counter_from_qmi32 (available, value32));
+        available = qmi_message_wds_get_packet_statistics_output_get_rx_packets_dropped (output, &value32, NULL);
+        traffic_counter_update (ctx, TRAFFIC_COUNTER_RX_DROPPED, traffic_counter_from_qmi32 (available, value32));
+
+        ctx->self->priv->traffic_timestamp = ctx->started;
+    }
+
+    if (output)
+        qmi_message_wds_get_packet_statistics_output_unref (output);
+
+    reload_info_context_check_complete (ctx);
+}
+
+/* Runs in the worker. Reports all known neighbors as removed. */
+static void
+neighbors_reset (MrmDevice *self)
+{
+    if (self->priv->neighbors->len > 0)
+        neighbors_update (self, mrm_neighbor_list_new (), g_get_monotonic_time ());
+}
+
+static void
+backend_reload_ready (MrmDeviceBackend *backend,
+                      GAsyncResult *res,
+                      ReloadInfoContext *ctx)
+{
+    GError *error = NULL;
+    MrmSample sample;
+    guint i;
+
+    if (!mrm_device_backend_reload_finish (backend, res, &sample, &error)) {
+        g_debug ("Error loading info from backend: %s", error->message);
+        g_error_free (error);
+    } else if (!g_cancellable_is_cancelled (ctx->cancellable)) {
+        g_mutex_lock (&ctx->self->priv->lock);
+        timing_stats_add (&ctx->self->priv->rtt, g_get_monotonic_time () - ctx->started);
+        g_mutex_unlock (&ctx->self->priv->lock);
+
+        if (sample.groups & MRM_SAMPLE_GROUP_SIGNAL)
+            device_set_act (ctx->self, sample.act);
+
+        for (i = 0; i < MRM_SAMPLE_METRIC_LAST; i++) {
+            gdouble value;
+
+            if (mrm_sample_get_value (&sample, i, &value))
+                mrm_sample_set_value (&ctx->sample, i, value);
+        }
+        ctx->sample.groups |= sample.groups;
+        if (sample.gap)
+            ctx->sample.gap = TRUE;
+    }
+
+    reload_info_context_check_complete (ctx);
+}
+
+static void
+reload_info_start (MrmDevice *self,
+                   ReloadInfoContext *ctx)
+{
+    guint groups = ctx->groups;
+    guint i;
+
+    /* Keep the cycle alive until all requests have been issued */
+    ctx->n_pending = 1;
+
+    /* A backend loads all groups at once; serving cells, carriers and
+     * neighbors are only known via QMI, see MrmDeviceBackendInterface */
+    if (self->priv->backend) {
+        ctx->n_pending++;
+        mrm_device_backend_reload (self->priv->backend,
+                                   groups,
+                                   ctx->cancellable,
+                                   (GAsyncReadyCallback) backend_reload_ready,
+                                   ctx);
+        reload_info_context_check_complete (ctx);
+        return;
+    }
+
+    if (ctx->load_serving_cell) {
+        mrm_serving_cell_init (&ctx->serving_cell, ctx->started);
+        for (i = 0; i < N_ACTS; i++) {
+            ctx->system_info_ids[i].cell_id = MRM_SERVING_CELL_UNKNOWN;
+            ctx->system_info_ids[i].area_code = MRM_SERVING_CELL_UNKNOWN;
+            ctx->system_info_ids[i].pci = MRM_SERVING_CELL_UNKNOWN;
+        }
+
+        ctx->n_pending += 2;
+        qmi_client_nas_get_rf_band_info (QMI_CLIENT_NAS (self->priv->nas),
+                                         NULL,
+                                         10,
+                                         ctx->cancellable,
+                                         (GAsyncReadyCallback)qmi_client_nas_get_rf_band_info_ready,
+                                         ctx);
+        qmi_client_nas_get_system_info (QMI_CLIENT_NAS (self->priv->nas),
+                                        NULL,
+                                        10,
+                                        ctx->cancellable,
+                                        (GAsyncReadyCallback)qmi_client_nas_get_system_info_ready,
+                                        ctx);
+    }
+
+    if (groups & MRM_SAMPLE_GROUP_SIGNAL) {
+        ctx->n_pending++;
+        qmi_client_nas_get_signal_info (QMI_CLIENT_NAS (self->priv->nas),
+                                        NULL,
+                                        10,
+                                        ctx->cancellable,
+                                        (GAsyncReadyCallback)qmi_client_nas_get_signal_info_ready,
+                                        ctx);
+    }
+
+    /* Component carriers are only reported while in LTE */
+    if ((groups & MRM_SAMPLE_GROUP_CARRIERS) &&
+        (g_atomic_int_get (&self->priv->act) & MRM_DEVICE_ACT_LTE) &&
+        !self->priv->ca_info_unsupported) {
+        ctx->n_pending++;
+        qmi_client_nas_get_lte_cphy_ca_info (QMI_CLIENT_NAS (self->priv->nas),
+                                             NULL,
+                                             10,
+                                             ctx->cancellable,
+                                             (GAsyncReadyCallback)qmi_client_nas_get_lte_cphy_ca_info_ready,
+                                             ctx);
+    }
+
+    if (groups & MRM_SAMPLE_GROUP_NEIGHBORS) {
+        ctx->n_pending++;
+        qmi_client_nas_get_cell_location_info (QMI_CLIENT_NAS (self->priv->nas),
+                                               NULL,
+                                               10,
+                                               ctx->cancellable,
+                                               (GAsyncReadyCallback)qmi_client_nas_get_cell_location_info_ready,
+                                               ctx);
+    }
+
+    if ((groups & MRM_SAMPLE_GROUP_TRAFFIC) && self->priv->wds) {
+        QmiMessageWdsGetPacketStatisticsInput *input;
+
+        ctx->n_pending++;
+        input = qmi_message_wds_get_packet_statistics_input_new ();
+        qmi_message_wds_get_packet_statistics_input_set_mask (
+            input,
+            (QMI_WDS_PACKET_STATISTICS_MASK_FLAG_TX_PACKETS_OK |
+             QMI_WDS_PACKET_STATISTICS_MASK_FLAG_RX_PACKETS_OK |
+             QMI_WDS_PACKET_STATISTICS_MASK_FLAG_TX_BYTES_OK |
+             QMI_WDS_PACKET_STATISTICS_MASK_FLAG_RX_BYTES_OK |
+             QMI_WDS_PACKET_STATISTICS_MASK_FLAG_TX_PACKETS_DROPPED |
+             QMI_WDS_PACKET_STATISTICS_MASK_FLAG_RX_PACKETS_DROPPED),
+            NULL);
+        qmi_client_wds_get_packet_statistics (QMI_CLIENT_WDS (self->priv->wds),
+                                              input,
+                                              10,
+                                              ctx->cancellable,
+                                              (GAsyncReadyCallback)qmi_client_wds_get_packet_statistics_ready,
+                                              ctx);
+        qmi_message_wds_get_packet_statistics_input_unref (input);
+    }
+
+    /* Tx/rx info for the last known set of active radio interfaces */
+    reload_info_context_query_power (ctx, g_atomic_int_get (&self->priv->act));
+
+    reload_info_context_check_complete (ctx);
+}
+
+static void
+reload_info_run (MrmDevice *self,
+                 guint groups,
+                 gboolean load_serving_cell)
+{
+    ReloadInfoContext *ctx;
+    guint i;
+
+    for (i = 0; i < N_POLL_GROUPS; i++) {
+        if (groups & (1 << i)) {
+            g_assert (!self->priv->poll[i].in_flight);
+            self->priv->poll[i].in_flight = TRUE;
+        }
+    }
+
+    ctx = g_slice_new0 (ReloadInfoContext);
+    ctx->self = g_object_ref (self);
+    ctx->cancellable = g_object_ref (self->priv->nas_cancellable);
+    ctx->groups = groups;
+    ctx->load_serving_cell = load_serving_cell;
+    ctx->started = g_get_monotonic_time ();
+    ctx->sample.timestamp = ctx->started;
+
+    request_submit (self, REQUEST_PRIORITY_SAMPLING, (RequestStartFunc) reload_info_start, ctx);
+}
+
+/* The serving cell is loaded along with the signal info */
+static void
+reload_info (MrmDevice *self,
+             guint groups)
+{
+    reload_info_run (self, groups, !!(groups & MRM_SAMPLE_GROUP_SIGNAL));
+}
+
+/* Runs in the worker */
+static void
+reload_serving_cell (MrmDevice *self)
+{
+    if (!self->priv->polling)
+        return;
+
+    reload_info_run (self, 0, TRUE);
+}
+
+/*****************************************************************************/
+/* Poll scheduler
+ *
+ * Each metric group runs its own schedule, with millisecond resolution, in
+ * the worker context.
+ * Ticks are scheduled against absolute deadlines in the monotonic clock, so
+ * that timer latency doesn't accumulate as drift. A tick that finds the
+ * previous cycle of its group still in flight is skipped and counted as an
+ * overrun; ticks whose deadline already passed when the timer fires are
+ * skipped and counted as late.
+ *
+ * When several devices are monitored, each one is given a slot, and
+ * deadlines are aligned to a grid in the monotonic clock shared by all of
+ * them: every group of every device gets its own phase within the interval,
+ * so that modems on the same hub don't all send their requests at once. */
+
+static gboolean poll_tick_signal_cb    (MrmDevice *self);
+static gboolean poll_tick_power_cb     (MrmDevice *self);
+static gboolean poll_tick_neighbors_cb (MrmDevice *self);
+static gboolean poll_tick_traffic_cb   (MrmDevice *self);
+static gboolean poll_tick_carriers_cb  (MrmDevice *self);
+
+static const GSourceFunc poll_tick_cbs[N_POLL_GROUPS] = {
+    [POLL_GROUP_SIGNAL]    = (GSourceFunc) poll_tick_signal_cb,
+    [POLL_GROUP_POWER]     = (GSourceFunc) poll_tick_power_cb,
+    [POLL_GROUP_NEIGHBORS] = (GSourceFunc) poll_tick_neighbors_cb,
+    [POLL_GROUP_TRAFFIC]   = (GSourceFunc) poll_tick_traffic_cb,
+    [POLL_GROUP_CARRIERS]  = (GSourceFunc) poll_tick_carriers_cb,
+};
+
+static gint64
+poll_interval (PollSchedule *poll)
+{
+    return ((gint64) g_atomic_int_get (&poll->interval_ms)) * 1000;
+}
+
+static void
+poll_schedule_next (MrmDevice *self,
+                    PollGroup group)
+{
+    PollSchedule *poll = &self->priv->poll[group];
+    gint64 delay;
+
+    delay = poll->deadline - g_get_monotonic_time ();
+    if (delay < 0)
+        delay = 0;
+
+    poll->source = g_timeout_source_new ((guint) ((delay + 999) / 1000));
+    g_source_set_callback (poll->source, poll_tick_cbs[group], self, NULL);
+    g_source_attach (poll->source, self->priv->worker_context);
+}
+
+static void
+poll_tick (MrmDevice *self,
+           PollGroup group)
+{
+    PollSchedule *poll = &self->priv->poll[group];
+    gint64 now;
+    gint64 scheduled;
+    guint missed = 0;
+
+    g_source_unref (poll->source);
+    poll->source = NULL;
+
+    /* Move on to the next deadline, skipping the ones already gone */
+    now = g_get_monotonic_time ();
+    scheduled = poll->deadline;
+    poll->deadline += poll_interval (poll);
+    while (poll->deadline <= now) {
+        poll->deadline += poll_interval (poll);
+        missed++;
+    }
+    if (missed) {
+        g_debug ("Poll scheduler at '%s' skipped %u late ticks", self->priv->name, missed);
+        g_mutex_lock (&self->priv->lock);
+        self->priv->late_ticks += missed;
+        g_mutex_unlock (&self->priv->lock);
+        queue_notify (self, PROP_LATE_TICKS);
+    }
+
+    if (poll->in_flight) {
+        g_debug ("Poll scheduler at '%s' skipped tick: previous cycle still ongoing", self->priv->name);
+        g_mutex_lock (&self->priv->lock);
+        self->priv->overrun_ticks++;
+        g_mutex_unlock (&self->priv->lock);
+        queue_notify (self, PROP_OVERRUN_TICKS);
+    } else {
+        /* Sampling jitter is how far from its deadline the request is sent */
+        g_mutex_lock (&self->priv->lock);
+        timing_stats_add (&self->priv->jitter, now - scheduled);
+        g_mutex_unlock (&self->priv->lock);
+        reload_info (self, 1 << group);
+    }
+
+    poll_schedule_next (self, group);
+}
+
+static gboolean
+poll_tick_signal_cb (MrmDevice *self)
+{
+    poll_tick (self, POLL_GROUP_SIGNAL);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+poll_tick_power_cb (MrmDevice *self)
+{
+    poll_tick (self, POLL_GROUP_POWER);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+poll_tick_neighbors_cb (MrmDevice *self)
+{
+    poll_tick (self, POLL_GROUP_NEIGHBORS);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+poll_tick_traffic_cb (MrmDevice *self)
+{
+    poll_tick (self, POLL_GROUP_TRAFFIC);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+poll_tick_carriers_cb (MrmDevice *self)
+{
+    poll_tick (self, POLL_GROUP_CARRIERS);
+    return G_SOURCE_REMOVE;
+}
+
+static gint64
+poll_first_deadline (MrmDevice *self,
+                     PollGroup group)
+{
+    gint64 interval;
+    gint64 deadline;
+    gint64 phase;
+    guint n_slots;
+    guint slot;
+
+    interval = poll_interval (&self->priv->poll[group]);
+    deadline = g_get_monotonic_time () + interval;
+
+    n_slots = g_atomic_int_get (&self->priv->poll_n_slots);
+    if (n_slots <= 1)
+        return deadline;
+
+    /* Move forward to the next grid point with this slot's phase */
+    slot = MIN ((guint) g_atomic_int_get (&self->priv->poll_slot), n_slots - 1);
+    phase = interval * (slot * N_POLL_GROUPS + group) / (n_slots * N_POLL_GROUPS);
+    return deadline + (((phase - deadline) % interval) + interval) % interval;
+}
+
+static void
+poll_start (MrmDevice *self,
+            PollGroup group)
+{
+    PollSchedule *poll = &self->priv->poll[group];
+
+    g_assert (poll->source == NULL);
+
+    poll->deadline = poll_first_deadline (self, group);
+    poll_schedule_next (self, group);
+}
+
+static void
+poll_stop (MrmDevice *self,
+           PollGroup group)
+{
+    PollSchedule *poll = &self->priv->poll[group];
+
+    if (poll->source) {
+        g_source_destroy (poll->source);
+        g_source_unref (poll->source);
+        poll->source = NULL;
+    }
+}
+
+typedef struct {
+    MrmDevice *self;
+    PollGroup group;
+} PollRescheduleContext;
+
+static gboolean
+poll_reschedule_cb (PollRescheduleContext *ctx)
+{
+    /* Reschedule right away if already running */
+    if (ctx->self->priv->poll[ctx->group].source) {
+        poll_stop (ctx->self, ctx->group);
+        poll_start (ctx->self, ctx->group);
+    }
+
+    g_object_unref (ctx->self);
+    g_slice_free (PollRescheduleContext, ctx);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+poll_reschedule (MrmDevice *self,
+                 PollGroup group)
+{
+    PollRescheduleContext *ctx;
+
+    ctx = g_slice_new (PollRescheduleContext);
+    ctx->self = g_object_ref (self);
+    ctx->group = group;
+    worker_invoke (self, (GSourceFunc) poll_reschedule_cb, ctx);
+}
+
+static void
+poll_set_interval (MrmDevice *self,
+                   PollGroup group,
+                   guint interval_ms)
+{
+    g_atomic_int_set (&self->priv->poll[group].interval_ms, interval_ms);
+    poll_reschedule (self, group);
+}
+
+/* Runs in the worker. Groups are only polled while someone is subscribed to
+ * them; signal info isn't polled at all if reported via indications, nor
+ * component carriers by backends or when the modem doesn't support them, nor
+ * traffic info without a WDS client or backend. */
+static gboolean
+poll_group_wanted (MrmDevice *self,
+                   PollGroup group)
+{
+    if (!self->priv->polling)
+        return FALSE;
+    if (group == POLL_GROUP_SIGNAL && self->priv->signal_info_indications)
+        return FALSE;
+    if (group == POLL_GROUP_CARRIERS && (self->priv->backend || self->priv->ca_info_unsupported))
+        return FALSE;
+    if (group == POLL_GROUP_NEIGHBORS && self->priv->backend)
+        return FALSE;
+    if (group == POLL_GROUP_TRAFFIC && !self->priv->wds && !self->priv->backend)
+        return FALSE;
+    return g_atomic_int_get (&self->priv->poll[group].subscribers) > 0;
+}
+
+/* Runs in the worker */
+static void
+poll_update (MrmDevice *self)
+{
+    guint groups = 0;
+    guint i;
+
+    for (i = 0; i < N_POLL_GROUPS; i++) {
+        gboolean wanted;
+
+        wanted = poll_group_wanted (self, i);
+        if (wanted && !self->priv->poll[i].source) {
+            g_debug ("Poll scheduler at '%s' started %s polling",
+                     self->priv->name, poll_group_names[i]);
+            poll_start (self, i);
+            /* Don't make the new subscriber wait a whole interval */
+            if (!self->priv->poll[i].in_flight)
+                groups |= (1 << i);
+        } else if (!wanted && self->priv->poll[i].source) {
+            g_debug ("Poll scheduler at '%s' stopped %s polling: no subscribers",
+                     self->priv->name, poll_group_names[i]);
+            poll_stop (self, i);
+        }
+    }
+
+    if (groups)
+        reload_info (self, groups);
+}
+
+static gboolean
+poll_update_cb (MrmDevice *self)
+{
+    poll_update (self);
+    g_object_unref (self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_subscribe (MrmDevice *self,
+                      guint groups)
+{
+    guint i;
+
+    g_return_if_fail (MRM_IS_DEVICE (self));
+
+    for (i = 0; i < N_POLL_GROUPS; i++) {
+        if (groups & (1 << i))
+            g_atomic_int_inc (&self->priv->poll[i].subscribers);
+    }
+
+    worker_invoke (self, (GSourceFunc) poll_update_cb, g_object_ref (self));
+}
+
+void
+mrm_device_unsubscribe (MrmDevice *self,
+                        guint groups)
+{
+    guint i;
+
+    g_return_if_fail (MRM_IS_DEVICE (self));
+
+    /* Either all groups are unsubscribed or none */
+    for (i = 0; i < N_POLL_GROUPS; i++) {
+        if (groups & (1 << i))
+            g_return_if_fail (g_atomic_int_get (&self->priv->poll[i].subscribers) > 0);
+    }
+
+    for (i = 0; i < N_POLL_GROUPS; i++) {
+        if (groups & (1 << i))
+            g_atomic_int_add (&self->priv->poll[i].subscribers, -1);
+    }
+
+    worker_invoke (self, (GSourceFunc) poll_update_cb, g_object_ref (self));
+}
+
+void
+mrm_device_set_poll_slot (MrmDevice *self,
+                          guint slot,
+                          guint n_slots)
+{
+    g_return_if_fail (MRM_IS_DEVICE (self));
+    g_return_if_fail (slot < n_slots);
+
+    if ((guint) g_atomic_int_get (&self->priv->poll_slot) == slot &&
+        (guint) g_atomic_int_get (&self->priv->poll_n_slots) == n_slots)
+        return;
+
+    g_atomic_int_set (&self->priv->poll_slot, slot);
+    g_atomic_int_set (&self->priv->poll_n_slots, n_slots);
+    poll_reschedule (self, POLL_GROUP_SIGNAL);
+    poll_reschedule (self, POLL_GROUP_POWER);
+    poll_reschedule (self, POLL_GROUP_NEIGHBORS);
+    poll_reschedule (self, POLL_GROUP_TRAFFIC);
+    poll_reschedule (self, POLL_GROUP_CARRIERS);
+}
+
+/*****************************************************************************/
+/* Serving system tracking */
+
+static MrmDeviceRegistrationState
+registration_state_from_qmi (QmiNasRegistrationState state)
+{
+    switch (state) {
+    case QMI_NAS_REGISTRATION_STATE_NOT_REGISTERED:
+        return MRM_DEVICE_REGISTRATION_STATE_IDLE;
+    case QMI_NAS_REGISTRATION_STATE_REGISTERED:
+        return MRM_DEVICE_REGISTRATION_STATE_REGISTERED;
+    case QMI_NAS_REGISTRATION_STATE_NOT_REGISTERED_SEARCHING:
+        return MRM_DEVICE_REGISTRATION_STATE_SEARCHING;
+    case QMI_NAS_REGISTRATION_STATE_REGISTRATION_DENIED:
+        return MRM_DEVICE_REGISTRATION_STATE_DENIED;
+    case QMI_NAS_REGISTRATION_STATE_UNKNOWN:
+    default:
+        return MRM_DEVICE_REGISTRATION_STATE_UNKNOWN;
+    }
+}
+
+static MrmDeviceAct
+act_from_radio_interfaces (GArray *radio_interfaces)
+{
+    MrmDeviceAct act = 0;
+    guint i;
+
+    for (i = 0; radio_interfaces && i < radio_interfaces->len; i++)
+        act |= act_from_radio_interface (g_array_index (radio_interfaces, QmiNasRadioInterface, i));
+
+    return act;
+}
+
+/* Runs in the worker */
+static void
+serving_system_update (MrmDevice *self,
+                       QmiNasRegistrationState qmi_registration_state,
+                       GArray *radio_interfaces)
+{
+    MrmDeviceRegistrationState registration_state;
+
+    registration_state = registration_state_from_qmi (qmi_registration_state);
+    if ((MrmDeviceRegistrationState) g_atomic_int_get (&self->priv->registration_state) != registration_state) {
+        g_debug ("Registration state at '%s' changed: %s",
+                 self->priv->name, qmi_nas_registration_state_get_string (qmi_registration_state));
+        g_atomic_int_set (&self->priv->registration_state, registration_state);
+        queue_notify (self, PROP_REGISTRATION_STATE);
+    }
+
+    self->priv->serving_system_act = act_from_radio_interfaces (radio_interfaces);
+    device_set_act (self, self->priv->serving_system_act | (self->priv->nr5g_signal ? MRM_DEVICE_ACT_NR5G : 0));
+}
+
+static void
+serving_system_indication_cb (QmiClientNas *client,
+                              QmiIndicationNasServingSystemOutput *output,
+                              MrmDevice *self)
+{
+    QmiNasRegistrationState registration_state;
+    GArray *radio_interfaces = NULL;
+
+    if (qmi_indication_nas_serving_system_output_get_serving_system (output,
+                                                                     &registration_state,
+                                                                     NULL,
+                                                                     NULL,
+                                                                     NULL,
+                                                                     &radio_interfaces,
+                                                                     NULL))
+        serving_system_update (self, registration_state, radio_interfaces);
+
+    /* The serving system is also reported on cell changes */
+    reload_serving_cell (self);
+}
+
+/*****************************************************************************/
+/* Signal info indications */
+
+static void
+signal_info_indication_cb (QmiClientNas *client,
+                           QmiIndicationNasSignalInfoOutput *output,
+                           MrmDevice *self)
+{
+    SignalInfo info;
+    MrmSample sample;
+
+    signal_info_init (&info);
+    info.has_gsm = qmi_indication_nas_signal_info_output_get_gsm_signal_strength (output, &info.gsm_rssi, NULL);
+    info.has_umts = qmi_indication_nas_signal_info_output_get_wcdma_signal_strength (output, &info.umts_rssi, &info.umts_ecio, NULL);
+    info.has_lte = qmi_indication_nas_signal_info_output_get_lte_signal_strength (output, &info.lte_rssi, &info.lte_rsrq, &info.lte_rsrp, &info.lte_snr, NULL);
+    info.has_cdma = qmi_indication_nas_signal_info_output_get_cdma_signal_strength (output, &info.cdma_rssi, &info.cdma_ecio, NULL);
+    info.has_evdo = qmi_indication_nas_signal_info_output_get_hdr_signal_strength (output, &info.evdo_rssi, &info.evdo_ecio, &info.evdo_sinr_level, &info.evdo_io, NULL);
+#if defined WITH_NR5G
+    info.has_nr5g = qmi_indication_nas_signal_info_output_get_5g_signal_strength (output, &info.nr5g_rsrp, &info.nr5g_snr, NULL);
+    if (info.has_nr5g)
+        qmi_indication_nas_signal_info_output_get_5g_signal_strength_extended (output, &info.nr5g_rsrq, NULL);
+#endif
+
+    memset (&sample, 0, sizeof (MrmSample));
+    sample.timestamp = g_get_monotonic_time ();
+    sample.reply_timestamp = sample.timestamp;
+    signal_info_to_sample (self, &info, &sample);
+    queue_sample (self, &sample);
+    self->priv->signal_sample = sample;
+}
+
+/* Delta thresholds configured for each metric, given as an evenly spaced grid
+ * of crossing points: the modem reports a new indication whenever the value
+ * moves from one grid cell to another. */
+#define SIGNAL_INFO_MAX_THRESHOLDS 16
+
+typedef struct {
+    gint min;
+    gint max;
+    gint step;
+} SignalInfoThresholdGrid;
+
+static const SignalInfoThresholdGrid rssi_grid     = { -113,  -51,  4 }; /* dBm */
+static const SignalInfoThresholdGrid ecio_grid     = {   -2,   40,  4 }; /* -0.5 dBm units */
+static const SignalInfoThresholdGrid io_grid       = { -120,  -45,  5 }; /* dBm */
+static const SignalInfoThresholdGrid sinr_grid     = {    0,    8,  1 }; /* SINR level */
+static const SignalInfoThresholdGrid lte_rsrq_grid = {  -20,   -3,  2 }; /* dB */
+static const SignalInfoThresholdGrid lte_rsrp_grid = { -140,  -44,  6 }; /* dBm */
+static const SignalInfoThresholdGrid lte_snr_grid  = { -200,  300, 40 }; /* 0.1 dB units */
+
+static GArray *
+signal_info_threshold_array_new (const SignalInfoThresholdGrid *grid,
+                                 guint element_size)
+{
+    GArray *array;
+    gint value;
+
+    array = g_array_sized_new (FALSE, FALSE, element_size, SIGNAL_INFO_MAX_THRESHOLDS);
+    for (value = grid->min;
+         value <= grid->max && array->len < SIGNAL_INFO_MAX_THRESHOLDS;
+         value += grid->step) {
+        switch (element_size) {
+        case 1: {
+            gint8 v = (gint8) value;
+            g_array_append_val (array, v);
+            break;
+        }
+        case 2: {
+            gint16 v = (gint16) value;
+            g_array_append_val (array, v);
+            break;
+        }
+        case 4: {
+            gint32 v = (gint32) value;
+            g_array_append_val (array, v);
+            break;
+        }
+        default:
+            g_assert_not_reached ();
+        }
+    }
+
+    return array;
+}
+
+static QmiMessageNasConfigSignalInfoInput *
+signal_info_config_input_new (void)
+{
+    QmiMessageNasConfigSignalInfoInput *input;
+    GArray *array;
+
+    input = qmi_message_nas_config_signal_info_input_new ();
+
+    array = signal_info_threshold_array_new (&rssi_grid, sizeof (gint8));
+    qmi_message_nas_config_signal_info_input_set_rssi_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    array = signal_info_threshold_array_new (&ecio_grid, sizeof (gint16));
+    qmi_message_nas_config_signal_info_input_set_ecio_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    array = signal_info_threshold_array_new (&sinr_grid, sizeof (guint8));
+    qmi_message_nas_config_signal_info_input_set_sinr_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    array = signal_info_threshold_array_new (&io_grid, sizeof (gint32));
+    qmi_message_nas_config_signal_info_input_set_io_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    array = signal_info_threshold_array_new (&lte_rsrq_grid, sizeof (gint8));
+    qmi_message_nas_config_signal_info_input_set_rsrq_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    array = signal_info_threshold_array_new (&lte_rsrp_grid, sizeof (gint16));
+    qmi_message_nas_config_signal_info_input_set_rsrp_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    array = signal_info_threshold_array_new (&lte_snr_grid, sizeof (gint16));
+    qmi_message_nas_config_signal_info_input_set_lte_snr_threshold (input, array, NULL);
+    g_array_unref (array);
+
+    return input;
+}
+
+/*****************************************************************************/
+/* Reload status
+ *
+ * Some modems reply to the PIN status request with an incorrect PIN error
+ * until the SIM is ready. The request is then retried with a jittered
+ * exponential backoff, up to a number of attempts and a deadline, so that a
+ * misbehaving modem doesn't keep its control channel and the worker busy. */
+
+#define PIN_STATUS_RETRY_DELAY_MS_MIN 100
+#define PIN_STATUS_RETRY_DELAY_MS_MAX 2000
+#define PIN_STATUS_RETRY_DEADLINE_MS  15000
+#define PIN_STATUS_MAX_ATTEMPTS       10
+
+typedef struct {
+    GSimpleAsyncResult *result;
+    QmiClientDms *dms;
+    GCancellable *cancellable;
+    gint64 started;
+    guint attempts;
+} ReloadStatusContext;
+
+static void
+reload_status_context_complete_and_free (ReloadStatusContext *ctx)
+{
+    g_simple_async_result_complete (ctx->result);
+    g_object_unref (ctx->result);
+    if (ctx->cancellable)
+        g_object_unref (ctx->cancellable);
+    g_object_unref (ctx->dms);
+    g_slice_free (ReloadStatusContext, ctx);
+}
+
+static gboolean
+reload_status_finish (MrmDevice *self,
+                      GAsyncResult *res,
+                      GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void reload_status_run (ReloadStatusContext *ctx);
+
+static gboolean
+reload_status_retry_cb (ReloadStatusContext *ctx)
+{
+    reload_status_run (ctx);
+    return G_SOURCE_REMOVE;
+}
+
+/* Returns FALSE if out of attempts or time */
+static gboolean
+reload_status_retry (MrmDevice *self,
+                     ReloadStatusContext *ctx)
+{
+    guint delay_ms;
+    GSource *source;
+
+    if (ctx->attempts >= PIN_STATUS_MAX_ATTEMPTS)
+        return FALSE;
+
+    /* Doubled on each attempt; picked randomly from its upper half, so that
+     * modems reset together don't retry in lockstep */
+    delay_ms = MIN (PIN_STATUS_RETRY_DELAY_MS_MIN << (ctx->attempts - 1), PIN_STATUS_RETRY_DELAY_MS_MAX);
+    delay_ms = g_random_int_range (delay_ms / 2, delay_ms + 1);
+    if (g_get_monotonic_time () + (delay_ms * 1000) > ctx->started + (PIN_STATUS_RETRY_DEADLINE_MS * 1000))
+        return FALSE;
+
+    g_debug ("PIN status at '%s' not available yet, retrying in %u ms (attempt %u)",
+             self->priv->name, delay_ms, ctx->attempts + 1);
+
+    g_mutex_lock (&self->priv->lock);
+    self->priv->pin_status_retries++;
+    g_mutex_unlock (&self->priv->lock);
+    queue_notify (self, PROP_PIN_STATUS_RETRIES);
+
+    /* Retried in the same context the request was sent from */
+    source = g_timeout_source_new (delay_ms);
+    g_source_set_callback (source, (GSourceFunc) reload_status_retry_cb, ctx, NULL);
+    g_source_attach (source, g_main_context_get_thread_default ());
+    g_source_unref (source);
+    return TRUE;
+}
+
+static void
+qmi_client_dms_get_pin_status_ready (QmiClientDms *dms,
+                                     GAsyncResult *res,
+                                     ReloadStatusContext *ctx)
+{
+    QmiDmsUimPinStatus current_status;
+    guint8 pin1_status_verify_retries_left;
+    QmiMessageDmsUimGetPinStatusOutput *output;
+    GSimpleAsyncResult *simple = ctx->result;
+    GError *error = NULL;
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    request_done (self, REQUEST_PRIORITY_CONTROL);
+    output = qmi_client_dms_uim_get_pin_status_finish (dms, res, &error);
+    if (!output) {
+        g_prefix_error (&error, "QMI operation failed: ");
+        g_simple_async_result_take_error (simple, error);
+    } else if (!qmi_message_dms_uim_get_pin_status_output_get_result (output, &error)) {
+        /* QMI error internal when checking PIN status likely means NO SIM */
+        if (g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_INTERNAL)) {
+            self->priv->status = MRM_DEVICE_STATUS_SIM_ERROR;
+            g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+            g_error_free (error);
+        } else if (g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_INCORRECT_PIN)) {
+            /* Stupid modem... retry for a while until we get a proper result */
+            if (reload_status_retry (self, ctx)) {
+                qmi_message_dms_uim_get_pin_status_output_unref (output);
+                g_object_unref (self);
+                g_error_free (error);
+                return;
+            }
+            g_prefix_error (&error, "couldn't get PIN status after %u attempts: ", ctx->attempts);
+            g_simple_async_result_take_error (simple, error);
+        } else {
+            g_prefix_error (&error, "couldn't get PIN status: ");
+            g_simple_async_result_take_error (simple, error);
+        }
+    } else if (!qmi_message_dms_uim_get_pin_status_output_get_pin1_status (
+                   output,
+                   &current_status,
+                   &pin1_status_verify_retries_left, /* verify_retries_left */
+                   NULL, /* unblock_retries_left */
+                   &error)) {
+        g_prefix_error (&error, "couldn't get PIN1 status: ");
+        g_simple_async_result_take_error (simple, error);
+    } else {
+        switch (current_status) {
+        case QMI_DMS_UIM_PIN_STATUS_CHANGED:
+        case QMI_DMS_UIM_PIN_STATUS_UNBLOCKED:
+        case QMI_DMS_UIM_PIN_STATUS_DISABLED:
+        case QMI_DMS_UIM_PIN_STATUS_ENABLED_VERIFIED:
+            self->priv->pin_attempts_left = -1;
+            self->priv->status = MRM_DEVICE_STATUS_READY;
+            break;
+
+        case QMI_DMS_UIM_PIN_STATUS_BLOCKED:
+            self->priv->pin_attempts_left = 0;
+            self->priv->status = MRM_DEVICE_STATUS_SIM_PUK_LOCKED;
+            break;
+
+        case QMI_DMS_UIM_PIN_STATUS_PERMANENTLY_BLOCKED:
+            self->priv->pin_attempts_left = -1;
+            self->priv->status = MRM_DEVICE_STATUS_SIM_ERROR;
+            break;
+
+        case QMI_DMS_UIM_PIN_STATUS_NOT_INITIALIZED:
+        case QMI_DMS_UIM_PIN_STATUS_ENABLED_NOT_VERIFIED:
+            self->priv->pin_attempts_left = (gint)pin1_status_verify_retries_left;
+            self->priv->status = MRM_DEVICE_STATUS_SIM_PIN_LOCKED;
+            break;
+
+        default:
+            /* Unknown SIM error */
+            self->priv->pin_attempts_left = -1;
+            self->priv->status = MRM_DEVICE_STATUS_SIM_ERROR;
+            break;
+        }
+
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    }
+
+    if (output)
+        qmi_message_dms_uim_get_pin_status_output_unref (output);
+    g_object_unref (self);
+
+    /* Notify about the internal property change */
+    queue_notify (self, PROP_STATUS);
+
+    reload_status_context_complete_and_free (ctx);
+}
+
+static void
+reload_status_start (MrmDevice *self,
+                     ReloadStatusContext *ctx)
+{
+    ctx->attempts++;
+    qmi_client_dms_uim_get_pin_status (
+        ctx->dms,
+        NULL,
+        5,
+        ctx->cancellable,
+        (GAsyncReadyCallback) qmi_client_dms_get_pin_status_ready,
+        ctx);
+}
+
+/* Each attempt is a request on its own, so that no slot is held while
+ * waiting to retry */
+static void
+reload_status_run (ReloadStatusContext *ctx)
+{
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (ctx->result)));
+    request_submit (self, REQUEST_PRIORITY_CONTROL, (RequestStartFunc) reload_status_start, ctx);
+    g_object_unref (self);
+}
+
+static void
+reload_status (MrmDevice *self,
+               GCancellable *cancellable,
+               GAsyncReadyCallback callback,
+               gpointer user_data)
+{
+    ReloadStatusContext *ctx;
+
+    g_return_if_fail (QMI_IS_CLIENT_DMS (self->priv->dms));
+
+    /* Retries keep using the same client, even if the device is
+     * disconnected meanwhile */
+    ctx = g_slice_new0 (ReloadStatusContext);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             reload_status);
+    ctx->dms = QMI_CLIENT_DMS (g_object_ref (self->priv->dms));
+    if (cancellable)
+        ctx->cancellable = g_object_ref (cancellable);
+    ctx->started = g_get_monotonic_time ();
+    reload_status_run (ctx);
+}
+
+/*****************************************************************************/
+
+gboolean
+mrm_device_unlock_finish (MrmDevice *self,
+                          GAsyncResult *res,
+                          GError **error)
+{
+    if (self->priv->status != MRM_DEVICE_STATUS_READY) {
+        g_set_error (error,
+                     MRM_CORE_ERROR,
+                     MRM_CORE_ERROR_FAILED,
+                     "SIM still locked after unlock attempt");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+after_pin_reload_status_ready (MrmDevice *self,
+                               GAsyncResult *res,
+                               GSimpleAsyncResult *simple)
+{
+    reload_status_finish (self, res, NULL);
+
+    g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+}
+
+static void
+qmi_dms_uim_verify_pin_ready (QmiClientDms *client,
+                              GAsyncResult *res,
+                              GSimpleAsyncResult *simple)
+{
+    QmiMessageDmsUimVerifyPinOutput *output = NULL;
+    GError *error = NULL;
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    request_done (self, REQUEST_PRIORITY_CONTROL);
+
+    output = qmi_client_dms_uim_verify_pin_finish (client, res, NULL);
+    if (output)
+        qmi_message_dms_uim_verify_pin_output_unref (output);
+
+    /* Ignore errors here; just reload status */
+
+    reload_status (self,
+                   self->priv->cancellable,
+                   (GAsyncReadyCallback)after_pin_reload_status_ready,
+                   simple);
+
+    g_object_unref (self);
+}
+
+static void
+unlock_start (MrmDevice *self,
+              GSimpleAsyncResult *simple)
+{
+    QmiMessageDmsUimVerifyPinInput *input;
+
+    input = qmi_message_dms_uim_verify_pin_input_new ();
+    qmi_message_dms_uim_verify_pin_input_set_info (
+        input,
+        QMI_DMS_UIM_PIN_ID_PIN,
+        g_simple_async_result_get_op_res_gpointer (simple),
+        NULL);
+    qmi_client_dms_uim_verify_pin (QMI_CLIENT_DMS (self->priv->dms),
+                                   input,
+                                   5,
+                                   self->priv->cancellable,
+                                   (GAsyncReadyCallback)qmi_dms_uim_verify_pin_ready,
+                                   simple);
+    qmi_message_dms_uim_verify_pin_input_unref (input);
+}
+
+static gboolean
+unlock_in_worker (GSimpleAsyncResult *simple)
+{
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+
+    /* Gone meanwhile */
+    if (!self->priv->dms) {
+        g_simple_async_result_set_error (simple,
+                                         MRM_CORE_ERROR,
+                                         MRM_CORE_ERROR_FAILED,
+                                         "Device disconnected");
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        g_object_unref (self);
+        return G_SOURCE_REMOVE;
+    }
+
+    request_submit (self, REQUEST_PRIORITY_CONTROL, (RequestStartFunc) unlock_start, simple);
+
+    g_object_unref (self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_unlock (MrmDevice *self,
+                   const gchar *pin,
+                   GAsyncReadyCallback callback,
+                   gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    simple = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        mrm_device_unlock);
+
+
+    if (self->priv->status != MRM_DEVICE_STATUS_SIM_PIN_LOCKED) {
+        g_simple_async_result_set_error (simple,
+                                         MRM_CORE_ERROR,
+                                         MRM_CORE_ERROR_FAILED,
+                                         "Wrong state: PIN unlocking not required");
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        return;
+    }
+
+    /* Keep the PIN around until the worker picks up the request */
+    g_simple_async_result_set_op_res_gpointer (simple, g_strdup (pin), g_free);
+    worker_invoke (self, (GSourceFunc) unlock_in_worker, simple);
+}
+
+/*****************************************************************************/
+/* Stop NAS service monitoring */
+
+gboolean
+mrm_device_stop_nas_finish (MrmDevice *self,
+                            GAsyncResult *res,
+                            GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+qmi_device_release_client_nas_ready (QmiDevice *device,
                                      GAsyncResult *res,
                                      GSimpleAsyncResult *simple)
 {
-    QmiDmsUimPinStatus current_status;
-    guint8 pin1_status_verify_retries_left;
-    QmiMessageDmsUimGetPinStatusOutput *output;
     GError *error = NULL;
     MrmDevice *self;
 
     self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
-    output = qmi_client_dms_uim_get_pin_status_finish (dms, res, &error);
-    if (!output) {
-        g_prefix_error (&error, "QMI operation failed: ");
+
+    g_clear_object (&self->priv->nas);
+
+    if (!qmi_device_release_client_finish (device, res, &error)) {
+        g_prefix_error (&error, "Cannot release NAS client: ");
         g_simple_async_result_take_error (simple, error);
-    } else if (!qmi_message_dms_uim_get_pin_status_output_get_result (output, &error)) {
-        /* QMI error internal when checking PIN status likely means NO SIM */
-        if (g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_INTERNAL)) {
-            self->priv->status = MRM_DEVICE_STATUS_SIM_ERROR;
+    } else {
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    }
+
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+    g_object_unref (self);
+}
+
+static gboolean
+stop_nas_in_worker (GSimpleAsyncResult *simple)
+{
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    g_object_unref (self);
+
+    /* Not to be resumed once reconnected either */
+    self->priv->resume_nas = FALSE;
+
+    /* If not started, error */
+    if (!self->priv->nas_cancellable) {
+        g_simple_async_result_set_error (simple,
+                                         MRM_CORE_ERROR,
+                                         MRM_CORE_ERROR_FAILED,
+                                         "NAS service already stopped");
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Abort whatever is in flight, including an ongoing start */
+    nas_cancellable_cancel (self);
+    self->priv->polling = FALSE;
+
+    /* Rates start over once restarted */
+    traffic_counters_reset (self);
+    if (self->priv->wds) {
+        qmi_device_release_client (self->priv->qmi_device,
+                                   self->priv->wds,
+                                   client_release_prepare (self, MRM_DEVICE_CLIENT_WDS, TRUE),
+                                   5,
+                                   NULL,
+                                   NULL,
+                                   NULL);
+        g_clear_object (&self->priv->wds);
+    }
+
+    if (self->priv->backend) {
+        poll_stop (self, POLL_GROUP_SIGNAL);
+        poll_stop (self, POLL_GROUP_POWER);
+        poll_stop (self, POLL_GROUP_NEIGHBORS);
+        poll_stop (self, POLL_GROUP_TRAFFIC);
+        poll_stop (self, POLL_GROUP_CARRIERS);
+        mrm_device_backend_stop (self->priv->backend);
+    }
+
+    if (!self->priv->nas) {
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        return G_SOURCE_REMOVE;
+    }
+
+    poll_stop (self, POLL_GROUP_SIGNAL);
+    poll_stop (self, POLL_GROUP_POWER);
+    poll_stop (self, POLL_GROUP_NEIGHBORS);
+    poll_stop (self, POLL_GROUP_TRAFFIC);
+    poll_stop (self, POLL_GROUP_CARRIERS);
+
+    /* Neighbors aren't known any more */
+    neighbors_reset (self);
+
+    /* Nor is the serving cell; it gets logged again once restarted */
+    mrm_serving_cell_init (&self->priv->serving_cell, 0);
+    self->priv->lte_serving_pci = MRM_SERVING_CELL_UNKNOWN;
+
+    if (self->priv->signal_info_indication_id) {
+        g_signal_handler_disconnect (self->priv->nas, self->priv->signal_info_indication_id);
+        self->priv->signal_info_indication_id = 0;
+    }
+    if (self->priv->signal_info_indications) {
+        g_atomic_int_set (&self->priv->signal_info_indications, FALSE);
+        queue_notify (self, PROP_SIGNAL_SAMPLE_INTERVAL_MS);
+    }
+    self->priv->ca_info_unsupported = FALSE;
+    self->priv->nr5g_signal = FALSE;
+    memset (&self->priv->signal_sample, 0, sizeof (MrmSample));
+
+    if (self->priv->serving_system_indication_id) {
+        g_signal_handler_disconnect (self->priv->nas, self->priv->serving_system_indication_id);
+        self->priv->serving_system_indication_id = 0;
+    }
+    self->priv->serving_system_indications = FALSE;
+
+    qmi_device_release_client (self->priv->qmi_device,
+                               self->priv->nas,
+                               client_release_prepare (self, MRM_DEVICE_CLIENT_NAS, TRUE),
+                               5,
+                               NULL,
+                               (GAsyncReadyCallback) qmi_device_release_client_nas_ready,
+                               simple);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_stop_nas (MrmDevice *self,
+                     GAsyncReadyCallback callback,
+                     gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    simple = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        mrm_device_stop_nas);
+    worker_invoke (self, (GSourceFunc) stop_nas_in_worker, simple);
+}
+
+/*****************************************************************************/
+/* Network scan
+ *
+ * A scan keeps the modem busy for several seconds, up to minutes, so it is
+ * sent as a background request: it only starts between sampling cycles, and
+ * the sampling cycles issued while it's in progress aren't held back by it.
+ * Scans are run on demand, and periodically if an interval is set, while the
+ * NAS service is started. Requests for a scan while one is in progress wait
+ * for its result. */
+
+/* Seconds; scans of all access technologies take long in some modems */
+#define NETWORK_SCAN_TIMEOUT 300
+
+typedef struct {
+    MrmDevice *self;
+    GCancellable *cancellable;
+    gint64 started;
+} NetworkScanContext;
+
+gboolean
+mrm_device_scan_networks_finish (MrmDevice *self,
+                                 GAsyncResult *res,
+                                 GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+/* Runs in the worker */
+static void
+network_scan_complete (NetworkScanContext *ctx,
+                       MrmNetworkScan *scan,
+                       GError *error)
+{
+    MrmDevice *self = ctx->self;
+    GList *waiters;
+    GList *l;
+
+    if (scan) {
+        g_debug ("Network scan at '%s' found %u networks in %" G_GINT64_FORMAT " ms",
+                 self->priv->name, scan->n_networks, scan->duration / 1000);
+        queue_network_scan (self, scan);
+    } else
+        g_debug ("Network scan at '%s' failed: %s", self->priv->name, error->message);
+
+    g_atomic_int_set (&self->priv->network_scanning, FALSE);
+    queue_notify (self, PROP_NETWORK_SCANNING);
+
+    waiters = self->priv->network_scan_waiters;
+    self->priv->network_scan_waiters = NULL;
+    for (l = waiters; l; l = g_list_next (l)) {
+        GSimpleAsyncResult *simple = l->data;
+
+        if (error)
+            g_simple_async_result_set_from_error (simple, error);
+        else
             g_simple_async_result_set_op_res_gboolean (simple, TRUE);
-            g_error_free (error);
-        } else if (g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_INCORRECT_PIN)) {
-            /* Stupid modem... retry until we get a proper result */
-            qmi_client_dms_uim_get_pin_status (
-                QMI_CLIENT_DMS (dms),
-                NULL,
-                5,
-                NULL,
-                (GAsyncReadyCallback) qmi_client_dms_get_pin_status_ready,
-                simple);
-            qmi_message_dms_uim_get_pin_status_output_unref (output);
-            g_object_unref (self);
-            g_error_free (error);
-            return;
-        } else {
-            g_prefix_error (&error, "couldn't get PIN status: ");
-            g_simple_async_result_take_error (simple, error);
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+    }
+    g_list_free (waiters);
+
+    if (error)
+        g_error_free (error);
+    g_object_unref (ctx->cancellable);
+    g_object_unref (ctx->self);
+    g_slice_free (NetworkScanContext, ctx);
+}
+
+static void
+network_add (GArray *networks,
+             guint16 mcc,
+             guint16 mnc,
+             QmiNasNetworkStatus network_status,
+             const gchar *description,
+             QmiNasRadioInterface radio_interface)
+{
+    MrmNetwork network;
+
+    memset (&network, 0, sizeof (network));
+    network.mcc = mcc;
+    network.mnc = mnc;
+    network.act = act_from_radio_interface (radio_interface);
+    network.level = MRM_NETWORK_LEVEL_UNKNOWN;
+    if (network_status & QMI_NAS_NETWORK_STATUS_CURRENT_SERVING)
+        network.status |= MRM_NETWORK_STATUS_CURRENT;
+    if (network_status & QMI_NAS_NETWORK_STATUS_AVAILABLE)
+        network.status |= MRM_NETWORK_STATUS_AVAILABLE;
+    if (network_status & QMI_NAS_NETWORK_STATUS_HOME)
+        network.status |= MRM_NETWORK_STATUS_HOME;
+    if (network_status & QMI_NAS_NETWORK_STATUS_ROAMING)
+        network.status |= MRM_NETWORK_STATUS_ROAMING;
+    if (network_status & QMI_NAS_NETWORK_STATUS_FORBIDDEN)
+        network.status |= MRM_NETWORK_STATUS_FORBIDDEN;
+    if (network_status & QMI_NAS_NETWORK_STATUS_PREFERRED)
+        network.status |= MRM_NETWORK_STATUS_PREFERRED;
+    mrm_network_set_description (&network, description);
+    g_array_append_val (networks, network);
+}
+
+static MrmNetworkScan *
+network_scan_build (QmiMessageNasNetworkScanOutput *output,
+                    gint64 started)
+{
+    GArray *info = NULL;
+    GArray *rats = NULL;
+    GArray *pcs_digits = NULL;
+    GArray *networks;
+    MrmNetworkScan *scan;
+    guint i;
+    guint j;
+
+    networks = g_array_new (FALSE, FALSE, sizeof (MrmNetwork));
+
+    qmi_message_nas_network_scan_output_get_network_information (output, &info, NULL);
+    qmi_message_nas_network_scan_output_get_radio_access_technology (output, &rats, NULL);
+    qmi_message_nas_network_scan_output_get_mnc_pcs_digit_include_status (output, &pcs_digits, NULL);
+
+    /* One network per PLMN and access technology; a PLMN found in several of
+     * them is reported once in the network info, along with its status */
+    for (i = 0; rats && i < rats->len; i++) {
+        QmiMessageNasNetworkScanOutputRadioAccessTechnologyElement *rat;
+        QmiMessageNasNetworkScanOutputNetworkInformationElement *element = NULL;
+
+        rat = &g_array_index (rats, QmiMessageNasNetworkScanOutputRadioAccessTechnologyElement, i);
+        for (j = 0; info && j < info->len; j++) {
+            element = &g_array_index (info, QmiMessageNasNetworkScanOutputNetworkInformationElement, j);
+            if (element->mcc == rat->mcc && element->mnc == rat->mnc)
+                break;
+            element = NULL;
         }
-    } else if (!qmi_message_dms_uim_get_pin_status_output_get_pin1_status (
-                   output,
-                   &current_status,
-                   &pin1_status_verify_retries_left, /* verify_retries_left */
-                   NULL, /* unblock_retries_left */
-                   &error)) {
-        g_prefix_error (&error, "couldn't get PIN1 status: ");
-        g_simple_async_result_take_error (simple, error);
-    } else {
-        switch (current_status) {
-        case QMI_DMS_UIM_PIN_STATUS_CHANGED:
-        case QMI_DMS_UIM_PIN_STATUS_UNBLOCKED:
-        case QMI_DMS_UIM_PIN_STATUS_DISABLED:
-        case QMI_DMS_UIM_PIN_STATUS_ENABLED_VERIFIED:
-            self->priv->pin_attempts_left = -1;
-            self->priv->status = MRM_DEVICE_STATUS_READY;
-            break;
 
-        case QMI_DMS_UIM_PIN_STATUS_BLOCKED:
-            self->priv->pin_attempts_left = 0;
-            self->priv->status = MRM_DEVICE_STATUS_SIM_PUK_LOCKED;
-            break;
+        network_add (networks,
+                     rat->mcc,
+                     rat->mnc,
+                     element ? element->network_status : 0,
+                     element ? element->description : NULL,
+                     rat->radio_interface);
+    }
 
-        case QMI_DMS_UIM_PIN_STATUS_PERMANENTLY_BLOCKED:
-            self->priv->pin_attempts_left = -1;
-            self->priv->status = MRM_DEVICE_STATUS_SIM_ERROR;
-            break;
+    /* Without access technologies, one network per PLMN */
+    if (!rats) {
+        for (i = 0; info && i < info->len; i++) {
+            QmiMessageNasNetworkScanOutputNetworkInformationElement *element;
+
+            element = &g_array_index (info, QmiMessageNasNetworkScanOutputNetworkInformationElement, i);
+            network_add (networks,
+                         element->mcc,
+                         element->mnc,
+                         element->network_status,
+                         element->description,
+                         QMI_NAS_RADIO_INTERFACE_UNKNOWN);
+        }
+    }
 
-        case QMI_DMS_UIM_PIN_STATUS_NOT_INITIALIZED:
-        case QMI_DMS_UIM_PIN_STATUS_ENABLED_NOT_VERIFIED:
-            self->priv->pin_attempts_left = (gint)pin1_status_verify_retries_left;
-            self->priv->status = MRM_DEVICE_STATUS_SIM_PIN_LOCKED;
-            break;
+    for (i = 0; pcs_digits && i < pcs_digits->len; i++) {
+        QmiMessageNasNetworkScanOutputMncPcsDigitIncludeStatusElement *element;
 
-        default:
-            /* Unknown SIM error */
-            self->priv->pin_attempts_left = -1;
-            self->priv->status = MRM_DEVICE_STATUS_SIM_ERROR;
-            break;
+        element = &g_array_index (pcs_digits, QmiMessageNasNetworkScanOutputMncPcsDigitIncludeStatusElement, i);
+        for (j = 0; j < networks->len; j++) {
+            MrmNetwork *network = &g_array_index (networks, MrmNetwork, j);
+
+            if (network->mcc == element->mcc && network->mnc == element->mnc)
+                network->mnc_3_digits = element->includes_pcs_digit;
         }
+    }
 
-        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    scan = mrm_network_scan_new (started,
+                                 g_get_monotonic_time () - started,
+                                 (const MrmNetwork *) networks->data,
+                                 networks->len);
+    g_array_unref (networks);
+    return scan;
+}
+
+static void
+qmi_client_nas_network_scan_ready (QmiClientNas *client,
+                                   GAsyncResult *res,
+                                   NetworkScanContext *ctx)
+{
+    QmiMessageNasNetworkScanOutput *output;
+    MrmNetworkScan *scan = NULL;
+    GError *error = NULL;
+
+    request_done (ctx->self, REQUEST_PRIORITY_BACKGROUND);
+
+    output = qmi_client_nas_network_scan_finish (client, res, &error);
+    if (!output)
+        g_prefix_error (&error, "QMI operation failed: ");
+    else if (!qmi_message_nas_network_scan_output_get_result (output, &error))
+        g_prefix_error (&error, "couldn't scan networks: ");
+    else
+        scan = network_scan_build (output, ctx->started);
+
+    if (output)
+        qmi_message_nas_network_scan_output_unref (output);
+
+    network_scan_complete (ctx, scan, error);
+}
+
+static void
+network_scan_start (MrmDevice *self,
+                    NetworkScanContext *ctx)
+{
+    QmiMessageNasNetworkScanInput *input;
+
+    /* NAS service stopped while waiting for its turn */
+    if (g_cancellable_is_cancelled (ctx->cancellable) || !self->priv->nas) {
+        request_done (self, REQUEST_PRIORITY_BACKGROUND);
+        network_scan_complete (ctx, NULL, g_error_new (MRM_CORE_ERROR,
+                                                       MRM_CORE_ERROR_FAILED,
+                                                       "NAS service stopped"));
+        return;
+    }
+
+    /* The time waiting for a turn is part of the duration */
+    input = qmi_message_nas_network_scan_input_new ();
+    qmi_message_nas_network_scan_input_set_network_type (
+        input,
+        (QMI_NAS_NETWORK_SCAN_TYPE_GSM |
+         QMI_NAS_NETWORK_SCAN_TYPE_UMTS |
+         QMI_NAS_NETWORK_SCAN_TYPE_LTE),
+        NULL);
+    qmi_client_nas_network_scan (QMI_CLIENT_NAS (self->priv->nas),
+                                 input,
+                                 NETWORK_SCAN_TIMEOUT,
+                                 ctx->cancellable,
+                                 (GAsyncReadyCallback) qmi_client_nas_network_scan_ready,
+                                 ctx);
+    qmi_message_nas_network_scan_input_unref (input);
+}
+
+/* Runs in the worker */
+static void
+network_scan_run (MrmDevice *self)
+{
+    NetworkScanContext *ctx;
+
+    g_assert (!g_atomic_int_get (&self->priv->network_scanning));
+    g_atomic_int_set (&self->priv->network_scanning, TRUE);
+    queue_notify (self, PROP_NETWORK_SCANNING);
+
+    ctx = g_slice_new0 (NetworkScanContext);
+    ctx->self = g_object_ref (self);
+    ctx->cancellable = g_object_ref (self->priv->nas_cancellable);
+    ctx->started = g_get_monotonic_time ();
+    request_submit (self, REQUEST_PRIORITY_BACKGROUND, (RequestStartFunc) network_scan_start, ctx);
+}
+
+/* Runs in the worker. Only while monitoring. */
+static gboolean
+network_scan_tick_cb (MrmDevice *self)
+{
+    if (self->priv->polling &&
+        self->priv->nas &&
+        !g_atomic_int_get (&self->priv->network_scanning))
+        network_scan_run (self);
+    return G_SOURCE_CONTINUE;
+}
+
+/* Runs in the worker */
+static void
+network_scan_stop (MrmDevice *self)
+{
+    if (!self->priv->network_scan_source)
+        return;
+
+    g_source_destroy (self->priv->network_scan_source);
+    g_source_unref (self->priv->network_scan_source);
+    self->priv->network_scan_source = NULL;
+}
+
+/* Runs in the worker */
+static gboolean
+network_scan_reschedule_cb (MrmDevice *self)
+{
+    guint interval;
+
+    network_scan_stop (self);
+
+    interval = g_atomic_int_get (&self->priv->network_scan_interval);
+    if (interval) {
+        self->priv->network_scan_source = g_timeout_source_new_seconds (interval);
+        g_source_set_callback (self->priv->network_scan_source,
+                               (GSourceFunc) network_scan_tick_cb,
+                               self,
+                               NULL);
+        g_source_attach (self->priv->network_scan_source, self->priv->worker_context);
+    }
+
+    g_object_unref (self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+network_scan_set_interval (MrmDevice *self,
+                           guint interval)
+{
+    if (interval > 0)
+        interval = CLAMP (interval, MRM_DEVICE_NETWORK_SCAN_INTERVAL_MIN, MRM_DEVICE_NETWORK_SCAN_INTERVAL_MAX);
+    g_atomic_int_set (&self->priv->network_scan_interval, interval);
+    worker_invoke (self, (GSourceFunc) network_scan_reschedule_cb, g_object_ref (self));
+}
+
+static gboolean
+scan_networks_in_worker (GSimpleAsyncResult *simple)
+{
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    g_object_unref (self);
+
+    /* Backends only report samples */
+    if (!self->priv->polling || !self->priv->nas) {
+        g_simple_async_result_set_error (simple,
+                                         MRM_CORE_ERROR,
+                                         MRM_CORE_ERROR_FAILED,
+                                         "Cannot scan networks: NAS service not started");
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        return G_SOURCE_REMOVE;
     }
 
-    if (output)
-        qmi_message_dms_uim_get_pin_status_output_unref (output);
-    g_object_unref (self);
+    self->priv->network_scan_waiters = g_list_append (self->priv->network_scan_waiters, simple);
+    if (!g_atomic_int_get (&self->priv->network_scanning))
+        network_scan_run (self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_scan_networks (MrmDevice *self,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    g_return_if_fail (MRM_IS_DEVICE (self));
 
-    /* Notify about the internal property change */
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_STATUS]);
+    simple = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        mrm_device_scan_networks);
+    worker_invoke (self, (GSourceFunc) scan_networks_in_worker, simple);
+}
 
-    g_simple_async_result_complete (simple);
-    g_object_unref (simple);
+gboolean
+mrm_device_get_network_scanning (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), FALSE);
+
+    return g_atomic_int_get (&self->priv->network_scanning);
 }
 
-static void
-reload_status (MrmDevice *self,
-               GCancellable *cancellable,
-               GAsyncReadyCallback callback,
-               gpointer user_data)
+MrmNetworkScan *
+mrm_device_dup_network_scan (MrmDevice *self)
 {
-    g_return_if_fail (QMI_IS_CLIENT_DMS (self->priv->dms));
+    g_return_val_if_fail (MRM_IS_DEVICE (self), NULL);
 
-    qmi_client_dms_uim_get_pin_status (
-        QMI_CLIENT_DMS (self->priv->dms),
-        NULL,
-        5,
-        cancellable,
-        (GAsyncReadyCallback) qmi_client_dms_get_pin_status_ready,
-        g_simple_async_result_new (
-            G_OBJECT (self),
-            callback,
-            user_data,
-            reload_status));
+    return self->priv->network_scan ? mrm_network_scan_copy (self->priv->network_scan) : NULL;
 }
 
 /*****************************************************************************/
+/* Start NAS service monitoring */
 
 gboolean
-mrm_device_unlock_finish (MrmDevice *self,
-                          GAsyncResult *res,
-                          GError **error)
+mrm_device_start_nas_finish (MrmDevice *self,
+                             GAsyncResult *res,
+                             GError **error)
 {
-    if (self->priv->status != MRM_DEVICE_STATUS_READY) {
-        g_set_error (error,
-                     MRM_CORE_ERROR,
-                     MRM_CORE_ERROR_FAILED,
-                     "SIM still locked after unlock attempt");
-        return FALSE;
-    }
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
 
-    return TRUE;
+static void
+start_info_polling (MrmDevice *self)
+{
+    g_mutex_lock (&self->priv->lock);
+    timing_stats_reset (&self->priv->rtt);
+    timing_stats_reset (&self->priv->jitter);
+    g_mutex_unlock (&self->priv->lock);
+
+    g_debug ("Signal info %s; tx/rx info polled every %" G_GINT64_FORMAT " ms",
+             self->priv->signal_info_indications ?
+             "reported via indications" :
+             "polled",
+             poll_interval (&self->priv->poll[POLL_GROUP_POWER]) / 1000);
+
+    /* Indications are only emitted on changes, so make sure we get an
+     * initial value right away */
+    if (self->priv->signal_info_indications &&
+        !self->priv->poll[POLL_GROUP_SIGNAL].in_flight)
+        reload_info (self, MRM_SAMPLE_GROUP_SIGNAL);
+
+    /* Tx/rx power info isn't reported via indications, so it is polled
+     * whenever subscribed; signal info only when the modem doesn't report it
+     * by itself */
+    self->priv->polling = TRUE;
+    poll_update (self);
 }
 
 static void
-after_pin_reload_status_ready (MrmDevice *self,
-                               GAsyncResult *res,
-                               GSimpleAsyncResult *simple)
+start_nas_complete (GSimpleAsyncResult *simple,
+                    GCancellable *cancellable)
 {
-    reload_status_finish (self, res, NULL);
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+
+    /* Stopped while starting up */
+    if (g_cancellable_is_cancelled (cancellable)) {
+        g_simple_async_result_set_error (simple,
+                                         G_IO_ERROR,
+                                         G_IO_ERROR_CANCELLED,
+                                         "NAS service stopped while starting");
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        g_object_unref (self);
+        return;
+    }
 
+    start_info_polling (self);
     g_simple_async_result_set_op_res_gboolean (simple, TRUE);
-    g_simple_async_result_complete (simple);
+    g_simple_async_result_complete_in_idle (simple);
     g_object_unref (simple);
+    g_object_unref (self);
 }
 
 static void
-qmi_dms_uim_verify_pin_ready (QmiClientDms *client,
-                              GAsyncResult *res,
-                              GSimpleAsyncResult *simple)
+start_nas_signal_info (MrmDevice *self,
+                       GSimpleAsyncResult *simple);
+static void
+qmi_device_allocate_client_nas_ready (QmiDevice *device,
+                                      GAsyncResult *res,
+                                      GSimpleAsyncResult *simple);
+
+static void
+qmi_client_nas_get_serving_system_ready (QmiClientNas *client,
+                                         GAsyncResult *res,
+                                         GSimpleAsyncResult *simple)
 {
-    QmiMessageDmsUimVerifyPinOutput *output = NULL;
+    QmiMessageNasGetServingSystemOutput *output;
+    QmiNasRegistrationState registration_state;
+    GArray *radio_interfaces = NULL;
     GError *error = NULL;
     MrmDevice *self;
 
     self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
 
-    output = qmi_client_dms_uim_verify_pin_finish (client, res, NULL);
-    if (output)
-        qmi_message_dms_uim_verify_pin_output_unref (output);
-
-    /* Ignore errors here; just reload status */
+    output = qmi_client_nas_get_serving_system_finish (client, res, &error);
+    if (!output ||
+        !qmi_message_nas_get_serving_system_output_get_result (output, &error) ||
+        !qmi_message_nas_get_serving_system_output_get_serving_system (output,
+                                                                       &registration_state,
+                                                                       NULL,
+                                                                       NULL,
+                                                                       NULL,
+                                                                       &radio_interfaces,
+                                                                       &error)) {
+        g_debug ("Cannot load initial serving system: %s", error->message);
+        g_error_free (error);
+    } else if (self->priv->serving_system_indications)
+        serving_system_update (self, registration_state, radio_interfaces);
 
-    reload_status (self,
-                   NULL,
-                   (GAsyncReadyCallback)after_pin_reload_status_ready,
-                   simple);
+    if (output)
+        qmi_message_nas_get_serving_system_output_unref (output);
 
+    start_nas_signal_info (self, simple);
     g_object_unref (self);
 }
 
-void
-mrm_device_unlock (MrmDevice *self,
-                   const gchar *pin,
-                   GAsyncReadyCallback callback,
-                   gpointer user_data)
+static void
+qmi_client_nas_register_serving_system_ready (QmiClientNas *client,
+                                              GAsyncResult *res,
+                                              GSimpleAsyncResult *simple)
 {
-    GSimpleAsyncResult *simple;
-    QmiMessageDmsUimVerifyPinInput *input;
+    QmiMessageNasRegisterIndicationsOutput *output;
+    GError *error = NULL;
+    MrmDevice *self;
 
-    simple = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        mrm_device_unlock);
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
 
+    output = qmi_client_nas_register_indications_finish (client, res, &error);
+    if ((!output || !qmi_message_nas_register_indications_output_get_result (output, &error)) &&
+        client_is_stale (self, MRM_DEVICE_CLIENT_NAS, error) &&
+        !g_cancellable_is_cancelled (g_simple_async_result_get_op_res_gpointer (simple))) {
+        /* This is the first NAS request, so start over with a new client */
+        g_error_free (error);
+        if (output)
+            qmi_message_nas_register_indications_output_unref (output);
+        client_drop_stale (self, MRM_DEVICE_CLIENT_NAS, &self->priv->nas);
+        qmi_device_allocate_client (self->priv->qmi_device,
+                                    QMI_SERVICE_NAS,
+                                    QMI_CID_NONE,
+                                    5,
+                                    g_simple_async_result_get_op_res_gpointer (simple),
+                                    (GAsyncReadyCallback) qmi_device_allocate_client_nas_ready,
+                                    simple);
+        g_object_unref (self);
+        return;
+    }
 
-    if (self->priv->status != MRM_DEVICE_STATUS_SIM_PIN_LOCKED) {
-        g_simple_async_result_set_error (simple,
-                                         MRM_CORE_ERROR,
-                                         MRM_CORE_ERROR_FAILED,
-                                         "Wrong state: PIN unlocking not required");
-        g_simple_async_result_complete_in_idle (simple);
-        g_object_unref (simple);
+    if (error) {
+        g_debug ("Cannot register serving system indications, inferring access technology from signal info: %s",
+                 error->message);
+        g_error_free (error);
+        if (output)
+            qmi_message_nas_register_indications_output_unref (output);
+        start_nas_signal_info (self, simple);
+        g_object_unref (self);
         return;
     }
 
-    input = qmi_message_dms_uim_verify_pin_input_new ();
-    qmi_message_dms_uim_verify_pin_input_set_info (
-        input,
-        QMI_DMS_UIM_PIN_ID_PIN,
-        pin,
-        NULL);
-    qmi_client_dms_uim_verify_pin (QMI_CLIENT_DMS (self->priv->dms),
-                                   input,
-                                   5,
-                                   NULL,
-                                   (GAsyncReadyCallback)qmi_dms_uim_verify_pin_ready,
-                                   simple);
-    qmi_message_dms_uim_verify_pin_input_unref (input);
-}
+    qmi_message_nas_register_indications_output_unref (output);
 
-/*****************************************************************************/
-/* Stop NAS service monitoring */
+    if (!g_cancellable_is_cancelled (g_simple_async_result_get_op_res_gpointer (simple))) {
+        self->priv->serving_system_indication_id =
+            g_signal_connect (client,
+                              "serving-system",
+                              G_CALLBACK (serving_system_indication_cb),
+                              self);
+        self->priv->serving_system_indications = TRUE;
+    }
 
-gboolean
-mrm_device_stop_nas_finish (MrmDevice *self,
-                            GAsyncResult *res,
-                            GError **error)
+    /* Indications only come on changes, load the current state */
+    qmi_client_nas_get_serving_system (client,
+                                       NULL,
+                                       5,
+                                       g_simple_async_result_get_op_res_gpointer (simple),
+                                       (GAsyncReadyCallback) qmi_client_nas_get_serving_system_ready,
+                                       simple);
+    g_object_unref (self);
+}
+
+static void
+start_nas_serving_system (MrmDevice *self,
+                          GSimpleAsyncResult *simple)
 {
-    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+    QmiMessageNasRegisterIndicationsInput *input;
+
+    input = qmi_message_nas_register_indications_input_new ();
+    qmi_message_nas_register_indications_input_set_serving_system_events (input, TRUE, NULL);
+    qmi_client_nas_register_indications (QMI_CLIENT_NAS (self->priv->nas),
+                                         input,
+                                         5,
+                                         g_simple_async_result_get_op_res_gpointer (simple),
+                                         (GAsyncReadyCallback) qmi_client_nas_register_serving_system_ready,
+                                         simple);
+    qmi_message_nas_register_indications_input_unref (input);
 }
 
 static void
-qmi_device_release_client_nas_ready (QmiDevice *device,
-                                     GAsyncResult *res,
-                                     GSimpleAsyncResult *simple)
+qmi_client_nas_register_indications_ready (QmiClientNas *client,
+                                           GAsyncResult *res,
+                                           GSimpleAsyncResult *simple)
 {
+    QmiMessageNasRegisterIndicationsOutput *output;
     GError *error = NULL;
     MrmDevice *self;
 
     self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
 
-    g_clear_object (&self->priv->nas);
-
-    if (!qmi_device_release_client_finish (device, res, &error)) {
-        g_prefix_error (&error, "Cannot release NAS client: ");
-        g_simple_async_result_take_error (simple, error);
-    } else {
-        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    output = qmi_client_nas_register_indications_finish (client, res, &error);
+    if (!output || !qmi_message_nas_register_indications_output_get_result (output, &error)) {
+        g_debug ("Cannot register signal info indications, falling back to polling: %s", error->message);
+        g_error_free (error);
+    } else if (!g_cancellable_is_cancelled (g_simple_async_result_get_op_res_gpointer (simple))) {
+        self->priv->signal_info_indication_id =
+            g_signal_connect (client,
+                              "signal-info",
+                              G_CALLBACK (signal_info_indication_cb),
+                              self);
+        g_atomic_int_set (&self->priv->signal_info_indications, TRUE);
+        queue_notify (self, PROP_SIGNAL_SAMPLE_INTERVAL_MS);
     }
 
-    g_simple_async_result_complete (simple);
-    g_object_unref (simple);
+    if (output)
+        qmi_message_nas_register_indications_output_unref (output);
+
     g_object_unref (self);
+    start_nas_complete (simple, g_simple_async_result_get_op_res_gpointer (simple));
 }
 
-void
-mrm_device_stop_nas (MrmDevice *self,
-                     GAsyncReadyCallback callback,
-                     gpointer user_data)
+static void
+qmi_client_nas_config_signal_info_ready (QmiClientNas *client,
+                                         GAsyncResult *res,
+                                         GSimpleAsyncResult *simple)
 {
-    GSimpleAsyncResult *simple;
-
-    simple = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        mrm_device_stop_nas);
+    QmiMessageNasConfigSignalInfoOutput *output;
+    QmiMessageNasRegisterIndicationsInput *input;
+    GError *error = NULL;
 
-    /* If not started, error */
-    if (!self->priv->nas) {
-        g_simple_async_result_set_error (simple,
-                                         MRM_CORE_ERROR,
-                                         MRM_CORE_ERROR_FAILED,
-                                         "NAS service already stopped");
-        g_simple_async_result_complete_in_idle (simple);
-        g_object_unref (simple);
+    output = qmi_client_nas_config_signal_info_finish (client, res, &error);
+    if (!output || !qmi_message_nas_config_signal_info_output_get_result (output, &error)) {
+        g_debug ("Cannot configure signal info thresholds, falling back to polling: %s", error->message);
+        g_error_free (error);
+        if (output)
+            qmi_message_nas_config_signal_info_output_unref (output);
+        start_nas_complete (simple, g_simple_async_result_get_op_res_gpointer (simple));
         return;
     }
 
-    g_source_remove (self->priv->info_updated_id);
-    self->priv->info_updated_id = 0;
+    qmi_message_nas_config_signal_info_output_unref (output);
+
+    input = qmi_message_nas_register_indications_input_new ();
+    qmi_message_nas_register_indications_input_set_signal_info (input, TRUE, NULL);
+    qmi_client_nas_register_indications (client,
+                                         input,
+                                         5,
+                                         g_simple_async_result_get_op_res_gpointer (simple),
+                                         (GAsyncReadyCallback) qmi_client_nas_register_indications_ready,
+                                         simple);
+    qmi_message_nas_register_indications_input_unref (input);
+}
 
-    qmi_device_release_client (self->priv->qmi_device,
-                               self->priv->nas,
-                               QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
-                               5,
-                               NULL,
-                               (GAsyncReadyCallback) qmi_device_release_client_nas_ready,
-                               simple);
+static void
+start_nas_signal_info (MrmDevice *self,
+                       GSimpleAsyncResult *simple)
+{
+    QmiMessageNasConfigSignalInfoInput *input;
+
+    /* Setup thresholds so that the modem reports signal info changes */
+    input = signal_info_config_input_new ();
+    qmi_client_nas_config_signal_info (QMI_CLIENT_NAS (self->priv->nas),
+                                       input,
+                                       5,
+                                       g_simple_async_result_get_op_res_gpointer (simple),
+                                       (GAsyncReadyCallback) qmi_client_nas_config_signal_info_ready,
+                                       simple);
+    qmi_message_nas_config_signal_info_input_unref (input);
 }
 
-/*****************************************************************************/
-/* Start NAS service monitoring */
+static void
+qmi_device_allocate_client_wds_ready (QmiDevice *device,
+                                      GAsyncResult *res,
+                                      GSimpleAsyncResult *simple)
+{
+    GCancellable *cancellable;
+    GError *error = NULL;
+    QmiClient *wds;
+    MrmDevice *self;
 
-gboolean
-mrm_device_start_nas_finish (MrmDevice *self,
-                             GAsyncResult *res,
-                             GError **error)
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    cancellable = g_simple_async_result_get_op_res_gpointer (simple);
+
+    wds = qmi_device_allocate_client_finish (device, res, &error);
+    if (g_cancellable_is_cancelled (cancellable)) {
+        /* Stopped while the client was being allocated */
+        if (wds) {
+            client_info_update (self, MRM_DEVICE_CLIENT_WDS, wds);
+            qmi_device_release_client (device,
+                                       wds,
+                                       client_release_prepare (self, MRM_DEVICE_CLIENT_WDS, TRUE),
+                                       5,
+                                       NULL,
+                                       NULL,
+                                       NULL);
+        }
+        g_clear_object (&wds);
+        g_clear_error (&error);
+        start_nas_complete (simple, cancellable);
+        g_object_unref (self);
+        return;
+    }
+
+    /* Not fatal, only traffic info is lost */
+    if (!wds) {
+        g_debug ("Cannot allocate WDS client at '%s', no traffic info: %s",
+                 self->priv->name, error->message);
+        g_error_free (error);
+    }
+
+    self->priv->wds = wds;
+    if (wds)
+        client_info_update (self, MRM_DEVICE_CLIENT_WDS, wds);
+    start_nas_serving_system (self, simple);
+    g_object_unref (self);
+}
+
+static void
+start_nas_wds (MrmDevice *self,
+               GSimpleAsyncResult *simple)
 {
-    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+    /* Already there if the NAS client had to be allocated again */
+    if (self->priv->wds) {
+        start_nas_serving_system (self, simple);
+        return;
+    }
+
+    qmi_device_allocate_client (self->priv->qmi_device,
+                                QMI_SERVICE_WDS,
+                                client_cid_to_reuse (self, MRM_DEVICE_CLIENT_WDS),
+                                5,
+                                g_simple_async_result_get_op_res_gpointer (simple),
+                                (GAsyncReadyCallback) qmi_device_allocate_client_wds_ready,
+                                simple);
 }
 
 static void
@@ -726,59 +4011,113 @@ qmi_device_allocate_client_nas_ready (QmiDevice *device,
                                       GAsyncResult *res,
                                       GSimpleAsyncResult *simple)
 {
+    GCancellable *cancellable;
     GError *error = NULL;
+    QmiClient *nas;
     MrmDevice *self;
 
     self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    cancellable = g_simple_async_result_get_op_res_gpointer (simple);
+
+    nas = qmi_device_allocate_client_finish (device, res, &error);
+    if (nas && g_cancellable_is_cancelled (cancellable)) {
+        /* Stopped right when the client got allocated */
+        client_info_update (self, MRM_DEVICE_CLIENT_NAS, nas);
+        qmi_device_release_client (device,
+                                   nas,
+                                   client_release_prepare (self, MRM_DEVICE_CLIENT_NAS, TRUE),
+                                   5,
+                                   NULL,
+                                   NULL,
+                                   NULL);
+        g_clear_object (&nas);
+        g_set_error (&error, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Operation was cancelled");
+    }
 
-    self->priv->nas = qmi_device_allocate_client_finish (device, res, &error);
-    if (!self->priv->nas) {
+    if (!nas) {
         g_prefix_error (&error, "Cannot allocate NAS client: ");
+        if (self->priv->nas_cancellable == cancellable)
+            nas_cancellable_cancel (self);
         g_simple_async_result_take_error (simple, error);
-    } else {
-        /* Start info polling */
-        self->priv->info_updated_id = g_timeout_add_seconds (1,
-                                                             (GSourceFunc) info_reload_cb,
-                                                             self);
-        info_reload_cb (self);
-        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        g_object_unref (self);
+        return;
     }
 
-    g_simple_async_result_complete (simple);
-    g_object_unref (simple);
+    self->priv->nas = nas;
+    client_info_update (self, MRM_DEVICE_CLIENT_NAS, nas);
+    start_nas_wds (self, simple);
     g_object_unref (self);
 }
 
-void
-mrm_device_start_nas (MrmDevice *self,
-                      GAsyncReadyCallback callback,
-                      gpointer user_data)
+static gboolean
+start_nas_in_worker (GSimpleAsyncResult *simple)
 {
-    GSimpleAsyncResult *simple;
+    MrmDevice *self;
 
-    simple = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        mrm_device_start_nas);
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+    g_object_unref (self);
 
-    /* If already started, error */
-    if (self->priv->nas) {
+    /* Started as soon as the device is back */
+    if (g_atomic_int_get (&self->priv->connection) != MRM_DEVICE_CONNECTION_CONNECTED) {
+        self->priv->resume_nas = TRUE;
+        g_simple_async_result_set_error (simple,
+                                         MRM_CORE_ERROR,
+                                         MRM_CORE_ERROR_FAILED,
+                                         "Device disconnected: NAS service started once reconnected");
+        g_simple_async_result_complete_in_idle (simple);
+        g_object_unref (simple);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* If already started or starting, error */
+    if (self->priv->nas_cancellable) {
         g_simple_async_result_set_error (simple,
                                          MRM_CORE_ERROR,
                                          MRM_CORE_ERROR_FAILED,
                                          "NAS service already started");
         g_simple_async_result_complete_in_idle (simple);
         g_object_unref (simple);
-        return;
+        return G_SOURCE_REMOVE;
+    }
+
+    /* The start sequence keeps its own reference to the cancellable, so that
+     * it notices being stopped even if restarted meanwhile */
+    nas_cancellable_setup (self);
+    g_simple_async_result_set_op_res_gpointer (simple,
+                                               g_object_ref (self->priv->nas_cancellable),
+                                               g_object_unref);
+
+    /* Nothing to set up beyond the backend session */
+    if (self->priv->backend) {
+        mrm_device_backend_start (self->priv->backend);
+        start_nas_complete (simple, self->priv->nas_cancellable);
+        return G_SOURCE_REMOVE;
     }
 
     qmi_device_allocate_client (self->priv->qmi_device,
                                 QMI_SERVICE_NAS,
-                                QMI_CID_NONE,
+                                client_cid_to_reuse (self, MRM_DEVICE_CLIENT_NAS),
                                 5,
-                                NULL,
+                                self->priv->nas_cancellable,
                                 (GAsyncReadyCallback) qmi_device_allocate_client_nas_ready,
                                 simple);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_start_nas (MrmDevice *self,
+                      GAsyncReadyCallback callback,
+                      gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    simple = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        mrm_device_start_nas);
+    worker_invoke (self, (GSourceFunc) start_nas_in_worker, simple);
 }
 
 /*****************************************************************************/
@@ -793,6 +4132,8 @@ mrm_device_close_finish (MrmDevice *self,
 
 static void device_close_step (MrmDevice *self,
                                GSimpleAsyncResult *simple);
+static void reconnect_stop    (MrmDevice *self);
+
 static void
 close_release_dms (QmiDevice *device,
                    GAsyncResult *res,
@@ -811,6 +4152,23 @@ close_release_dms (QmiDevice *device,
     g_object_unref (self);
 }
 
+static void
+close_backend_ready (MrmDeviceBackend *backend,
+                     GAsyncResult *res,
+                     GSimpleAsyncResult *simple)
+{
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+
+    /* ignore errors */
+    mrm_device_backend_close_finish (backend, res, NULL);
+
+    device_close_step (self, simple);
+
+    g_object_unref (self);
+}
+
 static void
 close_stop_nas (MrmDevice *self,
                 GAsyncResult *res,
@@ -819,6 +4177,7 @@ close_stop_nas (MrmDevice *self,
     /* ignore errors */
     mrm_device_stop_nas_finish (self, res, NULL);
     g_assert (self->priv->nas == NULL);
+    g_assert (self->priv->nas_cancellable == NULL);
 
     device_close_step (self, simple);
 }
@@ -828,18 +4187,28 @@ device_close_step (MrmDevice *self,
                    GSimpleAsyncResult *simple)
 {
     /* Stop NAS and release client */
-    if (self->priv->nas) {
+    if (self->priv->nas_cancellable || self->priv->nas) {
         mrm_device_stop_nas (self,
                              (GAsyncReadyCallback) close_stop_nas,
                              simple);
         return;
     }
 
+    /* Close backend */
+    if (self->priv->backend_open) {
+        self->priv->backend_open = FALSE;
+        mrm_device_backend_close (self->priv->backend,
+                                  NULL,
+                                  (GAsyncReadyCallback) close_backend_ready,
+                                  simple);
+        return;
+    }
+
     /* Release DMS client */
     if (self->priv->dms) {
         qmi_device_release_client (self->priv->qmi_device,
                                    self->priv->dms,
-                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   client_release_prepare (self, MRM_DEVICE_CLIENT_DMS, TRUE),
                                    5,
                                    NULL,
                                    (GAsyncReadyCallback) close_release_dms,
@@ -852,6 +4221,23 @@ device_close_step (MrmDevice *self,
     g_object_unref (simple);
 }
 
+static gboolean
+close_in_worker (GSimpleAsyncResult *simple)
+{
+    MrmDevice *self;
+
+    self = MRM_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+
+    /* Abort all ongoing operations right away, the modem may not be
+     * responding at all; and don't try to reconnect any more */
+    g_cancellable_cancel (self->priv->cancellable);
+    reconnect_stop (self);
+
+    device_close_step (self, simple);
+    g_object_unref (self);
+    return G_SOURCE_REMOVE;
+}
+
 void
 mrm_device_close (MrmDevice *self,
                   GCancellable *cancellable,
@@ -864,8 +4250,7 @@ mrm_device_close (MrmDevice *self,
                                         callback,
                                         user_data,
                                         mrm_device_close);
-
-    device_close_step (self, simple);
+    worker_invoke (self, (GSourceFunc) close_in_worker, simple);
 }
 
 /*****************************************************************************/
@@ -878,6 +4263,14 @@ mrm_device_peek_qmi_device (MrmDevice *self)
     return self->priv->qmi_device;
 }
 
+MrmDeviceBackend *
+mrm_device_peek_backend (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), NULL);
+
+    return self->priv->backend;
+}
+
 const gchar *
 mrm_device_get_manufacturer (MrmDevice *self)
 {
@@ -918,6 +4311,151 @@ mrm_device_get_status (MrmDevice *self)
     return self->priv->status;
 }
 
+MrmDeviceConnection
+mrm_device_get_connection (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), MRM_DEVICE_CONNECTION_DISCONNECTED);
+
+    return (MrmDeviceConnection) g_atomic_int_get (&self->priv->connection);
+}
+
+MrmDeviceAct
+mrm_device_get_act (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), 0);
+
+    return (MrmDeviceAct) g_atomic_int_get (&self->priv->act);
+}
+
+MrmDeviceRegistrationState
+mrm_device_get_registration_state (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), MRM_DEVICE_REGISTRATION_STATE_UNKNOWN);
+
+    return (MrmDeviceRegistrationState) g_atomic_int_get (&self->priv->registration_state);
+}
+
+GArray *
+mrm_device_dup_history (MrmDevice *self)
+{
+    GArray *history;
+    guint i;
+
+    g_return_val_if_fail (MRM_IS_DEVICE (self), NULL);
+
+    history = g_array_sized_new (FALSE, FALSE, sizeof (MrmSample), self->priv->history_len);
+    for (i = 0; i < self->priv->history_len; i++)
+        g_array_append_vals (history,
+                             &self->priv->history[(self->priv->history_first + i) % MRM_DEVICE_HISTORY_SIZE],
+                             1);
+    return history;
+}
+
+GPtrArray *
+mrm_device_dup_carrier_history (MrmDevice *self)
+{
+    GPtrArray *history;
+    guint i;
+
+    g_return_val_if_fail (MRM_IS_DEVICE (self), NULL);
+
+    history = g_ptr_array_new_full (self->priv->carrier_history_len, (GDestroyNotify) mrm_carrier_sample_free);
+    for (i = 0; i < self->priv->carrier_history_len; i++)
+        g_ptr_array_add (history,
+                         mrm_carrier_sample_copy (self->priv->carrier_history[(self->priv->carrier_history_first + i) % MRM_DEVICE_HISTORY_SIZE]));
+    return history;
+}
+
+GArray *
+mrm_device_dup_neighbors (MrmDevice *self)
+{
+    GArray *neighbors;
+
+    g_return_val_if_fail (MRM_IS_DEVICE (self), NULL);
+
+    neighbors = g_array_sized_new (FALSE, FALSE, sizeof (MrmNeighbor), self->priv->neighbors_main->len);
+    g_array_append_vals (neighbors, self->priv->neighbors_main->data, self->priv->neighbors_main->len);
+    return neighbors;
+}
+
+GArray *
+mrm_device_dup_serving_cell_log (MrmDevice *self)
+{
+    GArray *log;
+    guint i;
+
+    g_return_val_if_fail (MRM_IS_DEVICE (self), NULL);
+
+    log = g_array_sized_new (FALSE, FALSE, sizeof (MrmServingCell), self->priv->serving_cell_log_len);
+    for (i = 0; i < self->priv->serving_cell_log_len; i++)
+        g_array_append_vals (log,
+                             &self->priv->serving_cell_log[(self->priv->serving_cell_log_first + i) % MRM_DEVICE_SERVING_CELL_LOG_SIZE],
+                             1);
+    return log;
+}
+
+gboolean
+mrm_device_get_fast_reopen (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), FALSE);
+
+    return g_atomic_int_get (&self->priv->fast_reopen);
+}
+
+/* Applies to the clients released from now on */
+void
+mrm_device_set_fast_reopen (MrmDevice *self,
+                            gboolean fast_reopen)
+{
+    g_return_if_fail (MRM_IS_DEVICE (self));
+
+    g_object_set (self, "fast-reopen", fast_reopen, NULL);
+}
+
+void
+mrm_device_get_clients (MrmDevice *self,
+                        MrmDeviceClients *clients)
+{
+    g_return_if_fail (MRM_IS_DEVICE (self));
+    g_return_if_fail (clients != NULL);
+
+    g_mutex_lock (&self->priv->lock);
+    *clients = self->priv->clients;
+    g_mutex_unlock (&self->priv->lock);
+}
+
+gint64
+mrm_device_get_init_duration (MrmDevice *self)
+{
+    g_return_val_if_fail (MRM_IS_DEVICE (self), 0);
+
+    return self->priv->init_duration;
+}
+
+void
+mrm_device_get_rtt_stats (MrmDevice *self,
+                          MrmDeviceTimingStats *stats)
+{
+    g_return_if_fail (MRM_IS_DEVICE (self));
+    g_return_if_fail (stats != NULL);
+
+    g_mutex_lock (&self->priv->lock);
+    timing_stats_export (&self->priv->rtt, stats);
+    g_mutex_unlock (&self->priv->lock);
+}
+
+void
+mrm_device_get_jitter_stats (MrmDevice *self,
+                             MrmDeviceTimingStats *stats)
+{
+    g_return_if_fail (MRM_IS_DEVICE (self));
+    g_return_if_fail (stats != NULL);
+
+    g_mutex_lock (&self->priv->lock);
+    timing_stats_export (&self->priv->jitter, stats);
+    g_mutex_unlock (&self->priv->lock);
+}
+
 gint
 mrm_device_get_pin_attempts_left (MrmDevice *self)
 {
@@ -943,21 +4481,68 @@ mrm_device_new_finish (GAsyncResult *res,
     return (ret ? MRM_DEVICE (ret) : NULL);
 }
 
+/* Giving the clients persisted from a previous run enables fast reopen
+ * mode; they may not have any client ID yet */
 void
-mrm_device_new (GFile *file,
-                GCancellable *cancellable,
-                GAsyncReadyCallback callback,
-                gpointer user_data)
+mrm_device_new_full (GFile *file,
+                     const gchar *manufacturer,
+                     const gchar *model,
+                     const gchar *revision,
+                     const MrmDeviceClients *clients,
+                     GCancellable *cancellable,
+                     GAsyncReadyCallback callback,
+                     gpointer user_data)
+{
+    g_async_initable_new_async (MRM_TYPE_DEVICE,
+                                G_PRIORITY_DEFAULT,
+                                cancellable,
+                                callback,
+                                user_data,
+                                "file",         file,
+                                "manufacturer", manufacturer,
+                                "model",        model,
+                                "revision",     revision,
+                                "fast-reopen",  !!clients,
+                                "clients",      clients,
+                                NULL);
+}
+
+void
+mrm_device_new_with_identity (GFile *file,
+                              const gchar *manufacturer,
+                              const gchar *model,
+                              const gchar *revision,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+    mrm_device_new_full (file, manufacturer, model, revision, NULL, cancellable, callback, user_data);
+}
+
+void
+mrm_device_new_with_backend (MrmDeviceBackend *backend,
+                             GCancellable *cancellable,
+                             GAsyncReadyCallback callback,
+                             gpointer user_data)
 {
     g_async_initable_new_async (MRM_TYPE_DEVICE,
                                 G_PRIORITY_DEFAULT,
                                 cancellable,
                                 callback,
                                 user_data,
-                                "file", file,
+                                "backend", backend,
                                 NULL);
 }
 
+void
+mrm_device_new (GFile *file,
+                GCancellable *cancellable,
+                GAsyncReadyCallback callback,
+                gpointer user_data)
+{
+    mrm_device_new_with_identity (file, NULL, NULL, NULL, cancellable, callback, user_data);
+}
+
 /*****************************************************************************/
 /* Async init */
 
@@ -965,12 +4550,21 @@ typedef struct {
     MrmDevice *self;
     GSimpleAsyncResult *result;
     GCancellable *cancellable;
+    gint64 started;
+    gint64 opened;
+    gboolean version_info;
+    gboolean dms_stale;
+    gboolean identity_cached;
+    gboolean completed;
+    gboolean reconnect;
+    guint n_blocking;
+    guint n_pending;
+    GError *error;
 } InitContext;
 
 static void
-init_context_complete_and_free (InitContext *ctx)
+init_context_free (InitContext *ctx)
 {
-    g_simple_async_result_complete_in_idle (ctx->result);
     if (ctx->cancellable)
         g_object_unref (ctx->cancellable);
     g_object_unref (ctx->result);
@@ -978,6 +4572,13 @@ init_context_complete_and_free (InitContext *ctx)
     g_slice_free (InitContext, ctx);
 }
 
+static void
+init_context_complete_and_free (InitContext *ctx)
+{
+    g_simple_async_result_complete_in_idle (ctx->result);
+    init_context_free (ctx);
+}
+
 static gboolean
 initable_init_finish (GAsyncInitable  *initable,
                       GAsyncResult    *result,
@@ -986,6 +4587,162 @@ initable_init_finish (GAsyncInitable  *initable,
     return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error);
 }
 
+static gchar **
+identity_field (MrmDevice *self,
+                guint prop_id)
+{
+    switch (prop_id) {
+    case PROP_MANUFACTURER:
+        return &self->priv->manufacturer;
+    case PROP_MODEL:
+        return &self->priv->model;
+    case PROP_REVISION:
+        return &self->priv->revision;
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+typedef struct {
+    MrmDevice *self;
+    guint prop_id;
+    gchar *value;
+} IdentityUpdateContext;
+
+static void
+identity_update_context_free (IdentityUpdateContext *ctx)
+{
+    g_object_unref (ctx->self);
+    g_free (ctx->value);
+    g_slice_free (IdentityUpdateContext, ctx);
+}
+
+/* Runs in the main context, where the identity strings are read */
+static gboolean
+identity_update_cb (IdentityUpdateContext *ctx)
+{
+    gchar **field;
+
+    field = identity_field (ctx->self, ctx->prop_id);
+    if (g_strcmp0 (*field, ctx->value) != 0) {
+        g_debug ("MRM device '%s' %s changed: '%s' -> '%s'",
+                 ctx->self->priv->name, properties[ctx->prop_id]->name, *field, ctx->value);
+        g_free (*field);
+        *field = ctx->value;
+        ctx->value = NULL;
+        g_object_notify_by_pspec (G_OBJECT (ctx->self), properties[ctx->prop_id]);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+init_identity_set (InitContext *ctx,
+                   guint prop_id,
+                   const gchar *value)
+{
+    IdentityUpdateContext *update;
+    gchar **field;
+
+    /* Not reported to the caller yet: nobody else looks at the fields */
+    if (!ctx->completed && !ctx->reconnect) {
+        field = identity_field (ctx->self, prop_id);
+        g_free (*field);
+        *field = g_strdup (value);
+        return;
+    }
+
+    /* Refreshing a cached identity of an already reported device */
+    update = g_slice_new (IdentityUpdateContext);
+    update->self = g_object_ref (ctx->self);
+    update->prop_id = prop_id;
+    update->value = g_strdup (value);
+    g_main_context_invoke_full (ctx->self->priv->main_context,
+                                G_PRIORITY_DEFAULT,
+                                (GSourceFunc) identity_update_cb,
+                                update,
+                                (GDestroyNotify) identity_update_context_free);
+}
+
+static void
+init_complete (InitContext *ctx)
+{
+    if (ctx->error)
+        g_simple_async_result_take_error (ctx->result, ctx->error);
+    else {
+        gint64 now;
+
+        /* The init duration of a device already reported is left alone */
+        now = g_get_monotonic_time ();
+        if (!ctx->reconnect)
+            ctx->self->priv->init_duration = now - ctx->started;
+        g_debug ("MRM device '%s' %s in %" G_GINT64_FORMAT " ms "
+                 "(open: %" G_GINT64_FORMAT " ms%s, identity: %" G_GINT64_FORMAT " ms%s)",
+                 ctx->self->priv->name,
+                 ctx->reconnect ? "reopened" : "initialized",
+                 (now - ctx->started) / 1000,
+                 (ctx->opened - ctx->started) / 1000,
+                 ctx->self->priv->clients_reused[MRM_DEVICE_CLIENT_DMS] ? ", reused client" : "",
+                 (now - ctx->opened) / 1000,
+                 ctx->identity_cached ? ", cached" : "");
+        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+    }
+
+    ctx->error = NULL;
+    ctx->completed = TRUE;
+    g_simple_async_result_complete_in_idle (ctx->result);
+}
+
+/* Called once per query. Init is completed as soon as all blocking queries
+ * are done, reporting the first error; identity queries only block when
+ * there was no cached identity to start with. */
+static void init_allocate_dms (InitContext *ctx,
+                               guint8 cid);
+
+static void
+init_query_done (InitContext *ctx,
+                 gboolean blocking,
+                 GError *error)
+{
+    g_assert (ctx->n_pending > 0);
+
+    /* Retried with a new client once all blocking queries are done */
+    if (error && blocking && client_is_stale (ctx->self, MRM_DEVICE_CLIENT_DMS, error)) {
+        ctx->dms_stale = TRUE;
+        g_error_free (error);
+        error = NULL;
+    }
+
+    if (error) {
+        if (!blocking) {
+            g_debug ("Cannot refresh cached identity of MRM device '%s': %s",
+                     ctx->self->priv->name, error->message);
+            g_error_free (error);
+        } else if (!ctx->error)
+            ctx->error = error;
+        else
+            g_error_free (error);
+    }
+
+    if (blocking) {
+        g_assert (ctx->n_blocking > 0);
+        if (--ctx->n_blocking == 0) {
+            if (ctx->dms_stale) {
+                /* The new allocation takes over the pending count */
+                ctx->dms_stale = FALSE;
+                g_clear_error (&ctx->error);
+                client_drop_stale (ctx->self, MRM_DEVICE_CLIENT_DMS, &ctx->self->priv->dms);
+                init_allocate_dms (ctx, QMI_CID_NONE);
+                return;
+            }
+            init_complete (ctx);
+        }
+    }
+
+    if (--ctx->n_pending == 0)
+        init_context_free (ctx);
+}
+
 static void
 init_reload_status_ready (MrmDevice *self,
                           GAsyncResult *res,
@@ -993,13 +4750,17 @@ init_reload_status_ready (MrmDevice *self,
 {
     GError *error = NULL;
 
-    if (!reload_status_finish (self, res, &error)) {
+    if (!reload_status_finish (self, res, &error))
         g_prefix_error (&error, "Cannot reload modem status: ");
-        g_simple_async_result_take_error (ctx->result, error);
-    } else
-        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
 
-    init_context_complete_and_free (ctx);
+    init_query_done (ctx, TRUE, error);
+}
+
+/* A cached identity is only refreshed in the background */
+static RequestPriority
+init_identity_priority (InitContext *ctx)
+{
+    return ctx->identity_cached ? REQUEST_PRIORITY_BACKGROUND : REQUEST_PRIORITY_CONTROL;
 }
 
 static void
@@ -1011,23 +4772,19 @@ qmi_client_dms_get_revision_ready (QmiClientDms *dms,
     GError *error = NULL;
     const gchar *str;
 
+    request_done (ctx->self, init_identity_priority (ctx));
     output = qmi_client_dms_get_revision_finish (dms, res, &error);
     if (!output ||
         !qmi_message_dms_get_revision_output_get_result (output, &error) ||
-        !qmi_message_dms_get_revision_output_get_revision (output, &str, &error)) {
+        !qmi_message_dms_get_revision_output_get_revision (output, &str, &error))
         g_prefix_error (&error, "Cannot get revision: ");
-        g_simple_async_result_take_error (ctx->result, error);
-        init_context_complete_and_free (ctx);
-    } else {
-        ctx->self->priv->revision = g_strdup (str);
-        reload_status (ctx->self,
-                       ctx->cancellable,
-                       (GAsyncReadyCallback) init_reload_status_ready,
-                       ctx);
-    }
+    else
+        init_identity_set (ctx, PROP_REVISION, str);
 
     if (output)
         qmi_message_dms_get_revision_output_unref (output);
+
+    init_query_done (ctx, !ctx->identity_cached, error);
 }
 
 static void
@@ -1039,25 +4796,19 @@ qmi_client_dms_get_model_ready (QmiClientDms *dms,
     GError *error = NULL;
     const gchar *str;
 
+    request_done (ctx->self, init_identity_priority (ctx));
     output = qmi_client_dms_get_model_finish (dms, res, &error);
     if (!output ||
         !qmi_message_dms_get_model_output_get_result (output, &error) ||
-        !qmi_message_dms_get_model_output_get_model (output, &str, &error)) {
+        !qmi_message_dms_get_model_output_get_model (output, &str, &error))
         g_prefix_error (&error, "Cannot get model: ");
-        g_simple_async_result_take_error (ctx->result, error);
-        init_context_complete_and_free (ctx);
-    } else {
-        ctx->self->priv->model = g_strdup (str);
-        qmi_client_dms_get_revision (QMI_CLIENT_DMS (ctx->self->priv->dms),
-                                     NULL,
-                                     5,
-                                     ctx->cancellable,
-                                     (GAsyncReadyCallback) qmi_client_dms_get_revision_ready,
-                                     ctx);
-    }
+    else
+        init_identity_set (ctx, PROP_MODEL, str);
 
     if (output)
         qmi_message_dms_get_model_output_unref (output);
+
+    init_query_done (ctx, !ctx->identity_cached, error);
 }
 
 static void
@@ -1069,25 +4820,55 @@ qmi_client_dms_get_manufacturer_ready (QmiClientDms *dms,
     GError *error = NULL;
     const gchar *str;
 
+    request_done (ctx->self, init_identity_priority (ctx));
     output = qmi_client_dms_get_manufacturer_finish (dms, res, &error);
     if (!output ||
         !qmi_message_dms_get_manufacturer_output_get_result (output, &error) ||
-        !qmi_message_dms_get_manufacturer_output_get_manufacturer (output, &str, &error)) {
+        !qmi_message_dms_get_manufacturer_output_get_manufacturer (output, &str, &error))
         g_prefix_error (&error, "Cannot get manufacturer: ");
-        g_simple_async_result_take_error (ctx->result, error);
-        init_context_complete_and_free (ctx);
-    } else {
-        ctx->self->priv->manufacturer = g_strdup (str);
-        qmi_client_dms_get_model (QMI_CLIENT_DMS (ctx->self->priv->dms),
-                                  NULL,
-                                  5,
-                                  ctx->cancellable,
-                                  (GAsyncReadyCallback) qmi_client_dms_get_model_ready,
-                                  ctx);
-    }
+    else
+        init_identity_set (ctx, PROP_MANUFACTURER, str);
 
     if (output)
         qmi_message_dms_get_manufacturer_output_unref (output);
+
+    init_query_done (ctx, !ctx->identity_cached, error);
+}
+
+static void
+init_query_manufacturer_start (MrmDevice *self,
+                               InitContext *ctx)
+{
+    qmi_client_dms_get_manufacturer (QMI_CLIENT_DMS (self->priv->dms),
+                                     NULL,
+                                     5,
+                                     ctx->cancellable,
+                                     (GAsyncReadyCallback) qmi_client_dms_get_manufacturer_ready,
+                                     ctx);
+}
+
+static void
+init_query_model_start (MrmDevice *self,
+                        InitContext *ctx)
+{
+    qmi_client_dms_get_model (QMI_CLIENT_DMS (self->priv->dms),
+                              NULL,
+                              5,
+                              ctx->cancellable,
+                              (GAsyncReadyCallback) qmi_client_dms_get_model_ready,
+                              ctx);
+}
+
+static void
+init_query_revision_start (MrmDevice *self,
+                           InitContext *ctx)
+{
+    qmi_client_dms_get_revision (QMI_CLIENT_DMS (self->priv->dms),
+                                 NULL,
+                                 5,
+                                 ctx->cancellable,
+                                 (GAsyncReadyCallback) qmi_client_dms_get_revision_ready,
+                                 ctx);
 }
 
 static void
@@ -1095,24 +4876,72 @@ qmi_device_allocate_client_ready (QmiDevice *device,
                                   GAsyncResult *res,
                                   InitContext *ctx)
 {
+    MrmDevicePrivate *priv = ctx->self->priv;
     GError *error = NULL;
 
-    ctx->self->priv->dms = qmi_device_allocate_client_finish (device, res, &error);
-    if (!ctx->self->priv->dms) {
+    priv->dms = qmi_device_allocate_client_finish (device, res, &error);
+    if (!priv->dms) {
         g_prefix_error (&error, "Cannot allocate DMS client: ");
-        g_simple_async_result_take_error (ctx->result, error);
-        init_context_complete_and_free (ctx);
+        ctx->error = error;
+        init_complete (ctx);
+        if (--ctx->n_pending == 0)
+            init_context_free (ctx);
         return;
     }
 
-    g_debug ("DMS client at '%s' correctly allocated", qmi_device_get_path_display (device));
+    client_info_update (ctx->self, MRM_DEVICE_CLIENT_DMS, priv->dms);
+    ctx->opened = g_get_monotonic_time ();
+
+    g_mutex_lock (&priv->lock);
+    if (!priv->clients_reused[MRM_DEVICE_CLIENT_DMS]) {
+        g_debug ("DMS client at '%s' correctly allocated", qmi_device_get_path_display (device));
+        /* Only a complete open is a reference for fast reopens */
+        if (ctx->version_info) {
+            priv->clients.full_open_duration = ctx->opened - ctx->started;
+            priv->queued_clients_updated = TRUE;
+            schedule_flush (ctx->self);
+        }
+    } else if (priv->clients.full_open_duration > 0)
+        g_debug ("DMS client %u at '%s' reused: open took %" G_GINT64_FORMAT " ms, "
+                 "%" G_GINT64_FORMAT " ms less than the last full open",
+                 qmi_client_get_cid (priv->dms), qmi_device_get_path_display (device),
+                 (ctx->opened - ctx->started) / 1000,
+                 (priv->clients.full_open_duration - (ctx->opened - ctx->started)) / 1000);
+    else
+        g_debug ("DMS client %u at '%s' reused", qmi_client_get_cid (priv->dms), qmi_device_get_path_display (device));
+    g_mutex_unlock (&priv->lock);
+
+    /* Identity and status queries are independent, so send them all at once.
+     * With a cached identity only the status is waited for, and the identity
+     * is refreshed in the background. */
+    ctx->identity_cached = (ctx->self->priv->manufacturer &&
+                            ctx->self->priv->model &&
+                            ctx->self->priv->revision);
+    ctx->n_pending += 4 - 1; /* queries instead of the allocation */
+    ctx->n_blocking = ctx->identity_cached ? 1 : 4;
+    request_submit (ctx->self, init_identity_priority (ctx),
+                    (RequestStartFunc) init_query_manufacturer_start, ctx);
+    request_submit (ctx->self, init_identity_priority (ctx),
+                    (RequestStartFunc) init_query_model_start, ctx);
+    request_submit (ctx->self, init_identity_priority (ctx),
+                    (RequestStartFunc) init_query_revision_start, ctx);
+    reload_status (ctx->self,
+                   ctx->cancellable,
+                   (GAsyncReadyCallback) init_reload_status_ready,
+                   ctx);
+}
 
-    qmi_client_dms_get_manufacturer (QMI_CLIENT_DMS (ctx->self->priv->dms),
-                                     NULL,
-                                     5,
-                                     ctx->cancellable,
-                                     (GAsyncReadyCallback) qmi_client_dms_get_manufacturer_ready,
-                                     ctx);
+static void
+init_allocate_dms (InitContext *ctx,
+                   guint8 cid)
+{
+    qmi_device_allocate_client (ctx->self->priv->qmi_device,
+                                QMI_SERVICE_DMS,
+                                cid,
+                                5,
+                                ctx->cancellable,
+                                (GAsyncReadyCallback) qmi_device_allocate_client_ready,
+                                ctx);
 }
 
 static void
@@ -1131,13 +4960,9 @@ qmi_device_open_ready (QmiDevice *device,
 
     g_debug ("QMI device at '%s' correctly opened", qmi_device_get_path_display (device));
 
-    qmi_device_allocate_client (device,
-                                QMI_SERVICE_DMS,
-                                QMI_CID_NONE,
-                                5,
-                                ctx->cancellable,
-                                (GAsyncReadyCallback) qmi_device_allocate_client_ready,
-                                ctx);
+    /* The allocation keeps the context alive until the queries are sent */
+    ctx->n_pending = 1;
+    init_allocate_dms (ctx, client_cid_to_reuse (ctx->self, MRM_DEVICE_CLIENT_DMS));
 }
 
 static void
@@ -1158,15 +4983,75 @@ qmi_device_new_ready (GObject *source,
     g_debug ("QMI device at '%s' correctly created",
              qmi_device_get_path_display (ctx->self->priv->qmi_device));
 
+    /* Service versions are persisted along with the clients to reuse, so
+     * there's no need to query them again */
+    g_mutex_lock (&ctx->self->priv->lock);
+    ctx->version_info = (!g_atomic_int_get (&ctx->self->priv->fast_reopen) ||
+                         ctx->self->priv->clients.clients[MRM_DEVICE_CLIENT_DMS].cid == QMI_CID_NONE);
+    g_mutex_unlock (&ctx->self->priv->lock);
+
     qmi_device_open (ctx->self->priv->qmi_device,
                      (QMI_DEVICE_OPEN_FLAGS_PROXY |
-                      QMI_DEVICE_OPEN_FLAGS_VERSION_INFO),
+                      (ctx->version_info ? QMI_DEVICE_OPEN_FLAGS_VERSION_INFO : QMI_DEVICE_OPEN_FLAGS_NONE)),
                      5,
                      ctx->cancellable,
                      (GAsyncReadyCallback) qmi_device_open_ready,
                      ctx);
 }
 
+static void
+backend_open_ready (MrmDeviceBackend *backend,
+                    GAsyncResult *res,
+                    InitContext *ctx)
+{
+    GError *error = NULL;
+    gchar *manufacturer = NULL;
+    gchar *model = NULL;
+    gchar *revision = NULL;
+
+    if (!mrm_device_backend_open_finish (backend, res, &manufacturer, &model, &revision, &error)) {
+        g_prefix_error (&error, "Cannot open backend: ");
+        g_simple_async_result_take_error (ctx->result, error);
+        init_context_complete_and_free (ctx);
+        return;
+    }
+
+    ctx->self->priv->backend_open = TRUE;
+    ctx->opened = g_get_monotonic_time ();
+    init_identity_set (ctx, PROP_MANUFACTURER, manufacturer);
+    init_identity_set (ctx, PROP_MODEL, model);
+    init_identity_set (ctx, PROP_REVISION, revision);
+    g_free (manufacturer);
+    g_free (model);
+    g_free (revision);
+
+    /* There's no SIM to unlock */
+    ctx->self->priv->status = MRM_DEVICE_STATUS_READY;
+    queue_notify (ctx->self, PROP_STATUS);
+
+    init_complete (ctx);
+    init_context_free (ctx);
+}
+
+static gboolean
+init_backend_in_worker (InitContext *ctx)
+{
+    mrm_device_backend_open (ctx->self->priv->backend,
+                             ctx->cancellable,
+                             (GAsyncReadyCallback) backend_open_ready,
+                             ctx);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+init_in_worker (InitContext *ctx)
+{
+    qmi_device_new (ctx->self->priv->file,
+                    ctx->cancellable,
+                    (GAsyncReadyCallback) qmi_device_new_ready,
+                    ctx);
+    return G_SOURCE_REMOVE;
+}
 
 static void
 initable_init_async (GAsyncInitable *initable,
@@ -1179,6 +5064,7 @@ initable_init_async (GAsyncInitable *initable,
 
     ctx = g_slice_new0 (InitContext);
     ctx->self = g_object_ref (initable);
+    ctx->started = g_get_monotonic_time ();
     if (cancellable)
         ctx->cancellable = g_object_ref (cancellable);
     ctx->result = g_simple_async_result_new (G_OBJECT (initable),
@@ -1186,6 +5072,12 @@ initable_init_async (GAsyncInitable *initable,
                                              user_data,
                                              initable_init_async);
 
+    /* Backends are opened in the worker as well */
+    if (ctx->self->priv->backend) {
+        worker_invoke (ctx->self, (GSourceFunc) init_backend_in_worker, ctx);
+        return;
+    }
+
     /* We need a proper file to initialize */
     if (!ctx->self->priv->file) {
         g_simple_async_result_set_error (ctx->result,
@@ -1196,11 +5088,331 @@ initable_init_async (GAsyncInitable *initable,
         return;
     }
 
-    /* Create QMI device */
-    qmi_device_new (ctx->self->priv->file,
-                    ctx->cancellable,
-                    (GAsyncReadyCallback) qmi_device_new_ready,
-                    ctx);
+    /* Create QMI device in the worker, so that its I/O is processed there */
+    worker_invoke (ctx->self, (GSourceFunc) init_in_worker, ctx);
+}
+
+/*****************************************************************************/
+/* Reconnection
+ *
+ * A port going away, e.g. because the modem firmware crashed, doesn't get
+ * the device disposed: only what is tied to the QMI device is dropped, and
+ * the history, subscriptions and poll settings are kept. Once the modem is
+ * back it is reopened with the same sequence as on init, retrying with an
+ * exponential backoff while it boots, and monitoring resumes if it was
+ * running before. */
+
+static void reconnect_attempt (MrmDevice *self);
+
+/* Runs in the worker */
+static void
+connection_set (MrmDevice *self,
+                MrmDeviceConnection connection)
+{
+    if ((MrmDeviceConnection) g_atomic_int_get (&self->priv->connection) == connection)
+        return;
+
+    g_atomic_int_set (&self->priv->connection, connection);
+    queue_notify (self, PROP_CONNECTION);
+}
+
+/* Runs in the worker */
+static void
+reconnect_stop (MrmDevice *self)
+{
+    if (!self->priv->reconnect_source)
+        return;
+
+    g_source_destroy (self->priv->reconnect_source);
+    g_source_unref (self->priv->reconnect_source);
+    self->priv->reconnect_source = NULL;
+}
+
+/* Runs in the worker. The modem is gone or not answering, so clients are
+ * only dropped in libqmi, and whatever is in flight is aborted. */
+static void
+qmi_device_drop (MrmDevice *self)
+{
+    guint i;
+
+    nas_cancellable_cancel (self);
+    self->priv->polling = FALSE;
+    g_cancellable_cancel (self->priv->cancellable);
+    request_flush (self);
+    g_object_unref (self->priv->cancellable);
+    self->priv->cancellable = g_cancellable_new ();
+
+    poll_stop (self, POLL_GROUP_SIGNAL);
+    poll_stop (self, POLL_GROUP_POWER);
+    poll_stop (self, POLL_GROUP_NEIGHBORS);
+    poll_stop (self, POLL_GROUP_TRAFFIC);
+    poll_stop (self, POLL_GROUP_CARRIERS);
+
+    if (self->priv->nas) {
+        if (self->priv->signal_info_indication_id) {
+            g_signal_handler_disconnect (self->priv->nas, self->priv->signal_info_indication_id);
+            self->priv->signal_info_indication_id = 0;
+        }
+        if (self->priv->serving_system_indication_id) {
+            g_signal_handler_disconnect (self->priv->nas, self->priv->serving_system_indication_id);
+            self->priv->serving_system_indication_id = 0;
+        }
+    }
+    g_clear_object (&self->priv->dms);
+    g_clear_object (&self->priv->nas);
+    g_clear_object (&self->priv->wds);
+
+    /* Client IDs don't survive a modem reset */
+    for (i = 0; i < MRM_DEVICE_N_CLIENTS; i++) {
+        client_info_update (self, i, NULL);
+        self->priv->clients_reused[i] = FALSE;
+    }
+
+    if (self->priv->qmi_device)
+        qmi_device_close (self->priv->qmi_device, NULL);
+    g_clear_object (&self->priv->qmi_device);
+
+    /* Same as after stopping monitoring */
+    traffic_counters_reset (self);
+    neighbors_reset (self);
+    mrm_serving_cell_init (&self->priv->serving_cell, 0);
+    self->priv->lte_serving_pci = MRM_SERVING_CELL_UNKNOWN;
+    if (self->priv->signal_info_indications) {
+        g_atomic_int_set (&self->priv->signal_info_indications, FALSE);
+        queue_notify (self, PROP_SIGNAL_SAMPLE_INTERVAL_MS);
+    }
+    self->priv->serving_system_indications = FALSE;
+    self->priv->ca_info_unsupported = FALSE;
+    self->priv->nr5g_signal = FALSE;
+    memset (&self->priv->signal_sample, 0, sizeof (MrmSample));
+    device_set_act (self, 0);
+}
+
+static gboolean
+reconnect_attempt_cb (MrmDevice *self)
+{
+    g_source_unref (self->priv->reconnect_source);
+    self->priv->reconnect_source = NULL;
+
+    reconnect_attempt (self);
+    return G_SOURCE_REMOVE;
+}
+
+/* Runs in the worker */
+static void
+reconnect_retry (MrmDevice *self)
+{
+    g_assert (self->priv->reconnect_source == NULL);
+
+    qmi_device_drop (self);
+    connection_set (self, MRM_DEVICE_CONNECTION_RECONNECTING);
+
+    g_debug ("Retrying to reconnect MRM device '%s' in %u ms",
+             self->priv->name, self->priv->reconnect_delay_ms);
+    self->priv->reconnect_source = g_timeout_source_new (self->priv->reconnect_delay_ms);
+    g_source_set_callback (self->priv->reconnect_source,
+                           (GSourceFunc) reconnect_attempt_cb,
+                           self,
+                           NULL);
+    g_source_attach (self->priv->reconnect_source, self->priv->worker_context);
+
+    self->priv->reconnect_delay_ms = MIN (self->priv->reconnect_delay_ms * 2,
+                                          MRM_DEVICE_RECONNECT_DELAY_MS_MAX);
+}
+
+/* An attempt is superseded once the cancellable it was started with is
+ * cancelled, i.e. if disconnected or closed meanwhile */
+static void
+reconnect_start_nas_ready (MrmDevice *self,
+                           GAsyncResult *res,
+                           GCancellable *cancellable)
+{
+    GError *error = NULL;
+
+    if (!mrm_device_start_nas_finish (self, res, &error)) {
+        /* Unless stopped meanwhile, the modem wasn't fully up yet */
+        if (!g_cancellable_is_cancelled (cancellable) &&
+            !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_debug ("Cannot resume monitoring of MRM device '%s': %s",
+                     self->priv->name, error->message);
+            self->priv->resume_nas = TRUE;
+            reconnect_retry (self);
+        }
+        g_error_free (error);
+    } else
+        g_debug ("Monitoring of MRM device '%s' resumed", self->priv->name);
+
+    g_object_unref (cancellable);
+}
+
+static void
+reconnect_ready (MrmDevice *self,
+                 GAsyncResult *res,
+                 GCancellable *cancellable)
+{
+    GError *error = NULL;
+
+    if (!initable_init_finish (G_ASYNC_INITABLE (self), res, &error)) {
+        if (!g_cancellable_is_cancelled (cancellable)) {
+            g_debug ("Cannot reconnect MRM device '%s' (attempt %u): %s",
+                     self->priv->name, self->priv->reconnect_attempts, error->message);
+            reconnect_retry (self);
+        }
+        g_error_free (error);
+        g_object_unref (cancellable);
+        return;
+    }
+
+    if (g_cancellable_is_cancelled (cancellable)) {
+        g_object_unref (cancellable);
+        return;
+    }
+
+    g_debug ("MRM device '%s' reconnected after %u attempts",
+             self->priv->name, self->priv->reconnect_attempts);
+    self->priv->reconnect_attempts = 0;
+    self->priv->reconnect_delay_ms = MRM_DEVICE_RECONNECT_DELAY_MS_MIN;
+    connection_set (self, MRM_DEVICE_CONNECTION_CONNECTED);
+
+    if (self->priv->resume_nas) {
+        self->priv->resume_nas = FALSE;
+        if (self->priv->status == MRM_DEVICE_STATUS_READY)
+            mrm_device_start_nas (self,
+                                  (GAsyncReadyCallback) reconnect_start_nas_ready,
+                                  g_object_ref (cancellable));
+        else
+            g_debug ("Cannot resume monitoring of MRM device '%s': SIM not ready",
+                     self->priv->name);
+    }
+
+    g_object_unref (cancellable);
+}
+
+/* Runs in the worker. Same as the async init, but reporting to the worker
+ * itself, and with the identity already known by everyone. */
+static void
+reconnect_attempt (MrmDevice *self)
+{
+    InitContext *ctx;
+
+    self->priv->reconnect_attempts++;
+
+    ctx = g_slice_new0 (InitContext);
+    ctx->self = g_object_ref (self);
+    ctx->started = g_get_monotonic_time ();
+    ctx->reconnect = TRUE;
+    ctx->cancellable = g_object_ref (self->priv->cancellable);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             (GAsyncReadyCallback) reconnect_ready,
+                                             g_object_ref (self->priv->cancellable),
+                                             reconnect_attempt);
+    init_in_worker (ctx);
+}
+
+static gboolean
+disconnect_in_worker (MrmDevice *self)
+{
+    gboolean sampling;
+
+    if (g_atomic_int_get (&self->priv->connection) != MRM_DEVICE_CONNECTION_DISCONNECTED) {
+        reconnect_stop (self);
+
+        /* Resumed once reconnected if running, or about to */
+        sampling = (self->priv->nas_cancellable != NULL);
+        if (sampling)
+            self->priv->resume_nas = TRUE;
+
+        g_debug ("MRM device '%s' disconnected%s", self->priv->name,
+                 self->priv->resume_nas ? ", monitoring resumed once reconnected" : "");
+        qmi_device_drop (self);
+
+        /* So that graphs don't bridge the time the device is away */
+        if (sampling) {
+            MrmSample gap;
+
+            memset (&gap, 0, sizeof (gap));
+            gap.timestamp = g_get_monotonic_time ();
+            gap.reply_timestamp = gap.timestamp;
+            gap.groups = (MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_POWER | MRM_SAMPLE_GROUP_TRAFFIC);
+            gap.gap = TRUE;
+            queue_sample (self, &gap);
+        }
+
+        connection_set (self, MRM_DEVICE_CONNECTION_DISCONNECTED);
+    }
+
+    g_object_unref (self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_disconnect (MrmDevice *self)
+{
+    g_return_if_fail (MRM_IS_DEVICE (self));
+    g_return_if_fail (self->priv->backend == NULL);
+
+    worker_invoke (self, (GSourceFunc) disconnect_in_worker, g_object_ref (self));
+}
+
+typedef struct {
+    MrmDevice *self;
+    GFile *file;
+} ReconnectContext;
+
+static void
+reconnect_context_free (ReconnectContext *ctx)
+{
+    g_object_unref (ctx->file);
+    g_object_unref (ctx->self);
+    g_slice_free (ReconnectContext, ctx);
+}
+
+static gboolean
+reconnect_in_worker (ReconnectContext *ctx)
+{
+    MrmDevice *self = ctx->self;
+
+    if (g_atomic_int_get (&self->priv->connection) == MRM_DEVICE_CONNECTION_CONNECTED) {
+        g_debug ("MRM device '%s' already connected", self->priv->name);
+        reconnect_context_free (ctx);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Whatever was going on applies to the previous port */
+    reconnect_stop (self);
+    qmi_device_drop (self);
+
+    /* The port may have been renamed */
+    g_mutex_lock (&self->priv->lock);
+    g_object_unref (self->priv->file);
+    self->priv->file = g_object_ref (ctx->file);
+    g_mutex_unlock (&self->priv->lock);
+    queue_notify (self, PROP_FILE);
+
+    g_debug ("Reconnecting MRM device '%s'", self->priv->name);
+    self->priv->reconnect_attempts = 0;
+    self->priv->reconnect_delay_ms = MRM_DEVICE_RECONNECT_DELAY_MS_MIN;
+    connection_set (self, MRM_DEVICE_CONNECTION_RECONNECTING);
+    reconnect_attempt (self);
+
+    reconnect_context_free (ctx);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mrm_device_reconnect (MrmDevice *self,
+                      GFile *file)
+{
+    ReconnectContext *ctx;
+
+    g_return_if_fail (MRM_IS_DEVICE (self));
+    g_return_if_fail (G_IS_FILE (file));
+    g_return_if_fail (self->priv->backend == NULL);
+
+    ctx = g_slice_new (ReconnectContext);
+    ctx->self = g_object_ref (self);
+    ctx->file = g_object_ref (file);
+    worker_invoke (self, (GSourceFunc) reconnect_in_worker, ctx);
 }
 
 /*****************************************************************************/
@@ -1221,8 +5433,62 @@ set_property (GObject *object,
         if (self->priv->file)
             self->priv->name = g_file_get_basename (self->priv->file);
         break;
+    case PROP_BACKEND:
+        g_assert (self->priv->backend == NULL);
+        self->priv->backend = g_value_dup_object (value);
+        if (self->priv->backend) {
+            g_free (self->priv->name);
+            self->priv->name = g_strdup (mrm_device_backend_get_name (self->priv->backend));
+        }
+        break;
+    case PROP_MANUFACTURER:
+    case PROP_MODEL:
+    case PROP_REVISION: {
+        gchar **field;
+
+        field = identity_field (self, prop_id);
+        g_free (*field);
+        *field = g_value_dup_string (value);
+        break;
+    }
+    case PROP_SIGNAL_POLL_INTERVAL_MS:
+        poll_set_interval (self, POLL_GROUP_SIGNAL, g_value_get_uint (value));
+        if (!g_atomic_int_get (&self->priv->signal_info_indications))
+            g_object_notify_by_pspec (object, properties[PROP_SIGNAL_SAMPLE_INTERVAL_MS]);
+        break;
+    case PROP_POWER_POLL_INTERVAL_MS:
+        poll_set_interval (self, POLL_GROUP_POWER, g_value_get_uint (value));
+        break;
+    case PROP_NEIGHBOR_POLL_INTERVAL_MS:
+        poll_set_interval (self, POLL_GROUP_NEIGHBORS, g_value_get_uint (value));
+        break;
+    case PROP_TRAFFIC_POLL_INTERVAL_MS:
+        poll_set_interval (self, POLL_GROUP_TRAFFIC, g_value_get_uint (value));
+        break;
+    case PROP_CARRIER_POLL_INTERVAL_MS:
+        poll_set_interval (self, POLL_GROUP_CARRIERS, g_value_get_uint (value));
+        break;
+    case PROP_NETWORK_SCAN_INTERVAL:
+        network_scan_set_interval (self, g_value_get_uint (value));
+        break;
+    case PROP_FAST_REOPEN:
+        g_atomic_int_set (&self->priv->fast_reopen, g_value_get_boolean (value));
+        break;
+    case PROP_CLIENTS:
+        if (g_value_get_pointer (value))
+            self->priv->clients = *((const MrmDeviceClients *) g_value_get_pointer (value));
+        break;
     case PROP_QMI_DEVICE:
     case PROP_STATUS:
+    case PROP_CONNECTION:
+    case PROP_ACT:
+    case PROP_REGISTRATION_STATE:
+    case PROP_CYCLE_DURATION:
+    case PROP_INIT_DURATION:
+    case PROP_OVERRUN_TICKS:
+    case PROP_LATE_TICKS:
+    case PROP_PIN_STATUS_RETRIES:
+    case PROP_NETWORK_SCANNING:
         g_assert_not_reached ();
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1240,14 +5506,86 @@ get_property (GObject *object,
 
     switch (prop_id) {
     case PROP_FILE:
+        g_mutex_lock (&self->priv->lock);
         g_value_set_object (value, self->priv->file);
+        g_mutex_unlock (&self->priv->lock);
         break;
     case PROP_QMI_DEVICE:
         g_value_set_object (value, self->priv->qmi_device);
         break;
+    case PROP_BACKEND:
+        g_value_set_object (value, self->priv->backend);
+        break;
+    case PROP_MANUFACTURER:
+    case PROP_MODEL:
+    case PROP_REVISION:
+        g_value_set_string (value, *identity_field (self, prop_id));
+        break;
     case PROP_STATUS:
         g_value_set_enum (value, self->priv->status);
         break;
+    case PROP_CONNECTION:
+        g_value_set_enum (value, g_atomic_int_get (&self->priv->connection));
+        break;
+    case PROP_ACT:
+        g_value_set_flags (value, mrm_device_get_act (self));
+        break;
+    case PROP_REGISTRATION_STATE:
+        g_value_set_enum (value, mrm_device_get_registration_state (self));
+        break;
+    case PROP_CYCLE_DURATION:
+        g_mutex_lock (&self->priv->lock);
+        g_value_set_int64 (value, self->priv->cycle_duration);
+        g_mutex_unlock (&self->priv->lock);
+        break;
+    case PROP_INIT_DURATION:
+        g_value_set_int64 (value, self->priv->init_duration);
+        break;
+    case PROP_OVERRUN_TICKS:
+        g_mutex_lock (&self->priv->lock);
+        g_value_set_uint (value, self->priv->overrun_ticks);
+        g_mutex_unlock (&self->priv->lock);
+        break;
+    case PROP_LATE_TICKS:
+        g_mutex_lock (&self->priv->lock);
+        g_value_set_uint (value, self->priv->late_ticks);
+        g_mutex_unlock (&self->priv->lock);
+        break;
+    case PROP_PIN_STATUS_RETRIES:
+        g_mutex_lock (&self->priv->lock);
+        g_value_set_uint (value, self->priv->pin_status_retries);
+        g_mutex_unlock (&self->priv->lock);
+        break;
+    case PROP_SIGNAL_POLL_INTERVAL_MS:
+        g_value_set_uint (value, g_atomic_int_get (&self->priv->poll[POLL_GROUP_SIGNAL].interval_ms));
+        break;
+    case PROP_SIGNAL_SAMPLE_INTERVAL_MS:
+        if (g_atomic_int_get (&self->priv->signal_info_indications))
+            g_value_set_uint (value, MRM_DEVICE_SIGNAL_INDICATION_INTERVAL_MS);
+        else
+            g_value_set_uint (value, g_atomic_int_get (&self->priv->poll[POLL_GROUP_SIGNAL].interval_ms));
+        break;
+    case PROP_POWER_POLL_INTERVAL_MS:
+        g_value_set_uint (value, g_atomic_int_get (&self->priv->poll[POLL_GROUP_POWER].interval_ms));
+        break;
+    case PROP_NEIGHBOR_POLL_INTERVAL_MS:
+        g_value_set_uint (value, g_atomic_int_get (&self->priv->poll[POLL_GROUP_NEIGHBORS].interval_ms));
+        break;
+    case PROP_TRAFFIC_POLL_INTERVAL_MS:
+        g_value_set_uint (value, g_atomic_int_get (&self->priv->poll[POLL_GROUP_TRAFFIC].interval_ms));
+        break;
+    case PROP_CARRIER_POLL_INTERVAL_MS:
+        g_value_set_uint (value, g_atomic_int_get (&self->priv->poll[POLL_GROUP_CARRIERS].interval_ms));
+        break;
+    case PROP_NETWORK_SCAN_INTERVAL:
+        g_value_set_uint (value, g_atomic_int_get (&self->priv->network_scan_interval));
+        break;
+    case PROP_NETWORK_SCANNING:
+        g_value_set_boolean (value, g_atomic_int_get (&self->priv->network_scanning));
+        break;
+    case PROP_FAST_REOPEN:
+        g_value_set_boolean (value, g_atomic_int_get (&self->priv->fast_reopen));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1259,17 +5597,46 @@ mrm_device_init (MrmDevice *self)
 {
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MRM_TYPE_DEVICE, MrmDevicePrivate);
     self->priv->pin_attempts_left = -1; /* i.e., N/A */
+    self->priv->reconnect_delay_ms = MRM_DEVICE_RECONNECT_DELAY_MS_MIN;
+    self->priv->poll[POLL_GROUP_SIGNAL].interval_ms = MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT;
+    self->priv->poll[POLL_GROUP_POWER].interval_ms = MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT;
+    self->priv->poll[POLL_GROUP_NEIGHBORS].interval_ms = MRM_DEVICE_NEIGHBOR_POLL_INTERVAL_MS_DEFAULT;
+    self->priv->poll[POLL_GROUP_TRAFFIC].interval_ms = MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT;
+    self->priv->poll[POLL_GROUP_CARRIERS].interval_ms = MRM_DEVICE_CARRIER_POLL_INTERVAL_MS_DEFAULT;
+    traffic_counters_reset (self);
+
+    g_mutex_init (&self->priv->lock);
+    self->priv->queued_samples = g_array_new (FALSE, FALSE, sizeof (MrmSample));
+    self->priv->history = g_new (MrmSample, MRM_DEVICE_HISTORY_SIZE);
+    self->priv->queued_neighbor_deltas = g_ptr_array_new_with_free_func ((GDestroyNotify) mrm_neighbor_delta_free);
+    self->priv->neighbors = mrm_neighbor_list_new ();
+    self->priv->neighbors_main = mrm_neighbor_list_new ();
+    self->priv->queued_serving_cells = g_array_new (FALSE, FALSE, sizeof (MrmServingCell));
+    self->priv->serving_cell_log = g_new (MrmServingCell, MRM_DEVICE_SERVING_CELL_LOG_SIZE);
+    self->priv->queued_carrier_samples = g_ptr_array_new ();
+    self->priv->carrier_history = g_new0 (MrmCarrierSample *, MRM_DEVICE_HISTORY_SIZE);
+    mrm_serving_cell_init (&self->priv->serving_cell, 0);
+    self->priv->lte_serving_pci = MRM_SERVING_CELL_UNKNOWN;
+    self->priv->cancellable = g_cancellable_new ();
+    self->priv->main_context = g_main_context_ref_thread_default ();
+    worker_start (self);
 }
 
-static void
-dispose (GObject *object)
+/* Runs in the worker */
+static gboolean
+worker_teardown (MrmDevice *self)
 {
-    MrmDevice *self = MRM_DEVICE (object);
+    g_cancellable_cancel (self->priv->cancellable);
+    nas_cancellable_cancel (self);
+    self->priv->polling = FALSE;
+    reconnect_stop (self);
+    network_scan_stop (self);
+    request_flush (self);
 
     if (self->priv->dms) {
         qmi_device_release_client (self->priv->qmi_device,
                                    self->priv->dms,
-                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   client_release_prepare (self, MRM_DEVICE_CLIENT_DMS, FALSE),
                                    5,
                                    NULL,
                                    NULL,
@@ -1277,13 +5644,36 @@ dispose (GObject *object)
         g_clear_object (&self->priv->dms);
     }
 
+    if (self->priv->wds) {
+        qmi_device_release_client (self->priv->qmi_device,
+                                   self->priv->wds,
+                                   client_release_prepare (self, MRM_DEVICE_CLIENT_WDS, FALSE),
+                                   5,
+                                   NULL,
+                                   NULL,
+                                   NULL);
+        g_clear_object (&self->priv->wds);
+    }
+
+    poll_stop (self, POLL_GROUP_SIGNAL);
+    poll_stop (self, POLL_GROUP_POWER);
+    poll_stop (self, POLL_GROUP_NEIGHBORS);
+    poll_stop (self, POLL_GROUP_TRAFFIC);
+    poll_stop (self, POLL_GROUP_CARRIERS);
+
     if (self->priv->nas) {
-        g_source_remove (self->priv->info_updated_id);
-        self->priv->info_updated_id = 0;
+        if (self->priv->signal_info_indication_id) {
+            g_signal_handler_disconnect (self->priv->nas, self->priv->signal_info_indication_id);
+            self->priv->signal_info_indication_id = 0;
+        }
+        if (self->priv->serving_system_indication_id) {
+            g_signal_handler_disconnect (self->priv->nas, self->priv->serving_system_indication_id);
+            self->priv->serving_system_indication_id = 0;
+        }
 
         qmi_device_release_client (self->priv->qmi_device,
                                    self->priv->nas,
-                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   client_release_prepare (self, MRM_DEVICE_CLIENT_NAS, FALSE),
                                    5,
                                    NULL,
                                    NULL,
@@ -1291,11 +5681,35 @@ dispose (GObject *object)
         g_clear_object (&self->priv->nas);
     }
 
-    g_clear_object (&self->priv->file);
     if (self->priv->qmi_device)
         qmi_device_close (self->priv->qmi_device, NULL);
     g_clear_object (&self->priv->qmi_device);
 
+    g_main_loop_quit (self->priv->worker_loop);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+dispose (GObject *object)
+{
+    MrmDevice *self = MRM_DEVICE (object);
+
+    if (self->priv->worker) {
+        /* The last reference may be dropped by the worker itself, in which
+         * case it cannot wait for its own exit */
+        if (g_main_context_is_owner (self->priv->worker_context)) {
+            worker_teardown (self);
+            g_thread_unref (self->priv->worker);
+        } else {
+            worker_invoke (self, (GSourceFunc) worker_teardown, self);
+            g_thread_join (self->priv->worker);
+        }
+        self->priv->worker = NULL;
+    }
+
+    g_clear_object (&self->priv->file);
+    g_clear_object (&self->priv->backend);
+
     G_OBJECT_CLASS (mrm_device_parent_class)->dispose (object);
 }
 
@@ -1303,12 +5717,35 @@ static void
 finalize (GObject *object)
 {
     MrmDevice *self = MRM_DEVICE (object);
+    guint i;
 
     g_free (self->priv->name);
     g_free (self->priv->manufacturer);
     g_free (self->priv->model);
     g_free (self->priv->revision);
 
+    g_array_unref (self->priv->queued_samples);
+    g_free (self->priv->history);
+    g_ptr_array_unref (self->priv->queued_neighbor_deltas);
+    g_array_unref (self->priv->neighbors);
+    g_array_unref (self->priv->neighbors_main);
+    g_array_unref (self->priv->queued_serving_cells);
+    g_free (self->priv->serving_cell_log);
+    g_ptr_array_set_free_func (self->priv->queued_carrier_samples, (GDestroyNotify) mrm_carrier_sample_free);
+    g_ptr_array_unref (self->priv->queued_carrier_samples);
+    for (i = 0; i < self->priv->carrier_history_len; i++)
+        mrm_carrier_sample_free (self->priv->carrier_history[(self->priv->carrier_history_first + i) % MRM_DEVICE_HISTORY_SIZE]);
+    g_free (self->priv->carrier_history);
+    if (self->priv->queued_network_scan)
+        mrm_network_scan_free (self->priv->queued_network_scan);
+    if (self->priv->network_scan)
+        mrm_network_scan_free (self->priv->network_scan);
+    g_object_unref (self->priv->cancellable);
+    g_mutex_clear (&self->priv->lock);
+    g_main_loop_unref (self->priv->worker_loop);
+    g_main_context_unref (self->priv->worker_context);
+    g_main_context_unref (self->priv->main_context);
+
     G_OBJECT_CLASS (mrm_device_parent_class)->finalize (object);
 }
 
@@ -1347,6 +5784,38 @@ mrm_device_class_init (MrmDeviceClass *klass)
                              G_PARAM_READABLE);
     g_object_class_install_property (object_class, PROP_QMI_DEVICE, properties[PROP_QMI_DEVICE]);
 
+    properties[PROP_BACKEND] =
+        g_param_spec_object ("backend",
+                             "Backend",
+                             "Backend providing the samples instead of a QMI port",
+                             MRM_TYPE_DEVICE_BACKEND,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_BACKEND, properties[PROP_BACKEND]);
+
+    properties[PROP_MANUFACTURER] =
+        g_param_spec_string ("manufacturer",
+                             "Manufacturer",
+                             "Manufacturer of the modem, possibly cached from a previous run",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_MANUFACTURER, properties[PROP_MANUFACTURER]);
+
+    properties[PROP_MODEL] =
+        g_param_spec_string ("model",
+                             "Model",
+                             "Model of the modem, possibly cached from a previous run",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_MODEL, properties[PROP_MODEL]);
+
+    properties[PROP_REVISION] =
+        g_param_spec_string ("revision",
+                             "Revision",
+                             "Firmware revision of the modem, possibly cached from a previous run",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_REVISION, properties[PROP_REVISION]);
+
     properties[PROP_STATUS] =
         g_param_spec_enum ("status",
                            "Status",
@@ -1356,6 +5825,176 @@ mrm_device_class_init (MrmDeviceClass *klass)
                            G_PARAM_READABLE);
     g_object_class_install_property (object_class, PROP_STATUS, properties[PROP_STATUS]);
 
+    properties[PROP_CONNECTION] =
+        g_param_spec_enum ("connection",
+                           "Connection",
+                           "Whether the modem is connected, or being reconnected",
+                           MRM_TYPE_DEVICE_CONNECTION,
+                           MRM_DEVICE_CONNECTION_CONNECTED,
+                           G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_CONNECTION, properties[PROP_CONNECTION]);
+
+    properties[PROP_ACT] =
+        g_param_spec_flags ("act",
+                            "Access technologies",
+                            "Radio interfaces currently in use",
+                            MRM_TYPE_DEVICE_ACT,
+                            0,
+                            G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_ACT, properties[PROP_ACT]);
+
+    properties[PROP_REGISTRATION_STATE] =
+        g_param_spec_enum ("registration-state",
+                           "Registration state",
+                           "Registration state in the serving system",
+                           MRM_TYPE_DEVICE_REGISTRATION_STATE,
+                           MRM_DEVICE_REGISTRATION_STATE_UNKNOWN,
+                           G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_REGISTRATION_STATE, properties[PROP_REGISTRATION_STATE]);
+
+    properties[PROP_CYCLE_DURATION] =
+        g_param_spec_int64 ("cycle-duration",
+                            "Cycle duration",
+                            "Wall time of the last info reload cycle, in microseconds",
+                            0,
+                            G_MAXINT64,
+                            0,
+                            G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_CYCLE_DURATION, properties[PROP_CYCLE_DURATION]);
+
+    properties[PROP_INIT_DURATION] =
+        g_param_spec_int64 ("init-duration",
+                            "Init duration",
+                            "Wall time from starting initialization until the device was ready, in microseconds",
+                            0,
+                            G_MAXINT64,
+                            0,
+                            G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_INIT_DURATION, properties[PROP_INIT_DURATION]);
+
+    properties[PROP_OVERRUN_TICKS] =
+        g_param_spec_uint ("overrun-ticks",
+                           "Overrun ticks",
+                           "Number of poll ticks skipped because the previous cycle was still ongoing",
+                           0,
+                           G_MAXUINT,
+                           0,
+                           G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_OVERRUN_TICKS, properties[PROP_OVERRUN_TICKS]);
+
+    properties[PROP_LATE_TICKS] =
+        g_param_spec_uint ("late-ticks",
+                           "Late ticks",
+                           "Number of poll ticks skipped because their deadline had already passed",
+                           0,
+                           G_MAXUINT,
+                           0,
+                           G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_LATE_TICKS, properties[PROP_LATE_TICKS]);
+
+    properties[PROP_PIN_STATUS_RETRIES] =
+        g_param_spec_uint ("pin-status-retries",
+                           "PIN status retries",
+                           "Number of PIN status requests retried because the modem wasn't ready to reply",
+                           0,
+                           G_MAXUINT,
+                           0,
+                           G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_PIN_STATUS_RETRIES, properties[PROP_PIN_STATUS_RETRIES]);
+
+    properties[PROP_SIGNAL_POLL_INTERVAL_MS] =
+        g_param_spec_uint ("signal-poll-interval-ms",
+                           "Signal poll interval",
+                           "Interval between signal info samples, in milliseconds",
+                           MRM_DEVICE_POLL_INTERVAL_MS_MIN,
+                           MRM_DEVICE_POLL_INTERVAL_MS_MAX,
+                           MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_SIGNAL_POLL_INTERVAL_MS, properties[PROP_SIGNAL_POLL_INTERVAL_MS]);
+
+    properties[PROP_POWER_POLL_INTERVAL_MS] =
+        g_param_spec_uint ("power-poll-interval-ms",
+                           "Power poll interval",
+                           "Interval between tx/rx power info samples, in milliseconds",
+                           MRM_DEVICE_POLL_INTERVAL_MS_MIN,
+                           MRM_DEVICE_POLL_INTERVAL_MS_MAX,
+                           MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_POWER_POLL_INTERVAL_MS, properties[PROP_POWER_POLL_INTERVAL_MS]);
+
+    properties[PROP_NEIGHBOR_POLL_INTERVAL_MS] =
+        g_param_spec_uint ("neighbor-poll-interval-ms",
+                           "Neighbor poll interval",
+                           "Interval between neighbor cell list samples, in milliseconds",
+                           MRM_DEVICE_POLL_INTERVAL_MS_MIN,
+                           MRM_DEVICE_POLL_INTERVAL_MS_MAX,
+                           MRM_DEVICE_NEIGHBOR_POLL_INTERVAL_MS_DEFAULT,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_NEIGHBOR_POLL_INTERVAL_MS, properties[PROP_NEIGHBOR_POLL_INTERVAL_MS]);
+
+    properties[PROP_TRAFFIC_POLL_INTERVAL_MS] =
+        g_param_spec_uint ("traffic-poll-interval-ms",
+                           "Traffic poll interval",
+                           "Interval between packet statistics samples, in milliseconds",
+                           MRM_DEVICE_POLL_INTERVAL_MS_MIN,
+                           MRM_DEVICE_POLL_INTERVAL_MS_MAX,
+                           MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_TRAFFIC_POLL_INTERVAL_MS, properties[PROP_TRAFFIC_POLL_INTERVAL_MS]);
+
+    properties[PROP_CARRIER_POLL_INTERVAL_MS] =
+        g_param_spec_uint ("carrier-poll-interval-ms",
+                           "Carrier poll interval",
+                           "Interval between LTE component carrier samples, in milliseconds",
+                           MRM_DEVICE_POLL_INTERVAL_MS_MIN,
+                           MRM_DEVICE_POLL_INTERVAL_MS_MAX,
+                           MRM_DEVICE_CARRIER_POLL_INTERVAL_MS_DEFAULT,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_CARRIER_POLL_INTERVAL_MS, properties[PROP_CARRIER_POLL_INTERVAL_MS]);
+
+    properties[PROP_SIGNAL_SAMPLE_INTERVAL_MS] =
+        g_param_spec_uint ("signal-sample-interval-ms",
+                           "Signal sample interval",
+                           "Nominal interval between signal info samples, polled or reported via indications, in milliseconds",
+                           0,
+                           G_MAXUINT,
+                           MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT,
+                           G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_SIGNAL_SAMPLE_INTERVAL_MS, properties[PROP_SIGNAL_SAMPLE_INTERVAL_MS]);
+
+    properties[PROP_NETWORK_SCAN_INTERVAL] =
+        g_param_spec_uint ("network-scan-interval",
+                           "Network scan interval",
+                           "Interval between periodic network scans, in seconds; or 0 if disabled",
+                           0,
+                           MRM_DEVICE_NETWORK_SCAN_INTERVAL_MAX,
+                           MRM_DEVICE_NETWORK_SCAN_INTERVAL_DEFAULT,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_NETWORK_SCAN_INTERVAL, properties[PROP_NETWORK_SCAN_INTERVAL]);
+
+    properties[PROP_NETWORK_SCANNING] =
+        g_param_spec_boolean ("network-scanning",
+                              "Network scanning",
+                              "Whether a network scan is in progress",
+                              FALSE,
+                              G_PARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_NETWORK_SCANNING, properties[PROP_NETWORK_SCANNING]);
+
+    properties[PROP_FAST_REOPEN] =
+        g_param_spec_boolean ("fast-reopen",
+                              "Fast reopen",
+                              "Whether QMI clients are kept allocated on close, to be reused",
+                              FALSE,
+                              G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_FAST_REOPEN, properties[PROP_FAST_REOPEN]);
+
+    properties[PROP_CLIENTS] =
+        g_param_spec_pointer ("clients",
+                              "Clients",
+                              "QMI clients persisted from a previous run, as a MrmDeviceClients",
+                              G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_CLIENTS, properties[PROP_CLIENTS]);
+
     signals[SIGNAL_ACT_UPDATED] =
         g_signal_new ("act-updated",
                       G_OBJECT_CLASS_TYPE (object_class),
@@ -1363,136 +6002,72 @@ mrm_device_class_init (MrmDeviceClass *klass)
                       G_STRUCT_OFFSET (MrmDeviceClass, act_updated),
                       NULL, NULL,
                       g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
+                      G_TYPE_NONE,
                       1,
                       MRM_TYPE_DEVICE_ACT);
 
-
-    signals[SIGNAL_RSSI_UPDATED] =
-        g_signal_new ("rssi-updated",
-                      G_OBJECT_CLASS_TYPE (object_class),
-                      G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, rssi_updated),
-                      NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
-                      5,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE);
-
-    signals[SIGNAL_ECIO_UPDATED] =
-        g_signal_new ("ecio-updated",
-                      G_OBJECT_CLASS_TYPE (object_class),
-                      G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, ecio_updated),
-                      NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
-                      3,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE);
-
-    signals[SIGNAL_SINR_LEVEL_UPDATED] =
-        g_signal_new ("sinr-level-updated",
+    signals[SIGNAL_SAMPLE] =
+        g_signal_new ("sample",
                       G_OBJECT_CLASS_TYPE (object_class),
                       G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, sinr_level_updated),
+                      G_STRUCT_OFFSET (MrmDeviceClass, sample),
                       NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
+                      g_cclosure_marshal_VOID__BOXED,
+                      G_TYPE_NONE,
                       1,
-                      G_TYPE_DOUBLE);
+                      MRM_TYPE_SAMPLE | G_SIGNAL_TYPE_STATIC_SCOPE);
 
-    signals[SIGNAL_IO_UPDATED] =
-        g_signal_new ("io-updated",
+    signals[SIGNAL_NEIGHBORS] =
+        g_signal_new ("neighbors",
                       G_OBJECT_CLASS_TYPE (object_class),
                       G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, io_updated),
+                      G_STRUCT_OFFSET (MrmDeviceClass, neighbors),
                       NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
+                      g_cclosure_marshal_VOID__BOXED,
+                      G_TYPE_NONE,
                       1,
-                      G_TYPE_DOUBLE);
+                      MRM_TYPE_NEIGHBOR_DELTA | G_SIGNAL_TYPE_STATIC_SCOPE);
 
-    signals[SIGNAL_RSRQ_UPDATED] =
-        g_signal_new ("rsrq-updated",
+    signals[SIGNAL_SERVING_CELL_CHANGED] =
+        g_signal_new ("serving-cell-changed",
                       G_OBJECT_CLASS_TYPE (object_class),
                       G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, rsrq_updated),
+                      G_STRUCT_OFFSET (MrmDeviceClass, serving_cell_changed),
                       NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
+                      g_cclosure_marshal_VOID__BOXED,
+                      G_TYPE_NONE,
                       1,
-                      G_TYPE_DOUBLE);
+                      MRM_TYPE_SERVING_CELL | G_SIGNAL_TYPE_STATIC_SCOPE);
 
-    signals[SIGNAL_RSRP_UPDATED] =
-        g_signal_new ("rsrp-updated",
+    signals[SIGNAL_CARRIERS] =
+        g_signal_new ("carriers",
                       G_OBJECT_CLASS_TYPE (object_class),
                       G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, rsrp_updated),
+                      G_STRUCT_OFFSET (MrmDeviceClass, carriers),
                       NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
+                      g_cclosure_marshal_VOID__BOXED,
+                      G_TYPE_NONE,
                       1,
-                      G_TYPE_DOUBLE);
+                      MRM_TYPE_CARRIER_SAMPLE | G_SIGNAL_TYPE_STATIC_SCOPE);
 
-    signals[SIGNAL_SNR_UPDATED] =
-        g_signal_new ("snr-updated",
+    signals[SIGNAL_NETWORK_SCAN] =
+        g_signal_new ("network-scan",
                       G_OBJECT_CLASS_TYPE (object_class),
                       G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, snr_updated),
+                      G_STRUCT_OFFSET (MrmDeviceClass, network_scan),
                       NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
+                      g_cclosure_marshal_VOID__BOXED,
+                      G_TYPE_NONE,
                       1,
-                      G_TYPE_DOUBLE);
+                      MRM_TYPE_NETWORK_SCAN | G_SIGNAL_TYPE_STATIC_SCOPE);
 
-    signals[SIGNAL_RX0_UPDATED] =
-        g_signal_new ("rx0-updated",
-                      G_OBJECT_CLASS_TYPE (object_class),
-                      G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, rx0_updated),
-                      NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
-                      5,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE);
-
-    signals[SIGNAL_RX1_UPDATED] =
-        g_signal_new ("rx1-updated",
-                      G_OBJECT_CLASS_TYPE (object_class),
-                      G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, rx1_updated),
-                      NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
-                      5,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE);
-
-    signals[SIGNAL_TX_UPDATED] =
-        g_signal_new ("tx-updated",
+    signals[SIGNAL_CLIENTS_UPDATED] =
+        g_signal_new ("clients-updated",
                       G_OBJECT_CLASS_TYPE (object_class),
                       G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (MrmDeviceClass, tx_updated),
+                      G_STRUCT_OFFSET (MrmDeviceClass, clients_updated),
                       NULL, NULL,
-                      g_cclosure_marshal_generic,
-					  G_TYPE_NONE,
-                      5,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE,
-                      G_TYPE_DOUBLE);
+                      g_cclosure_marshal_VOID__VOID,
+                      G_TYPE_NONE,
+                      0);
 }
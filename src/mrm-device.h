@@ -19,6 +19,13 @@
 #include <gtk/gtk.h>
 #include <libqmi-glib.h>
 
+#include "mrm-sample.h"
+#include "mrm-neighbor.h"
+#include "mrm-serving-cell.h"
+#include "mrm-carrier.h"
+#include "mrm-network.h"
+#include "mrm-device-backend.h"
+
 G_BEGIN_DECLS
 
 #define MRM_TYPE_DEVICE         (mrm_device_get_type ())
@@ -36,14 +43,116 @@ typedef enum {
     MRM_DEVICE_STATUS_SIM_ERROR,
 } MrmDeviceStatus;
 
+typedef enum {
+    MRM_DEVICE_CONNECTION_CONNECTED,
+    MRM_DEVICE_CONNECTION_DISCONNECTED,
+    MRM_DEVICE_CONNECTION_RECONNECTING,
+} MrmDeviceConnection;
+
 typedef enum {
     MRM_DEVICE_ACT_GSM  = 1 << 0,
     MRM_DEVICE_ACT_UMTS = 1 << 1,
     MRM_DEVICE_ACT_LTE  = 1 << 2,
     MRM_DEVICE_ACT_CDMA = 1 << 3,
     MRM_DEVICE_ACT_EVDO = 1 << 4,
+    MRM_DEVICE_ACT_NR5G = 1 << 5,
 } MrmDeviceAct;
 
+typedef enum {
+    MRM_DEVICE_REGISTRATION_STATE_UNKNOWN,
+    MRM_DEVICE_REGISTRATION_STATE_IDLE,
+    MRM_DEVICE_REGISTRATION_STATE_REGISTERED,
+    MRM_DEVICE_REGISTRATION_STATE_SEARCHING,
+    MRM_DEVICE_REGISTRATION_STATE_DENIED,
+} MrmDeviceRegistrationState;
+
+/* Limits of the configurable poll intervals, in milliseconds */
+#define MRM_DEVICE_POLL_INTERVAL_MS_MIN     100
+#define MRM_DEVICE_POLL_INTERVAL_MS_MAX     60000
+#define MRM_DEVICE_POLL_INTERVAL_MS_DEFAULT 1000
+
+/* Neighbor lists are larger and change slowly, so they're loaded less often */
+#define MRM_DEVICE_NEIGHBOR_POLL_INTERVAL_MS_DEFAULT 5000
+
+/* And so do component carriers, which also need a neighbor list for the
+ * signal of their secondary cells */
+#define MRM_DEVICE_CARRIER_POLL_INTERVAL_MS_DEFAULT 5000
+
+/* Nominal interval between signal samples reported via indications, which
+ * come whenever the signal changes instead of on a fixed schedule */
+#define MRM_DEVICE_SIGNAL_INDICATION_INTERVAL_MS 1000
+
+/* Limits of the interval between periodic network scans, in seconds; 0
+ * disables them. Scans interrupt the service of the modem for a while, so
+ * they are only run periodically if the user asks for it */
+#define MRM_DEVICE_NETWORK_SCAN_INTERVAL_MIN     60
+#define MRM_DEVICE_NETWORK_SCAN_INTERVAL_MAX     3600
+#define MRM_DEVICE_NETWORK_SCAN_INTERVAL_DEFAULT 0
+
+/* Limits of the delay between reconnection attempts, in milliseconds; it is
+ * doubled after each failed attempt */
+#define MRM_DEVICE_RECONNECT_DELAY_MS_MIN 1000
+#define MRM_DEVICE_RECONNECT_DELAY_MS_MAX 30000
+
+/* Number of most recent samples kept by each device */
+#define MRM_DEVICE_HISTORY_SIZE 256
+
+/* Number of most recent serving cell changes kept by each device */
+#define MRM_DEVICE_SERVING_CELL_LOG_SIZE 64
+
+/**
+ * MrmDeviceTimingStats:
+ * @n_samples: number of measurements taken.
+ * @last: last measurement, in microseconds.
+ * @min: minimum measurement, in microseconds.
+ * @max: maximum measurement, in microseconds.
+ * @mean: mean of all measurements, in microseconds.
+ * @stddev: standard deviation of all measurements, in microseconds.
+ */
+typedef struct {
+    guint n_samples;
+    gint64 last;
+    gint64 min;
+    gint64 max;
+    gdouble mean;
+    gdouble stddev;
+} MrmDeviceTimingStats;
+
+/* QMI clients that may be kept allocated across close */
+typedef enum {
+    MRM_DEVICE_CLIENT_DMS,
+    MRM_DEVICE_CLIENT_NAS,
+    MRM_DEVICE_CLIENT_WDS,
+    MRM_DEVICE_N_CLIENTS
+} MrmDeviceClient;
+
+/**
+ * MrmDeviceClientInfo:
+ * @cid: client ID, or %QMI_CID_NONE if not allocated.
+ * @version_major: major version of the service, or 0 if unknown.
+ * @version_minor: minor version of the service.
+ */
+typedef struct {
+    guint8 cid;
+    guint version_major;
+    guint version_minor;
+} MrmDeviceClientInfo;
+
+/**
+ * MrmDeviceClients:
+ * @clients: a #MrmDeviceClientInfo for each #MrmDeviceClient.
+ * @full_open_duration: time it took to open the device and allocate its DMS
+ *  client the last time it was done from scratch, in microseconds; or 0 if
+ *  unknown.
+ *
+ * The QMI clients of a device in fast reopen mode, to be persisted so that
+ * they are reused the next time the device is opened.
+ */
+typedef struct {
+    MrmDeviceClientInfo clients[MRM_DEVICE_N_CLIENTS];
+    gint64 full_open_duration;
+} MrmDeviceClients;
+
 typedef struct _MrmDevice        MrmDevice;
 typedef struct _MrmDeviceClass   MrmDeviceClass;
 typedef struct _MrmDevicePrivate MrmDevicePrivate;
@@ -60,54 +169,17 @@ struct _MrmDeviceClass {
 
     void (*act_updated) (MrmDevice *device,
                          MrmDeviceAct act);
-
-    void (*rssi_updated) (MrmDevice *device,
-                          gdouble gsm_rssi,
-                          gdouble umts_rssi,
-                          gdouble lte_rssi,
-                          gdouble cdma_rssi,
-                          gdouble evdo_rssi);
-
-    void (*ecio_updated) (MrmDevice *device,
-                          gdouble umts_ecio,
-                          gdouble cdma_ecio,
-                          gdouble evdo_ecio);
-
-    void (*sinr_level_updated) (MrmDevice *device,
-                                gdouble evdo_sinr_level);
-
-    void (*io_updated) (MrmDevice *device,
-                        gdouble evdo_io);
-
-    void (*rsrq_updated) (MrmDevice *device,
-                          gdouble lte_rsrq);
-
-    void (*rsrp_updated) (MrmDevice *device,
-                          gdouble lte_rsrp);
-
-    void (*snr_updated) (MrmDevice *device,
-                         gdouble lte_snr);
-
-    void (*rx0_updated) (MrmDevice *device,
-                         gdouble gsm_rx0,
-                         gdouble umts_rx0,
-                         gdouble lte_rx0,
-                         gdouble cdma_rx0,
-                         gdouble evdo_rx0);
-
-    void (*rx1_updated) (MrmDevice *device,
-                         gdouble gsm_rx1,
-                         gdouble umts_rx1,
-                         gdouble lte_rx1,
-                         gdouble cdma_rx1,
-                         gdouble evdo_rx1);
-
-    void (*tx_updated) (MrmDevice *device,
-                         gdouble gsm_tx,
-                         gdouble umts_tx,
-                         gdouble lte_tx,
-                         gdouble cdma_tx,
-                         gdouble evdo_tx);
+    void (*sample)      (MrmDevice *device,
+                         const MrmSample *sample);
+    void (*neighbors)   (MrmDevice *device,
+                         const MrmNeighborDelta *delta);
+    void (*serving_cell_changed) (MrmDevice *device,
+                                  const MrmServingCell *serving_cell);
+    void (*carriers)    (MrmDevice *device,
+                         const MrmCarrierSample *carrier_sample);
+    void (*clients_updated) (MrmDevice *device);
+    void (*network_scan) (MrmDevice *device,
+                          const MrmNetworkScan *scan);
 };
 
 GType mrm_device_get_type (void) G_GNUC_CONST;
@@ -116,6 +188,25 @@ void       mrm_device_new        (GFile *file,
                                   GCancellable *cancellable,
                                   GAsyncReadyCallback callback,
                                   gpointer user_data);
+void       mrm_device_new_with_identity (GFile *file,
+                                         const gchar *manufacturer,
+                                         const gchar *model,
+                                         const gchar *revision,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data);
+void       mrm_device_new_full   (GFile *file,
+                                  const gchar *manufacturer,
+                                  const gchar *model,
+                                  const gchar *revision,
+                                  const MrmDeviceClients *clients,
+                                  GCancellable *cancellable,
+                                  GAsyncReadyCallback callback,
+                                  gpointer user_data);
+void       mrm_device_new_with_backend (MrmDeviceBackend *backend,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
 MrmDevice *mrm_device_new_finish (GAsyncResult *res,
                                   GError **error);
 
@@ -125,7 +216,44 @@ const gchar     *mrm_device_get_model        (MrmDevice *self);
 const gchar     *mrm_device_get_revision     (MrmDevice *self);
 MrmDeviceStatus  mrm_device_get_status       (MrmDevice *self);
 
-QmiDevice       *mrm_device_peek_qmi_device  (MrmDevice *self);
+MrmDeviceConnection mrm_device_get_connection (MrmDevice *self);
+void                mrm_device_disconnect     (MrmDevice *self);
+void                mrm_device_reconnect      (MrmDevice *self,
+                                               GFile *file);
+
+MrmDeviceAct               mrm_device_get_act                (MrmDevice *self);
+MrmDeviceRegistrationState mrm_device_get_registration_state (MrmDevice *self);
+
+QmiDevice        *mrm_device_peek_qmi_device (MrmDevice *self);
+MrmDeviceBackend *mrm_device_peek_backend    (MrmDevice *self);
+
+gint64 mrm_device_get_init_duration (MrmDevice *self);
+
+gboolean mrm_device_get_fast_reopen (MrmDevice *self);
+void     mrm_device_set_fast_reopen (MrmDevice *self,
+                                     gboolean fast_reopen);
+void     mrm_device_get_clients     (MrmDevice *self,
+                                     MrmDeviceClients *clients);
+
+GArray *mrm_device_dup_history   (MrmDevice *self);
+GArray *mrm_device_dup_neighbors (MrmDevice *self);
+GArray *mrm_device_dup_serving_cell_log (MrmDevice *self);
+GPtrArray *mrm_device_dup_carrier_history (MrmDevice *self);
+MrmNetworkScan *mrm_device_dup_network_scan (MrmDevice *self);
+
+void mrm_device_subscribe   (MrmDevice *self,
+                             guint groups);
+void mrm_device_unsubscribe (MrmDevice *self,
+                             guint groups);
+
+void mrm_device_set_poll_slot (MrmDevice *self,
+                               guint slot,
+                               guint n_slots);
+
+void mrm_device_get_rtt_stats    (MrmDevice *self,
+                                  MrmDeviceTimingStats *stats);
+void mrm_device_get_jitter_stats (MrmDevice *self,
+                                  MrmDeviceTimingStats *stats);
 
 void     mrm_device_unlock        (MrmDevice *self,
                                    const gchar *pin,
@@ -135,6 +263,14 @@ gboolean mrm_device_unlock_finish (MrmDevice *self,
                                    GAsyncResult *res,
                                    GError **error);
 
+gboolean mrm_device_get_network_scanning (MrmDevice *self);
+void     mrm_device_scan_networks        (MrmDevice *self,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+gboolean mrm_device_scan_networks_finish (MrmDevice *self,
+                                          GAsyncResult *res,
+                                          GError **error);
+
 void     mrm_device_start_nas        (MrmDevice *self,
                                       GAsyncReadyCallback callback,
                                       gpointer user_data);
@@ -21,6 +21,7 @@
 #include "mrm-color-icon.h"
 
 #include <math.h>
+#include <string.h>
 
 /* Number of points to show in the graph */
 #define NUM_POINTS 61
@@ -44,6 +45,9 @@
 /* Bottom label vertical margin */
 #define BOTTOM_LABEL_MARGIN 15
 
+/* Maximum number of markers kept; older ones are dropped */
+#define MAX_MARKERS 16
+
 G_DEFINE_TYPE (MrmGraph, mrm_graph, GTK_TYPE_BOX)
 
 enum {
@@ -55,6 +59,7 @@ enum {
     PROP_Y_N_SEPARATORS,
     PROP_TITLE,
     PROP_LEGEND_POSITION,
+    PROP_STEP_DURATION_MS,
     PROP_LAST
 };
 
@@ -70,6 +75,11 @@ typedef struct {
     GtkWidget *box_value;
 } Series;
 
+typedef struct {
+    gint64 timestamp;
+    gchar *text;
+} Marker;
+
 struct _MrmGraphPrivate {
     /* Properties */
     guint    n_series;
@@ -79,6 +89,7 @@ struct _MrmGraphPrivate {
     guint    y_n_separators;
     gchar   *title;
     MrmGraphLegendPosition legend_position;
+    guint    step_duration_ms;
 
     /* The series data block */
     Series *series;
@@ -86,6 +97,17 @@ struct _MrmGraphPrivate {
     /* The current step index */
     guint step_index;
 
+    /* Monotonic time of each step, shared by all series */
+    gint64 timestamps[NUM_POINTS];
+
+    /* Steps where sampling was interrupted; lines aren't drawn across them */
+    gboolean gaps[NUM_POINTS];
+
+    /* Vertical markers, oldest first in the ring */
+    Marker markers[MAX_MARKERS];
+    guint markers_first;
+    guint n_markers;
+
     /* Graph title label */
     GtkWidget *title_label;
 
@@ -163,6 +185,24 @@ allocate_series (MrmGraph *self)
         mrm_graph_clear_series (self, i);
 }
 
+/* Grows the series block as needed, keeping the existing series */
+void
+mrm_graph_ensure_series (MrmGraph *self,
+                         guint n_series)
+{
+    guint i;
+
+    if (n_series <= self->priv->n_series)
+        return;
+
+    self->priv->series = g_renew (Series, self->priv->series, n_series);
+    memset (&self->priv->series[self->priv->n_series], 0, (n_series - self->priv->n_series) * sizeof (Series));
+    for (i = self->priv->n_series; i < n_series; i++)
+        mrm_graph_clear_series (self, i);
+    self->priv->n_series = n_series;
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_SERIES]);
+}
+
 void
 mrm_graph_setup_series (MrmGraph *self,
                         guint series_index,
@@ -203,10 +243,13 @@ mrm_graph_setup_series (MrmGraph *self,
 /* Adding new values to the series */
 
 void
-mrm_graph_step_init (MrmGraph *self)
+mrm_graph_step_init (MrmGraph *self,
+                     gint64 timestamp)
 {
     guint i;
 
+    self->priv->timestamps[self->priv->step_index] = timestamp;
+    self->priv->gaps[self->priv->step_index] = FALSE;
     for (i = 0; i < self->priv->n_series; i++)
         self->priv->series[i].data[self->priv->step_index] = -G_MAXDOUBLE;
 }
@@ -255,6 +298,63 @@ mrm_graph_step_finish (MrmGraph *self)
     gtk_widget_queue_draw (self->priv->drawing_area);
 }
 
+/* Flags the last finished step as a gap, e.g. while the device was
+ * disconnected, so that it isn't bridged by the series lines */
+void
+mrm_graph_mark_gap (MrmGraph *self)
+{
+    guint last_step_index;
+
+    last_step_index = (self->priv->step_index == 0 ? NUM_POINTS - 1 : self->priv->step_index - 1);
+    self->priv->gaps[last_step_index] = TRUE;
+
+    gtk_widget_queue_draw (self->priv->drawing_area);
+}
+
+/*****************************************************************************/
+/* Markers */
+
+static void
+free_markers (MrmGraph *self)
+{
+    guint i;
+
+    for (i = 0; i < MAX_MARKERS; i++) {
+        g_free (self->priv->markers[i].text);
+        self->priv->markers[i].text = NULL;
+    }
+    self->priv->markers_first = 0;
+    self->priv->n_markers = 0;
+}
+
+void
+mrm_graph_add_marker (MrmGraph *self,
+                      gint64 timestamp,
+                      const gchar *label)
+{
+    Marker *marker;
+
+    if (self->priv->n_markers < MAX_MARKERS)
+        marker = &self->priv->markers[(self->priv->markers_first + self->priv->n_markers++) % MAX_MARKERS];
+    else {
+        marker = &self->priv->markers[self->priv->markers_first];
+        self->priv->markers_first = (self->priv->markers_first + 1) % MAX_MARKERS;
+        g_free (marker->text);
+    }
+
+    marker->timestamp = timestamp;
+    marker->text = g_strdup (label);
+
+    gtk_widget_queue_draw (self->priv->drawing_area);
+}
+
+void
+mrm_graph_clear_markers (MrmGraph *self)
+{
+    free_markers (self);
+    gtk_widget_queue_draw (self->priv->drawing_area);
+}
+
 /*****************************************************************************/
 /* Graph background management */
 
@@ -380,7 +480,8 @@ graph_background_pattern_create (MrmGraph *self)
         cairo_stroke (cr);
 
         /* Draw caption */
-        caption = g_strdup_printf (i == 0 ? "%u seconds" : "%u", i * 10);
+        caption = g_strdup_printf (i == 0 ? "%g seconds" : "%g",
+                                   (gdouble) (i * ((NUM_POINTS - 1) / N_HORIZONTAL_SEPARATORS) * self->priv->step_duration_ms) / 1000.0);
         pango_layout_set_text (layout, caption, -1);
         pango_layout_get_extents (layout, NULL, &extents);
         cairo_move_to (cr,
@@ -423,6 +524,77 @@ graph_configure (GtkWidget *widget,
 /*****************************************************************************/
 /* Graph draw */
 
+/* Horizontal distance between the current step and a previous one, measured
+ * in steps of the configured duration. Falls back to the number of steps if
+ * either of them has no timestamp. */
+static gdouble
+graph_step_offset (MrmGraph *self,
+                   guint current,
+                   guint previous,
+                   guint n_steps)
+{
+    if (!self->priv->timestamps[current] || !self->priv->timestamps[previous])
+        return (gdouble) n_steps;
+
+    return ((gdouble) (self->priv->timestamps[current] - self->priv->timestamps[previous])) /
+           (1000.0 * self->priv->step_duration_ms);
+}
+
+/* Markers are placed by their time relative to the current step */
+static void
+graph_draw_markers (MrmGraph *self,
+                    cairo_t *cr,
+                    guint current_step_index,
+                    gdouble x_ratio)
+{
+    static const gdouble dash[] = { 4.0, 2.0 };
+    PangoLayout *layout = NULL;
+    guint i;
+
+    if (!self->priv->n_markers || !self->priv->timestamps[current_step_index])
+        return;
+
+    cairo_save (cr);
+    cairo_set_dash (cr, dash, 2, 0);
+    cairo_set_source_rgba (cr, 0.3, 0.3, 0.3, 0.9);
+
+    for (i = 0; i < self->priv->n_markers; i++) {
+        Marker *marker;
+        gdouble offset;
+        gdouble x;
+
+        marker = &self->priv->markers[(self->priv->markers_first + i) % MAX_MARKERS];
+        offset = ((gdouble) (self->priv->timestamps[current_step_index] - marker->timestamp)) /
+                 (1000.0 * self->priv->step_duration_ms);
+        if (offset > (gdouble)(NUM_POINTS - 1))
+            continue;
+
+        x = floor (self->priv->plot_area_offset_x0 + MAX (offset, 0.0) * x_ratio) + 0.5;
+        cairo_move_to (cr, x, self->priv->plot_area_offset_y0 - self->priv->plot_area_height);
+        cairo_line_to (cr, x, self->priv->plot_area_offset_y0);
+        cairo_stroke (cr);
+
+        if (marker->text) {
+            if (!layout) {
+                PangoFontDescription *font_desc;
+
+                layout = pango_cairo_create_layout (cr);
+                font_desc = pango_font_description_new ();
+                pango_font_description_set_size (font_desc, FONTSIZE * PANGO_SCALE);
+                pango_layout_set_font_description (layout, font_desc);
+                pango_font_description_free (font_desc);
+            }
+            pango_layout_set_text (layout, marker->text, -1);
+            cairo_move_to (cr, x + 2.0, self->priv->plot_area_offset_y0 - self->priv->plot_area_height + 1.0);
+            pango_cairo_show_layout (cr, layout);
+        }
+    }
+
+    if (layout)
+        g_object_unref (layout);
+    cairo_restore (cr);
+}
+
 static gboolean
 graph_draw (GtkWidget *widget,
             cairo_t *context,
@@ -470,7 +642,10 @@ graph_draw (GtkWidget *widget,
     /* Print series */
     for (i = 0; i < self->priv->n_series; i++) {
         guint j;
-        guint seconds;
+        guint steps;
+        gboolean pen_up;
+        gdouble offset;
+        gdouble next_offset;
         gdouble x1;
         gdouble y1;
         gdouble x2;
@@ -488,29 +663,52 @@ graph_draw (GtkWidget *widget,
         cairo_move_to (cr,
                        self->priv->plot_area_offset_x0 - x3,
                        self->priv->plot_area_offset_y0 - y3);
+        pen_up = self->priv->gaps[current_step_index];
 
-        seconds = 0;
+        steps = 0;
+        offset = 0.0;
         j = current_step_index;
         do {
+            /* Offset of the newer neighbour, used for the control points */
+            next_offset = offset;
 
-
-            seconds++;
+            steps++;
             if (j == 0)
                 j = NUM_POINTS - 1;
             else
                 j--;
 
+            offset = graph_step_offset (self, current_step_index, j, steps);
+
+            /* Points older than the displayed time span are clipped away */
+            if (offset > (gdouble)(NUM_POINTS - 1) + 1.0)
+                break;
+
+            /* The line starts over at the first value before a gap */
+            if (self->priv->gaps[j]) {
+                pen_up = TRUE;
+                continue;
+            }
+
             if (self->priv->series[i].data[j] < self->priv->y_min)
                 continue;
 
-            /* Convert the previous (seconds,value) to the corresponding amount of pixels */
-            x3 = seconds * x_ratio;
+            /* Convert the previous (time,value) to the corresponding amount of pixels */
+            x3 = offset * x_ratio;
             y3 = (self->priv->series[i].data[j] - self->priv->y_min) * y_ratio;
 
+            if (pen_up) {
+                cairo_move_to (cr,
+                               self->priv->plot_area_offset_x0 + x3,
+                               self->priv->plot_area_offset_y0 - y3);
+                pen_up = FALSE;
+                continue;
+            }
+
             /* Additional control points for the bezier spline */
-            x1 = ((gdouble)seconds - 1.0f + 0.5f) * x_ratio;
+            x1 = ((next_offset + offset) / 2.0) * x_ratio;
             y1 = (self->priv->series[i].data[j == (NUM_POINTS - 1) ? 0 : j + 1] - self->priv->y_min) * y_ratio;
-            x2 = ((gdouble)seconds - 0.5f) * x_ratio;
+            x2 = ((next_offset + offset) / 2.0) * x_ratio;
             y2 = (self->priv->series[i].data[j] - self->priv->y_min) * y_ratio;
 
             cairo_curve_to (cr,
@@ -526,6 +724,8 @@ graph_draw (GtkWidget *widget,
         cairo_stroke (cr);
     }
 
+    graph_draw_markers (self, cr, current_step_index, x_ratio);
+
     cairo_destroy (cr);
 
     return TRUE;
@@ -576,6 +776,7 @@ mrm_graph_init (MrmGraph *self)
     self->priv->y_max = 100.0;
     self->priv->y_units = g_strdup ("%");
     self->priv->y_n_separators = 5;
+    self->priv->step_duration_ms = 1000;
     self->priv->legend_position = MRM_GRAPH_LEGEND_POSITION_BOTTOM;
 }
 
@@ -695,6 +896,12 @@ set_property (GObject *object,
     case PROP_LEGEND_POSITION:
         self->priv->legend_position = g_value_get_enum (value);
         break;
+    case PROP_STEP_DURATION_MS:
+        self->priv->step_duration_ms = g_value_get_uint (value);
+        /* Time captions are drawn in the background */
+        graph_background_clear (self);
+        gtk_widget_queue_draw (GTK_WIDGET (self));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -731,6 +938,9 @@ get_property (GObject *object,
     case PROP_LEGEND_POSITION:
         g_value_set_enum (value, self->priv->legend_position);
         break;
+    case PROP_STEP_DURATION_MS:
+        g_value_set_uint (value, self->priv->step_duration_ms);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -744,6 +954,7 @@ finalize (GObject *object)
 
     if (self->priv->series)
         free_series (self);
+    free_markers (self);
     g_free (self->priv->y_units);
     g_free (self->priv->title);
 
@@ -826,4 +1037,14 @@ mrm_graph_class_init (MrmGraphClass *klass)
                            MRM_GRAPH_LEGEND_POSITION_BOTTOM,
                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
     g_object_class_install_property (object_class, PROP_LEGEND_POSITION, properties[PROP_LEGEND_POSITION]);
+
+    properties[PROP_STEP_DURATION_MS] =
+        g_param_spec_uint ("step-duration-ms",
+                           "Step duration",
+                           "Time between consecutive steps, in milliseconds",
+                           1,
+                           G_MAXUINT,
+                           1000,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_STEP_DURATION_MS, properties[PROP_STEP_DURATION_MS]);
 }
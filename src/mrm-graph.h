@@ -66,13 +66,22 @@ void mrm_graph_setup_series (MrmGraph *self,
                              guint8 color_blue);
 void mrm_graph_clear_series (MrmGraph *self,
                              guint series_index);
+void mrm_graph_ensure_series (MrmGraph *self,
+                              guint n_series);
 
-void mrm_graph_step_init      (MrmGraph *self);
+void mrm_graph_step_init      (MrmGraph *self,
+                               gint64 timestamp);
 void mrm_graph_step_set_value (MrmGraph *self,
                                guint series_index,
                                gdouble value,
                                GtkLabel *additional_label);
 void mrm_graph_step_finish    (MrmGraph *self);
+void mrm_graph_mark_gap       (MrmGraph *self);
+
+void mrm_graph_add_marker    (MrmGraph *self,
+                              gint64 timestamp,
+                              const gchar *label);
+void mrm_graph_clear_markers (MrmGraph *self);
 
 G_END_DECLS
 
@@ -0,0 +1,223 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mrm-neighbor.h"
+
+/* Neighbors are kept small, as lists with dozens of them may be loaded
+ * every second */
+G_STATIC_ASSERT (sizeof (MrmNeighbor) == 12);
+
+G_DEFINE_BOXED_TYPE (MrmNeighborDelta, mrm_neighbor_delta, mrm_neighbor_delta_copy, mrm_neighbor_delta_free)
+
+/*****************************************************************************/
+
+gint
+mrm_neighbor_compare (const MrmNeighbor *a,
+                      const MrmNeighbor *b)
+{
+    if (a->rat != b->rat)
+        return a->rat < b->rat ? -1 : 1;
+    if (a->channel != b->channel)
+        return a->channel < b->channel ? -1 : 1;
+    if (a->cell_id != b->cell_id)
+        return a->cell_id < b->cell_id ? -1 : 1;
+    return 0;
+}
+
+static gboolean
+neighbor_measurements_equal (const MrmNeighbor *a,
+                             const MrmNeighbor *b)
+{
+    return (a->intra == b->intra &&
+            a->level == b->level &&
+            a->quality == b->quality);
+}
+
+/*****************************************************************************/
+/* Neighbor lists
+ *
+ * A neighbor list is a GArray of MrmNeighbor values sorted by their
+ * identifying fields, so that two lists can be compared in a single pass. */
+
+GArray *
+mrm_neighbor_list_new (void)
+{
+    return g_array_new (FALSE, FALSE, sizeof (MrmNeighbor));
+}
+
+void
+mrm_neighbor_list_sort (GArray *list)
+{
+    guint i;
+    guint j;
+
+    g_array_sort (list, (GCompareFunc) mrm_neighbor_compare);
+
+    /* The same cell may be reported twice, e.g. as both an inter-frequency
+     * LTE neighbor and via the serving cell frequency; keep the first one */
+    for (i = 1, j = 1; i < list->len; i++) {
+        if (mrm_neighbor_compare (&g_array_index (list, MrmNeighbor, i),
+                                  &g_array_index (list, MrmNeighbor, j - 1)) == 0)
+            continue;
+        if (i != j)
+            g_array_index (list, MrmNeighbor, j) = g_array_index (list, MrmNeighbor, i);
+        j++;
+    }
+    if (list->len > 0)
+        g_array_set_size (list, j);
+}
+
+/* The list must be sorted */
+const MrmNeighbor *
+mrm_neighbor_list_find (GArray *list,
+                        MrmNeighborRat rat,
+                        guint32 channel,
+                        guint16 cell_id)
+{
+    MrmNeighbor key = { 0 };
+
+    key.rat = rat;
+    key.channel = channel;
+    key.cell_id = cell_id;
+    return bsearch (&key, list->data, list->len, sizeof (MrmNeighbor), (GCompareFunc) mrm_neighbor_compare);
+}
+
+/* Returns NULL if both lists are equal */
+MrmNeighborDelta *
+mrm_neighbor_list_diff (GArray *old_list,
+                        GArray *new_list,
+                        gint64 timestamp)
+{
+    MrmNeighborDelta *delta;
+    guint i = 0;
+    guint j = 0;
+
+    delta = g_slice_new (MrmNeighborDelta);
+    delta->timestamp = timestamp;
+    delta->updated = mrm_neighbor_list_new ();
+    delta->removed = mrm_neighbor_list_new ();
+
+    while (i < old_list->len || j < new_list->len) {
+        const MrmNeighbor *a = NULL;
+        const MrmNeighbor *b = NULL;
+        gint cmp;
+
+        if (i < old_list->len)
+            a = &g_array_index (old_list, MrmNeighbor, i);
+        if (j < new_list->len)
+            b = &g_array_index (new_list, MrmNeighbor, j);
+
+        cmp = (!a ? 1 : (!b ? -1 : mrm_neighbor_compare (a, b)));
+        if (cmp < 0) {
+            g_array_append_vals (delta->removed, a, 1);
+            i++;
+        } else if (cmp > 0) {
+            g_array_append_vals (delta->updated, b, 1);
+            j++;
+        } else {
+            if (!neighbor_measurements_equal (a, b))
+                g_array_append_vals (delta->updated, b, 1);
+            i++;
+            j++;
+        }
+    }
+
+    if (delta->updated->len == 0 && delta->removed->len == 0) {
+        mrm_neighbor_delta_free (delta);
+        return NULL;
+    }
+
+    return delta;
+}
+
+void
+mrm_neighbor_list_apply (GArray *list,
+                         const MrmNeighborDelta *delta)
+{
+    GArray *merged;
+    guint i = 0;
+    guint j = 0;
+    guint k = 0;
+
+    /* Both the list and the delta arrays are sorted, so a single merge pass
+     * is enough */
+    merged = g_array_sized_new (FALSE, FALSE, sizeof (MrmNeighbor), list->len + delta->updated->len);
+    while (i < list->len) {
+        const MrmNeighbor *current;
+
+        current = &g_array_index (list, MrmNeighbor, i);
+
+        while (j < delta->updated->len &&
+               mrm_neighbor_compare (&g_array_index (delta->updated, MrmNeighbor, j), current) < 0)
+            g_array_append_vals (merged, &g_array_index (delta->updated, MrmNeighbor, j++), 1);
+        while (k < delta->removed->len &&
+               mrm_neighbor_compare (&g_array_index (delta->removed, MrmNeighbor, k), current) < 0)
+            k++;
+
+        if (j < delta->updated->len &&
+            mrm_neighbor_compare (&g_array_index (delta->updated, MrmNeighbor, j), current) == 0)
+            g_array_append_vals (merged, &g_array_index (delta->updated, MrmNeighbor, j++), 1);
+        else if (k < delta->removed->len &&
+                 mrm_neighbor_compare (&g_array_index (delta->removed, MrmNeighbor, k), current) == 0)
+            k++;
+        else
+            g_array_append_vals (merged, current, 1);
+        i++;
+    }
+    if (j < delta->updated->len)
+        g_array_append_vals (merged,
+                             &g_array_index (delta->updated, MrmNeighbor, j),
+                             delta->updated->len - j);
+
+    g_array_set_size (list, merged->len);
+    if (merged->len > 0)
+        memcpy (list->data, merged->data, merged->len * sizeof (MrmNeighbor));
+    g_array_unref (merged);
+}
+
+/*****************************************************************************/
+
+static GArray *
+neighbor_list_dup (GArray *list)
+{
+    GArray *copy;
+
+    copy = g_array_sized_new (FALSE, FALSE, sizeof (MrmNeighbor), list->len);
+    g_array_append_vals (copy, list->data, list->len);
+    return copy;
+}
+
+MrmNeighborDelta *
+mrm_neighbor_delta_copy (const MrmNeighborDelta *self)
+{
+    MrmNeighborDelta *copy;
+
+    copy = g_slice_new (MrmNeighborDelta);
+    copy->timestamp = self->timestamp;
+    copy->updated = neighbor_list_dup (self->updated);
+    copy->removed = neighbor_list_dup (self->removed);
+    return copy;
+}
+
+void
+mrm_neighbor_delta_free (MrmNeighborDelta *self)
+{
+    g_array_unref (self->updated);
+    g_array_unref (self->removed);
+    g_slice_free (MrmNeighborDelta, self);
+}
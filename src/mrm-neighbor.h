@@ -0,0 +1,96 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_NEIGHBOR_H__
+#define __MRM_NEIGHBOR_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_NEIGHBOR_DELTA (mrm_neighbor_delta_get_type ())
+
+typedef enum {
+    MRM_NEIGHBOR_RAT_GSM,
+    MRM_NEIGHBOR_RAT_UMTS,
+    MRM_NEIGHBOR_RAT_LTE,
+} MrmNeighborRat;
+
+/* Quality value of neighbors for which the modem doesn't report one */
+#define MRM_NEIGHBOR_QUALITY_UNKNOWN G_MININT16
+
+/**
+ * MrmNeighbor:
+ * @rat: a #MrmNeighborRat.
+ * @intra: whether the neighbor is in the same frequency as the serving cell.
+ * @cell_id: PCI in LTE, PSC in UMTS, BSIC in GSM.
+ * @channel: EARFCN in LTE, UARFCN in UMTS, ARFCN in GSM.
+ * @level: RSRP in LTE, RSCP in UMTS, RSSI in GSM; in tenths of dBm.
+ * @quality: RSRQ in LTE, Ec/Io in UMTS, in tenths of dB; or
+ *  %MRM_NEIGHBOR_QUALITY_UNKNOWN.
+ *
+ * A single neighbor cell measurement. @rat, @channel and @cell_id identify
+ * the neighbor; the remaining fields are its measured values.
+ */
+typedef struct {
+    guint8 rat;
+    guint8 intra;
+    guint16 cell_id;
+    guint32 channel;
+    gint16 level;
+    gint16 quality;
+} MrmNeighbor;
+
+/**
+ * MrmNeighborDelta:
+ * @timestamp: monotonic time when the neighbor list was requested, in
+ *  microseconds.
+ * @updated: #MrmNeighbor values for new neighbors and for the ones whose
+ *  measurements changed.
+ * @removed: #MrmNeighbor values for neighbors no longer reported, only the
+ *  identifying fields are meaningful.
+ *
+ * Changes between two consecutive neighbor lists.
+ */
+typedef struct {
+    gint64 timestamp;
+    GArray *updated;
+    GArray *removed;
+} MrmNeighborDelta;
+
+gint mrm_neighbor_compare (const MrmNeighbor *a,
+                           const MrmNeighbor *b);
+
+GArray            *mrm_neighbor_list_new  (void);
+void               mrm_neighbor_list_sort (GArray *list);
+const MrmNeighbor *mrm_neighbor_list_find (GArray *list,
+                                           MrmNeighborRat rat,
+                                           guint32 channel,
+                                           guint16 cell_id);
+
+MrmNeighborDelta *mrm_neighbor_list_diff  (GArray *old_list,
+                                           GArray *new_list,
+                                           gint64 timestamp);
+void              mrm_neighbor_list_apply (GArray *list,
+                                           const MrmNeighborDelta *delta);
+
+GType mrm_neighbor_delta_get_type (void) G_GNUC_CONST;
+
+MrmNeighborDelta *mrm_neighbor_delta_copy (const MrmNeighborDelta *self);
+void              mrm_neighbor_delta_free (MrmNeighborDelta *self);
+
+G_END_DECLS
+
+#endif /* __MRM_NEIGHBOR_H__ */
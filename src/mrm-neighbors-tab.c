@@ -0,0 +1,284 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef CMAKE_BUILD
+#include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include "mrm-neighbors-tab.h"
+#include "mrm-graph.h"
+
+/* Number of neighbors shown in the graph at once */
+#define N_TOP_NEIGHBORS 6
+
+typedef struct {
+    gboolean used;
+    MrmNeighbor neighbor;
+} NeighborSlot;
+
+struct _MrmNeighborsTabPrivate {
+    MrmDevice *current;
+
+    guint neighbors_id;
+    guint poll_interval_updated_id;
+
+    /* Current neighbor list, and the graph series each of the top neighbors
+     * is shown in; a neighbor keeps its series while it stays in the top */
+    GArray *neighbors;
+    NeighborSlot slots[N_TOP_NEIGHBORS];
+
+    GtkWidget *count_label;
+    GtkWidget *level_graph;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (MrmNeighborsTab, mrm_neighbors_tab, GTK_TYPE_BOX)
+
+static const guint8 slot_colors[N_TOP_NEIGHBORS][3] = {
+    {  76, 153,   0 }, /* green */
+    { 204,   0,   0 }, /* red */
+    {   0,  76, 153 }, /* blue */
+    { 153, 153,   0 }, /* yellow */
+    { 153,   0, 153 }, /* purple */
+    {   0, 153, 153 }, /* cyan */
+};
+
+/******************************************************************************/
+
+static void
+poll_interval_updated (MrmDevice *device,
+                       GParamSpec *pspec,
+                       MrmNeighborsTab *self)
+{
+    guint interval_ms;
+
+    g_object_get (device, "neighbor-poll-interval-ms", &interval_ms, NULL);
+    g_object_set (self->priv->level_graph, "step-duration-ms", interval_ms, NULL);
+}
+
+static gchar *
+neighbor_build_label (const MrmNeighbor *neighbor)
+{
+    switch (neighbor->rat) {
+    case MRM_NEIGHBOR_RAT_LTE:
+        return g_strdup_printf ("LTE %u/%u", neighbor->channel, neighbor->cell_id);
+    case MRM_NEIGHBOR_RAT_UMTS:
+        return g_strdup_printf ("UMTS %u/%u", neighbor->channel, neighbor->cell_id);
+    case MRM_NEIGHBOR_RAT_GSM:
+        return g_strdup_printf ("GSM %u/%u", neighbor->channel, neighbor->cell_id);
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static gint
+neighbor_compare_level (const MrmNeighbor *a,
+                        const MrmNeighbor *b)
+{
+    /* Strongest first */
+    return (gint) b->level - (gint) a->level;
+}
+
+static void
+slot_clear (MrmNeighborsTab *self,
+            guint i)
+{
+    if (!self->priv->slots[i].used)
+        return;
+
+    mrm_graph_clear_series (MRM_GRAPH (self->priv->level_graph), i);
+    self->priv->slots[i].used = FALSE;
+}
+
+static void
+slots_update (MrmNeighborsTab *self,
+              gint64 timestamp)
+{
+    GArray *top;
+    gchar *str;
+    guint i;
+    guint j;
+
+    /* Only the strongest neighbors are graphed */
+    top = g_array_sized_new (FALSE, FALSE, sizeof (MrmNeighbor), self->priv->neighbors->len);
+    g_array_append_vals (top, self->priv->neighbors->data, self->priv->neighbors->len);
+    g_array_sort (top, (GCompareFunc) neighbor_compare_level);
+    if (top->len > N_TOP_NEIGHBORS)
+        g_array_set_size (top, N_TOP_NEIGHBORS);
+
+    /* Release the series of the neighbors no longer in the top, refresh the
+     * values of the ones that stay */
+    for (i = 0; i < N_TOP_NEIGHBORS; i++) {
+        if (!self->priv->slots[i].used)
+            continue;
+
+        for (j = 0; j < top->len; j++) {
+            if (mrm_neighbor_compare (&self->priv->slots[i].neighbor, &g_array_index (top, MrmNeighbor, j)) == 0)
+                break;
+        }
+        if (j == top->len)
+            slot_clear (self, i);
+        else {
+            self->priv->slots[i].neighbor = g_array_index (top, MrmNeighbor, j);
+            g_array_remove_index (top, j);
+        }
+    }
+
+    /* Whatever is left in the top goes to the free series */
+    for (i = 0, j = 0; i < N_TOP_NEIGHBORS && j < top->len; i++) {
+        if (self->priv->slots[i].used)
+            continue;
+
+        self->priv->slots[i].used = TRUE;
+        self->priv->slots[i].neighbor = g_array_index (top, MrmNeighbor, j++);
+        str = neighbor_build_label (&self->priv->slots[i].neighbor);
+        mrm_graph_setup_series (MRM_GRAPH (self->priv->level_graph), i, str,
+                                slot_colors[i][0], slot_colors[i][1], slot_colors[i][2]);
+        g_free (str);
+    }
+    g_array_unref (top);
+
+    mrm_graph_step_init (MRM_GRAPH (self->priv->level_graph), timestamp);
+    for (i = 0; i < N_TOP_NEIGHBORS; i++) {
+        if (self->priv->slots[i].used)
+            mrm_graph_step_set_value (MRM_GRAPH (self->priv->level_graph),
+                                      i,
+                                      0.1 * ((gdouble) self->priv->slots[i].neighbor.level),
+                                      NULL);
+    }
+    mrm_graph_step_finish (MRM_GRAPH (self->priv->level_graph));
+
+    str = g_strdup_printf ("%u neighbor cells", self->priv->neighbors->len);
+    gtk_label_set_text (GTK_LABEL (self->priv->count_label), str);
+    g_free (str);
+}
+
+static void
+neighbors_received (MrmDevice *device,
+                    const MrmNeighborDelta *delta,
+                    MrmNeighborsTab *self)
+{
+    mrm_neighbor_list_apply (self->priv->neighbors, delta);
+    slots_update (self, delta->timestamp);
+}
+
+void
+mrm_neighbors_tab_change_current_device (MrmNeighborsTab *self,
+                                         MrmDevice *new_device)
+{
+    guint i;
+
+    if (self->priv->current) {
+        /* If same device, nothing else needed */
+        if (new_device &&
+            (self->priv->current == new_device ||
+             g_str_equal (mrm_device_get_name (self->priv->current), mrm_device_get_name (new_device))))
+            return;
+
+        /* Changing current device, cleanup */
+        if (self->priv->neighbors_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->neighbors_id);
+            self->priv->neighbors_id = 0;
+        }
+
+        if (self->priv->poll_interval_updated_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->poll_interval_updated_id);
+            self->priv->poll_interval_updated_id = 0;
+        }
+
+        mrm_device_unsubscribe (self->priv->current, MRM_SAMPLE_GROUP_NEIGHBORS);
+        g_clear_object (&self->priv->current);
+
+        /* Clear graph */
+        for (i = 0; i < N_TOP_NEIGHBORS; i++)
+            slot_clear (self, i);
+        g_array_set_size (self->priv->neighbors, 0);
+        gtk_label_set_text (GTK_LABEL (self->priv->count_label), "No neighbor cells");
+    }
+
+    if (new_device) {
+        /* Keep a ref to current device */
+        self->priv->current = g_object_ref (new_device);
+        self->priv->neighbors_id = g_signal_connect (new_device,
+                                                     "neighbors",
+                                                     G_CALLBACK (neighbors_received),
+                                                     self);
+        self->priv->poll_interval_updated_id = g_signal_connect (new_device,
+                                                                 "notify::neighbor-poll-interval-ms",
+                                                                 G_CALLBACK (poll_interval_updated),
+                                                                 self);
+        poll_interval_updated (new_device, NULL, self);
+
+        /* Neighbors are only loaded while someone wants them */
+        mrm_device_subscribe (new_device, MRM_SAMPLE_GROUP_NEIGHBORS);
+
+        /* Start from the last list the device reported */
+        g_array_unref (self->priv->neighbors);
+        self->priv->neighbors = mrm_device_dup_neighbors (new_device);
+        if (self->priv->neighbors->len > 0)
+            slots_update (self, g_get_monotonic_time ());
+    }
+}
+
+/******************************************************************************/
+
+static void
+mrm_neighbors_tab_init (MrmNeighborsTab *self)
+{
+    self->priv = mrm_neighbors_tab_get_instance_private (self);
+    self->priv->neighbors = mrm_neighbor_list_new ();
+
+    /* Ensure we register the MrmGraph before initiating the template */
+    g_warn_if_fail (mrm_graph_get_type ());
+
+    gtk_widget_init_template (GTK_WIDGET (self));
+}
+
+static void
+dispose (GObject *object)
+{
+    MrmNeighborsTab *self = MRM_NEIGHBORS_TAB (object);
+
+    /* Disconnects from the device and drops the subscription */
+    mrm_neighbors_tab_change_current_device (self, NULL);
+
+    G_OBJECT_CLASS (mrm_neighbors_tab_parent_class)->dispose (object);
+}
+
+static void
+finalize (GObject *object)
+{
+    MrmNeighborsTab *self = MRM_NEIGHBORS_TAB (object);
+
+    g_array_unref (self->priv->neighbors);
+
+    G_OBJECT_CLASS (mrm_neighbors_tab_parent_class)->finalize (object);
+}
+
+static void
+mrm_neighbors_tab_class_init (MrmNeighborsTabClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+    object_class->dispose = dispose;
+    object_class->finalize = finalize;
+
+    /* Bind class to template */
+    gtk_widget_class_set_template_from_resource  (widget_class, "/es/aleksander/mrm/mrm-neighbors-tab.ui");
+    gtk_widget_class_bind_template_child_private (widget_class, MrmNeighborsTab, count_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmNeighborsTab, level_graph);
+}
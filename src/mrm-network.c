@@ -0,0 +1,146 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mrm-network.h"
+#include "mrm-device.h"
+
+G_DEFINE_BOXED_TYPE (MrmNetworkScan, mrm_network_scan, mrm_network_scan_copy, mrm_network_scan_free)
+
+static gsize
+network_scan_size (guint n_networks)
+{
+    return G_STRUCT_OFFSET (MrmNetworkScan, networks) + n_networks * sizeof (MrmNetwork);
+}
+
+static gint
+network_compare (const MrmNetwork *a,
+                 const MrmNetwork *b)
+{
+    /* Current first */
+    if ((a->status & MRM_NETWORK_STATUS_CURRENT) != (b->status & MRM_NETWORK_STATUS_CURRENT))
+        return (a->status & MRM_NETWORK_STATUS_CURRENT) ? -1 : 1;
+    if (a->mcc != b->mcc)
+        return (gint)a->mcc - (gint)b->mcc;
+    if (a->mnc != b->mnc)
+        return (gint)a->mnc - (gint)b->mnc;
+    return (gint)a->act - (gint)b->act;
+}
+
+/*****************************************************************************/
+
+void
+mrm_network_set_description (MrmNetwork *self,
+                             const gchar *description)
+{
+    const gchar *end;
+
+    g_strlcpy (self->description, description ? description : "", sizeof (self->description));
+
+    /* Don't leave a character cut in half */
+    if (!g_utf8_validate (self->description, -1, &end))
+        self->description[end - self->description] = '\0';
+}
+
+gchar *
+mrm_network_build_plmn (const MrmNetwork *self)
+{
+    return g_strdup_printf (self->mnc_3_digits ? "%03u-%03u" : "%03u-%02u", self->mcc, self->mnc);
+}
+
+const gchar *
+mrm_network_get_act_string (const MrmNetwork *self)
+{
+    switch (self->act) {
+    case MRM_DEVICE_ACT_GSM:
+        return "GSM";
+    case MRM_DEVICE_ACT_UMTS:
+        return "UMTS";
+    case MRM_DEVICE_ACT_LTE:
+        return "LTE";
+    case MRM_DEVICE_ACT_CDMA:
+        return "CDMA";
+    case MRM_DEVICE_ACT_EVDO:
+        return "EVDO";
+    case MRM_DEVICE_ACT_NR5G:
+        return "5G NR";
+    default:
+        return "Unknown";
+    }
+}
+
+gchar *
+mrm_network_build_status_label (const MrmNetwork *self)
+{
+    GString *str;
+
+    str = g_string_new ("");
+    if (self->status & MRM_NETWORK_STATUS_CURRENT)
+        g_string_append (str, "Current");
+    else if (self->status & MRM_NETWORK_STATUS_FORBIDDEN)
+        g_string_append (str, "Forbidden");
+    else if (self->status & MRM_NETWORK_STATUS_AVAILABLE)
+        g_string_append (str, "Available");
+    else
+        g_string_append (str, "Unavailable");
+
+    if (self->status & MRM_NETWORK_STATUS_HOME)
+        g_string_append (str, ", home");
+    else if (self->status & MRM_NETWORK_STATUS_ROAMING)
+        g_string_append (str, ", roaming");
+    if (self->status & MRM_NETWORK_STATUS_PREFERRED)
+        g_string_append (str, ", preferred");
+
+    return g_string_free (str, FALSE);
+}
+
+/*****************************************************************************/
+
+MrmNetworkScan *
+mrm_network_scan_new (gint64 timestamp,
+                      gint64 duration,
+                      const MrmNetwork *networks,
+                      guint n_networks)
+{
+    MrmNetworkScan *self;
+
+    self = g_malloc (network_scan_size (n_networks));
+    self->timestamp = timestamp;
+    self->duration = duration;
+    self->n_networks = n_networks;
+    if (n_networks > 0) {
+        memcpy (self->networks, networks, n_networks * sizeof (MrmNetwork));
+        qsort (self->networks, n_networks, sizeof (MrmNetwork), (GCompareFunc) network_compare);
+    }
+    return self;
+}
+
+MrmNetworkScan *
+mrm_network_scan_copy (const MrmNetworkScan *self)
+{
+    MrmNetworkScan *copy;
+
+    copy = g_malloc (network_scan_size (self->n_networks));
+    memcpy (copy, self, network_scan_size (self->n_networks));
+    return copy;
+}
+
+void
+mrm_network_scan_free (MrmNetworkScan *self)
+{
+    g_free (self);
+}
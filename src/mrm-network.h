@@ -0,0 +1,99 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_NETWORK_H__
+#define __MRM_NETWORK_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_NETWORK_SCAN (mrm_network_scan_get_type ())
+
+typedef enum {
+    MRM_NETWORK_STATUS_CURRENT   = 1 << 0,
+    MRM_NETWORK_STATUS_AVAILABLE = 1 << 1,
+    MRM_NETWORK_STATUS_HOME      = 1 << 2,
+    MRM_NETWORK_STATUS_ROAMING   = 1 << 3,
+    MRM_NETWORK_STATUS_FORBIDDEN = 1 << 4,
+    MRM_NETWORK_STATUS_PREFERRED = 1 << 5,
+} MrmNetworkStatus;
+
+/* Level of the networks the modem isn't measuring */
+#define MRM_NETWORK_LEVEL_UNKNOWN G_MININT16
+
+/* Size of the description, longer ones are truncated */
+#define MRM_NETWORK_DESCRIPTION_SIZE 64
+
+/**
+ * MrmNetwork:
+ * @mcc: mobile country code.
+ * @mnc: mobile network code.
+ * @mnc_3_digits: whether @mnc has 3 digits.
+ * @status: #MrmNetworkStatus flags.
+ * @act: the #MrmDeviceAct the network was found in, or 0 if not reported.
+ * @level: RSSI, or RSRP in 5G NR, in tenths of dBm; or
+ *  %MRM_NETWORK_LEVEL_UNKNOWN. Network scans don't report levels, so this is
+ *  only known for the current network, from the signal info.
+ * @description: operator name, as given by the network; may be empty.
+ *
+ * A network found in a network scan.
+ */
+typedef struct {
+    guint16 mcc;
+    guint16 mnc;
+    guint8 mnc_3_digits;
+    guint8 status;
+    guint act;
+    gint16 level;
+    gchar description[MRM_NETWORK_DESCRIPTION_SIZE];
+} MrmNetwork;
+
+/**
+ * MrmNetworkScan:
+ * @timestamp: monotonic time when the scan was requested, in microseconds.
+ * @duration: time the scan took, in microseconds.
+ * @n_networks: number of items in @networks.
+ * @networks: the current network first, then the others sorted by PLMN and
+ *  access technology.
+ *
+ * The result of a network scan. Allocated as a single block sized for the
+ * networks actually found.
+ */
+typedef struct {
+    gint64 timestamp;
+    gint64 duration;
+    guint n_networks;
+    MrmNetwork networks[];
+} MrmNetworkScan;
+
+void         mrm_network_set_description  (MrmNetwork *self,
+                                           const gchar *description);
+gchar       *mrm_network_build_plmn       (const MrmNetwork *self);
+const gchar *mrm_network_get_act_string   (const MrmNetwork *self);
+gchar       *mrm_network_build_status_label (const MrmNetwork *self);
+
+GType mrm_network_scan_get_type (void) G_GNUC_CONST;
+
+MrmNetworkScan *mrm_network_scan_new  (gint64 timestamp,
+                                       gint64 duration,
+                                       const MrmNetwork *networks,
+                                       guint n_networks);
+MrmNetworkScan *mrm_network_scan_copy (const MrmNetworkScan *self);
+void            mrm_network_scan_free (MrmNetworkScan *self);
+
+G_END_DECLS
+
+#endif /* __MRM_NETWORK_H__ */
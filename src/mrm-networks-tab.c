@@ -0,0 +1,290 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef CMAKE_BUILD
+#include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include "mrm-networks-tab.h"
+
+enum {
+    COLUMN_OPERATOR,
+    COLUMN_PLMN,
+    COLUMN_TECHNOLOGY,
+    COLUMN_STATUS,
+    COLUMN_LEVEL,
+    COLUMN_WEIGHT,
+};
+
+struct _MrmNetworksTabPrivate {
+    MrmDevice *current;
+
+    guint network_scan_id;
+    guint network_scanning_id;
+
+    /* Last scan of the current device, if any */
+    MrmNetworkScan *scan;
+
+    /* Periodic scans chosen by the user, in seconds; 0 if none */
+    guint scan_interval;
+
+    GtkWidget *status_label;
+    GtkWidget *scan_button;
+    GtkWidget *scan_interval_combo;
+    GtkListStore *networks_store;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (MrmNetworksTab, mrm_networks_tab, GTK_TYPE_BOX)
+
+/******************************************************************************/
+
+static void
+status_update (MrmNetworksTab *self)
+{
+    gchar *str;
+
+    if (!self->priv->current) {
+        gtk_widget_set_sensitive (self->priv->scan_button, FALSE);
+        gtk_label_set_text (GTK_LABEL (self->priv->status_label), "No network scan yet");
+        return;
+    }
+
+    /* Scans take long, don't pile them up */
+    if (mrm_device_get_network_scanning (self->priv->current)) {
+        gtk_widget_set_sensitive (self->priv->scan_button, FALSE);
+        gtk_label_set_text (GTK_LABEL (self->priv->status_label), "Scanning networks...");
+        return;
+    }
+
+    gtk_widget_set_sensitive (self->priv->scan_button, TRUE);
+    if (!self->priv->scan) {
+        gtk_label_set_text (GTK_LABEL (self->priv->status_label), "No network scan yet");
+        return;
+    }
+
+    str = g_strdup_printf ("%u networks found, scan took %.1lf s",
+                           self->priv->scan->n_networks,
+                           self->priv->scan->duration / 1000000.0);
+    gtk_label_set_text (GTK_LABEL (self->priv->status_label), str);
+    g_free (str);
+}
+
+static void
+networks_update (MrmNetworksTab *self)
+{
+    guint i;
+
+    gtk_list_store_clear (self->priv->networks_store);
+    if (!self->priv->scan)
+        return;
+
+    for (i = 0; i < self->priv->scan->n_networks; i++) {
+        const MrmNetwork *network = &self->priv->scan->networks[i];
+        GtkTreeIter iter;
+        gchar *plmn;
+        gchar *status;
+        gchar *level = NULL;
+
+        plmn = mrm_network_build_plmn (network);
+        status = mrm_network_build_status_label (network);
+        if (network->level != MRM_NETWORK_LEVEL_UNKNOWN)
+            level = g_strdup_printf ("%.1lf dBm", 0.1 * (gdouble) network->level);
+
+        gtk_list_store_insert_with_values (self->priv->networks_store, &iter, -1,
+                                           COLUMN_OPERATOR,   network->description,
+                                           COLUMN_PLMN,       plmn,
+                                           COLUMN_TECHNOLOGY, mrm_network_get_act_string (network),
+                                           COLUMN_STATUS,     status,
+                                           COLUMN_LEVEL,      level ? level : "",
+                                           COLUMN_WEIGHT,     ((network->status & MRM_NETWORK_STATUS_CURRENT) ?
+                                                               PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL),
+                                           -1);
+        g_free (plmn);
+        g_free (status);
+        g_free (level);
+    }
+}
+
+static void
+network_scan_received (MrmDevice *device,
+                       const MrmNetworkScan *scan,
+                       MrmNetworksTab *self)
+{
+    if (self->priv->scan)
+        mrm_network_scan_free (self->priv->scan);
+    self->priv->scan = mrm_network_scan_copy (scan);
+    networks_update (self);
+    status_update (self);
+}
+
+static void
+network_scanning_updated (MrmDevice *device,
+                          GParamSpec *pspec,
+                          MrmNetworksTab *self)
+{
+    status_update (self);
+}
+
+static void
+scan_networks_ready (MrmDevice *device,
+                     GAsyncResult *res,
+                     MrmNetworksTab *self)
+{
+    GError *error = NULL;
+
+    /* Only report failures of the device still shown */
+    if (!mrm_device_scan_networks_finish (device, res, &error)) {
+        if (self->priv->current == device) {
+            gchar *str;
+
+            str = g_strdup_printf ("Network scan failed: %s", error->message);
+            gtk_label_set_text (GTK_LABEL (self->priv->status_label), str);
+            g_free (str);
+        }
+        g_error_free (error);
+    }
+
+    g_object_unref (self);
+}
+
+static void
+scan_button_clicked (MrmNetworksTab *self)
+{
+    if (!self->priv->current)
+        return;
+
+    gtk_widget_set_sensitive (self->priv->scan_button, FALSE);
+    mrm_device_scan_networks (self->priv->current,
+                              (GAsyncReadyCallback) scan_networks_ready,
+                              g_object_ref (self));
+}
+
+static void
+scan_interval_combo_changed (MrmNetworksTab *self)
+{
+    const gchar *id;
+
+    id = gtk_combo_box_get_active_id (GTK_COMBO_BOX (self->priv->scan_interval_combo));
+    self->priv->scan_interval = id ? (guint) g_ascii_strtoull (id, NULL, 10) : 0;
+
+    if (self->priv->current)
+        g_object_set (self->priv->current, "network-scan-interval", self->priv->scan_interval, NULL);
+}
+
+void
+mrm_networks_tab_change_current_device (MrmNetworksTab *self,
+                                        MrmDevice *new_device)
+{
+    if (!self->priv->current && !new_device)
+        return;
+
+    if (self->priv->current) {
+        /* If same device, nothing else needed */
+        if (new_device &&
+            (self->priv->current == new_device ||
+             g_str_equal (mrm_device_get_name (self->priv->current), mrm_device_get_name (new_device))))
+            return;
+
+        /* Changing current device, cleanup */
+        if (self->priv->network_scan_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->network_scan_id);
+            self->priv->network_scan_id = 0;
+        }
+
+        if (self->priv->network_scanning_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->network_scanning_id);
+            self->priv->network_scanning_id = 0;
+        }
+
+        /* Periodic scans are only run while someone shows them */
+        g_object_set (self->priv->current, "network-scan-interval", 0, NULL);
+        g_clear_object (&self->priv->current);
+
+        if (self->priv->scan) {
+            mrm_network_scan_free (self->priv->scan);
+            self->priv->scan = NULL;
+        }
+    }
+
+    if (new_device) {
+        /* Keep a ref to current device */
+        self->priv->current = g_object_ref (new_device);
+        self->priv->network_scan_id = g_signal_connect (new_device,
+                                                        "network-scan",
+                                                        G_CALLBACK (network_scan_received),
+                                                        self);
+        self->priv->network_scanning_id = g_signal_connect (new_device,
+                                                            "notify::network-scanning",
+                                                            G_CALLBACK (network_scanning_updated),
+                                                            self);
+        g_object_set (new_device, "network-scan-interval", self->priv->scan_interval, NULL);
+
+        /* Start from the last scan the device reported */
+        self->priv->scan = mrm_device_dup_network_scan (new_device);
+    }
+
+    networks_update (self);
+    status_update (self);
+}
+
+/******************************************************************************/
+
+static void
+mrm_networks_tab_init (MrmNetworksTab *self)
+{
+    self->priv = mrm_networks_tab_get_instance_private (self);
+
+    gtk_widget_init_template (GTK_WIDGET (self));
+
+    self->priv->scan_interval = MRM_DEVICE_NETWORK_SCAN_INTERVAL_DEFAULT;
+
+    g_signal_connect_swapped (self->priv->scan_button,
+                              "clicked",
+                              G_CALLBACK (scan_button_clicked),
+                              self);
+    g_signal_connect_swapped (self->priv->scan_interval_combo,
+                              "changed",
+                              G_CALLBACK (scan_interval_combo_changed),
+                              self);
+}
+
+static void
+dispose (GObject *object)
+{
+    MrmNetworksTab *self = MRM_NETWORKS_TAB (object);
+
+    /* Disconnects from the device and stops periodic scans */
+    mrm_networks_tab_change_current_device (self, NULL);
+
+    G_OBJECT_CLASS (mrm_networks_tab_parent_class)->dispose (object);
+}
+
+static void
+mrm_networks_tab_class_init (MrmNetworksTabClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+    object_class->dispose = dispose;
+
+    /* Bind class to template */
+    gtk_widget_class_set_template_from_resource  (widget_class, "/es/aleksander/mrm/mrm-networks-tab.ui");
+    gtk_widget_class_bind_template_child_private (widget_class, MrmNetworksTab, status_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmNetworksTab, scan_button);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmNetworksTab, scan_interval_combo);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmNetworksTab, networks_store);
+}
@@ -27,6 +27,8 @@ struct _MrmPowerTabPrivate {
     MrmDevice *current;
 
     guint act_updated_id;
+    guint sample_id;
+    guint poll_interval_updated_id;
 
     GtkWidget *legend_gsm_box;
     GtkWidget *legend_gsm_icon;
@@ -58,23 +60,48 @@ struct _MrmPowerTabPrivate {
     GtkWidget *legend_evdo_rx1_value_label;
     GtkWidget *legend_evdo_tx_value_label;
 
+    GtkWidget *legend_nr5g_box;
+    GtkWidget *legend_nr5g_icon;
+    GtkWidget *legend_nr5g_rx0_value_label;
+    GtkWidget *legend_nr5g_rx1_value_label;
+    GtkWidget *legend_nr5g_tx_value_label;
+
     GtkWidget *rx0_graph;
     GtkWidget *rx0_graph_frame;
-    guint rx0_graph_updated_id;
 
     GtkWidget *rx1_graph;
     GtkWidget *rx1_graph_frame;
-    guint rx1_graph_updated_id;
 
     GtkWidget *tx_graph;
     GtkWidget *tx_graph_frame;
-    guint tx_graph_updated_id;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (MrmPowerTab, mrm_power_tab, GTK_TYPE_BOX)
 
 /******************************************************************************/
 
+static void
+poll_interval_updated (MrmDevice *device,
+                       GParamSpec *pspec,
+                       MrmPowerTab *self)
+{
+    guint interval_ms;
+
+    g_object_get (device, "power-poll-interval-ms", &interval_ms, NULL);
+    g_object_set (self->priv->rx0_graph, "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->rx1_graph, "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->tx_graph,  "step-duration-ms", interval_ms, NULL);
+}
+
+static gdouble
+sample_value (const MrmSample *sample,
+              MrmSampleMetric metric)
+{
+    gdouble value;
+
+    return mrm_sample_get_value (sample, metric, &value) ? value : -G_MAXDOUBLE;
+}
+
 static void
 act_updated (MrmDevice *device,
              MrmDeviceAct act,
@@ -94,6 +121,8 @@ act_updated (MrmDevice *device,
                               (act & MRM_DEVICE_ACT_CDMA));
     gtk_widget_set_sensitive (self->priv->legend_evdo_box,
                               (act & MRM_DEVICE_ACT_EVDO));
+    gtk_widget_set_sensitive (self->priv->legend_nr5g_box,
+                              (act & MRM_DEVICE_ACT_NR5G));
 }
 
 typedef enum {
@@ -102,38 +131,38 @@ typedef enum {
     SERIES_RX0_LTE  = 2,
     SERIES_RX0_CDMA = 3,
     SERIES_RX0_EVDO = 4,
+    SERIES_RX0_NR5G = 5,
 } SeriesRx0;
 
 static void
-rx0_updated (MrmDevice *device,
-             gdouble gsm_rx0,
-             gdouble umts_rx0,
-             gdouble lte_rx0,
-             gdouble cdma_rx0,
-             gdouble evdo_rx0,
-             MrmPowerTab *self)
+rx0_updated (MrmPowerTab *self,
+             const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->rx0_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->rx0_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx0_graph),
                               SERIES_RX0_GSM,
-                              gsm_rx0,
+                              sample_value (sample, MRM_SAMPLE_METRIC_GSM_RX0),
                               GTK_LABEL (self->priv->legend_gsm_rx0_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx0_graph),
                               SERIES_RX0_UMTS,
-                              umts_rx0,
+                              sample_value (sample, MRM_SAMPLE_METRIC_UMTS_RX0),
                               GTK_LABEL (self->priv->legend_umts_rx0_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx0_graph),
                               SERIES_RX0_LTE,
-                              lte_rx0,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_RX0),
                               GTK_LABEL (self->priv->legend_lte_rx0_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx0_graph),
                               SERIES_RX0_CDMA,
-                              cdma_rx0,
+                              sample_value (sample, MRM_SAMPLE_METRIC_CDMA_RX0),
                               GTK_LABEL (self->priv->legend_cdma_rx0_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx0_graph),
                               SERIES_RX0_EVDO,
-                              evdo_rx0,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_RX0),
                               GTK_LABEL (self->priv->legend_cdma_rx0_value_label));
+    mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx0_graph),
+                              SERIES_RX0_NR5G,
+                              sample_value (sample, MRM_SAMPLE_METRIC_NR5G_RX0),
+                              GTK_LABEL (self->priv->legend_nr5g_rx0_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->rx0_graph));
 }
 
@@ -143,38 +172,38 @@ typedef enum {
     SERIES_RX1_LTE  = 2,
     SERIES_RX1_CDMA = 3,
     SERIES_RX1_EVDO = 4,
+    SERIES_RX1_NR5G = 5,
 } SeriesRx1;
 
 static void
-rx1_updated (MrmDevice *device,
-             gdouble gsm_rx1,
-             gdouble umts_rx1,
-             gdouble lte_rx1,
-             gdouble cdma_rx1,
-             gdouble evdo_rx1,
-             MrmPowerTab *self)
+rx1_updated (MrmPowerTab *self,
+             const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->rx1_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->rx1_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx1_graph),
                               SERIES_RX1_GSM,
-                              gsm_rx1,
+                              sample_value (sample, MRM_SAMPLE_METRIC_GSM_RX1),
                               GTK_LABEL (self->priv->legend_gsm_rx1_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx1_graph),
                               SERIES_RX1_UMTS,
-                              umts_rx1,
+                              sample_value (sample, MRM_SAMPLE_METRIC_UMTS_RX1),
                               GTK_LABEL (self->priv->legend_umts_rx1_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx1_graph),
                               SERIES_RX1_LTE,
-                              lte_rx1,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_RX1),
                               GTK_LABEL (self->priv->legend_lte_rx1_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx1_graph),
                               SERIES_RX1_CDMA,
-                              cdma_rx1,
+                              sample_value (sample, MRM_SAMPLE_METRIC_CDMA_RX1),
                               GTK_LABEL (self->priv->legend_cdma_rx1_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx1_graph),
                               SERIES_RX1_EVDO,
-                              evdo_rx1,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_RX1),
                               GTK_LABEL (self->priv->legend_cdma_rx1_value_label));
+    mrm_graph_step_set_value (MRM_GRAPH (self->priv->rx1_graph),
+                              SERIES_RX1_NR5G,
+                              sample_value (sample, MRM_SAMPLE_METRIC_NR5G_RX1),
+                              GTK_LABEL (self->priv->legend_nr5g_rx1_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->rx1_graph));
 }
 
@@ -184,45 +213,68 @@ typedef enum {
     SERIES_TX_LTE  = 2,
     SERIES_TX_CDMA = 3,
     SERIES_TX_EVDO = 4,
+    SERIES_TX_NR5G = 5,
 } SeriesTx;
 
 static void
-tx_updated (MrmDevice *device,
-            gdouble gsm_tx,
-            gdouble umts_tx,
-            gdouble lte_tx,
-            gdouble cdma_tx,
-            gdouble evdo_tx,
-            MrmPowerTab *self)
+tx_updated (MrmPowerTab *self,
+            const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->tx_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->tx_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->tx_graph),
                               SERIES_TX_GSM,
-                              gsm_tx,
+                              sample_value (sample, MRM_SAMPLE_METRIC_GSM_TX),
                               GTK_LABEL (self->priv->legend_gsm_tx_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->tx_graph),
                               SERIES_TX_UMTS,
-                              umts_tx,
+                              sample_value (sample, MRM_SAMPLE_METRIC_UMTS_TX),
                               GTK_LABEL (self->priv->legend_umts_tx_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->tx_graph),
                               SERIES_TX_LTE,
-                              lte_tx,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_TX),
                               GTK_LABEL (self->priv->legend_lte_tx_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->tx_graph),
                               SERIES_TX_CDMA,
-                              cdma_tx,
+                              sample_value (sample, MRM_SAMPLE_METRIC_CDMA_TX),
                               GTK_LABEL (self->priv->legend_cdma_tx_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->tx_graph),
                               SERIES_TX_EVDO,
-                              evdo_tx,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_TX),
                               GTK_LABEL (self->priv->legend_cdma_tx_value_label));
+    mrm_graph_step_set_value (MRM_GRAPH (self->priv->tx_graph),
+                              SERIES_TX_NR5G,
+                              sample_value (sample, MRM_SAMPLE_METRIC_NR5G_TX),
+                              GTK_LABEL (self->priv->legend_nr5g_tx_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->tx_graph));
 }
 
+static void
+sample_received (MrmDevice *device,
+                 const MrmSample *sample,
+                 MrmPowerTab *self)
+{
+    /* Graphs only move on when their metrics were loaded */
+    if (sample->groups & MRM_SAMPLE_GROUP_POWER) {
+        rx0_updated (self, sample);
+        rx1_updated (self, sample);
+        tx_updated (self, sample);
+
+        /* Don't bridge the time the device was away */
+        if (sample->gap) {
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->rx0_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->rx1_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->tx_graph));
+        }
+    }
+}
+
 void
 mrm_power_tab_change_current_device (MrmPowerTab *self,
                                      MrmDevice *new_device)
 {
+    GArray *history;
+    guint i;
+
     if (self->priv->current) {
         /* If same device, nothing else needed */
         if (new_device &&
@@ -236,21 +288,17 @@ mrm_power_tab_change_current_device (MrmPowerTab *self,
             self->priv->act_updated_id = 0;
         }
 
-        if (self->priv->rx0_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->rx0_graph_updated_id);
-            self->priv->rx0_graph_updated_id = 0;
-        }
-
-        if (self->priv->rx1_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->rx1_graph_updated_id);
-            self->priv->rx1_graph_updated_id = 0;
+        if (self->priv->sample_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->sample_id);
+            self->priv->sample_id = 0;
         }
 
-        if (self->priv->tx_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->tx_graph_updated_id);
-            self->priv->tx_graph_updated_id = 0;
+        if (self->priv->poll_interval_updated_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->poll_interval_updated_id);
+            self->priv->poll_interval_updated_id = 0;
         }
 
+        mrm_device_unsubscribe (self->priv->current, MRM_SAMPLE_GROUP_POWER);
         g_clear_object (&self->priv->current);
 
         /* Clear graphs */
@@ -260,18 +308,21 @@ mrm_power_tab_change_current_device (MrmPowerTab *self,
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_LTE);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_CDMA);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_EVDO);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_NR5G);
 
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_GSM);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_UMTS);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_LTE);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_CDMA);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_EVDO);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_NR5G);
 
         mrm_graph_clear_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_GSM);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_UMTS);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_LTE);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_CDMA);
         mrm_graph_clear_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_EVDO);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_NR5G);
     }
 
     if (new_device) {
@@ -281,18 +332,25 @@ mrm_power_tab_change_current_device (MrmPowerTab *self,
                                                        "act-updated",
                                                        G_CALLBACK (act_updated),
                                                        self);
-        self->priv->rx0_graph_updated_id = g_signal_connect (new_device,
-                                                             "rx0-updated",
-                                                             G_CALLBACK (rx0_updated),
-                                                             self);
-        self->priv->rx1_graph_updated_id = g_signal_connect (new_device,
-                                                             "rx1-updated",
-                                                             G_CALLBACK (rx1_updated),
-                                                             self);
-        self->priv->tx_graph_updated_id = g_signal_connect (new_device,
-                                                            "tx-updated",
-                                                            G_CALLBACK (tx_updated),
-                                                            self);
+        act_updated (new_device, mrm_device_get_act (new_device), self);
+        self->priv->sample_id = g_signal_connect (new_device,
+                                                  "sample",
+                                                  G_CALLBACK (sample_received),
+                                                  self);
+        self->priv->poll_interval_updated_id = g_signal_connect (new_device,
+                                                                 "notify::power-poll-interval-ms",
+                                                                 G_CALLBACK (poll_interval_updated),
+                                                                 self);
+        poll_interval_updated (new_device, NULL, self);
+
+        /* Metrics are only polled while someone wants them */
+        mrm_device_subscribe (new_device, MRM_SAMPLE_GROUP_POWER);
+
+        /* Replay whatever the device sampled while not shown */
+        history = mrm_device_dup_history (new_device);
+        for (i = 0; i < history->len; i++)
+            sample_received (new_device, &g_array_index (history, MrmSample, i), self);
+        g_array_unref (history);
     }
 }
 
@@ -315,6 +373,7 @@ mrm_power_tab_init (MrmPowerTab *self)
 #define LTE_RGB  0,   76,  153 /* blue */
 #define CDMA_RGB 153, 153, 0   /* yellow */
 #define EVDO_RGB 153, 0,   153 /* purple */
+#define NR5G_RGB 255, 128, 0   /* orange */
 
     /* Main legend box */
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_gsm_icon),  GSM_RGB);
@@ -322,6 +381,7 @@ mrm_power_tab_init (MrmPowerTab *self)
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_lte_icon),  LTE_RGB);
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_cdma_icon), CDMA_RGB);
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_evdo_icon), EVDO_RGB);
+    mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_nr5g_icon), NR5G_RGB);
 
     /* RX0 graph */
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_GSM,  "GSM",  GSM_RGB);
@@ -329,6 +389,7 @@ mrm_power_tab_init (MrmPowerTab *self)
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_LTE,  "LTE",  LTE_RGB);
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_CDMA, "CDMA", CDMA_RGB);
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_EVDO, "EVDO", EVDO_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->rx0_graph), SERIES_RX0_NR5G, "5G NR", NR5G_RGB);
 
     /* RX1 graph */
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_GSM,  "GSM",  GSM_RGB);
@@ -336,6 +397,7 @@ mrm_power_tab_init (MrmPowerTab *self)
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_LTE,  "LTE",  LTE_RGB);
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_CDMA, "CDMA", CDMA_RGB);
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_EVDO, "EVDO", EVDO_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->rx1_graph), SERIES_RX1_NR5G, "5G NR", NR5G_RGB);
 
     /* TX graph */
     mrm_graph_setup_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_GSM,  "GSM",  GSM_RGB);
@@ -343,6 +405,7 @@ mrm_power_tab_init (MrmPowerTab *self)
     mrm_graph_setup_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_LTE,  "LTE",  LTE_RGB);
     mrm_graph_setup_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_CDMA, "CDMA", CDMA_RGB);
     mrm_graph_setup_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_EVDO, "EVDO", EVDO_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->tx_graph), SERIES_TX_NR5G, "5G NR", NR5G_RGB);
 }
 
 static void
@@ -350,7 +413,8 @@ dispose (GObject *object)
 {
     MrmPowerTab *self = MRM_POWER_TAB (object);
 
-    g_clear_object (&self->priv->current);
+    /* Disconnects from the device and drops the subscription */
+    mrm_power_tab_change_current_device (self, NULL);
 
     G_OBJECT_CLASS (mrm_power_tab_parent_class)->dispose (object);
 }
@@ -396,5 +460,10 @@ mrm_power_tab_class_init (MrmPowerTabClass *klass)
     gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_lte_tx_value_label);
     gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_cdma_tx_value_label);
     gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_evdo_tx_value_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_nr5g_box);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_nr5g_icon);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_nr5g_rx0_value_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_nr5g_rx1_value_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmPowerTab, legend_nr5g_tx_value_label);
 
 }
@@ -0,0 +1,157 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <string.h>
+
+#include "mrm-recorder.h"
+
+G_DEFINE_TYPE (MrmRecorder, mrm_recorder, G_TYPE_OBJECT)
+
+struct _MrmRecorderPrivate {
+    gchar *path;
+    GOutputStream *stream;
+    MrmDevice *device;
+    guint sample_id;
+};
+
+/*****************************************************************************/
+/* Recording
+ *
+ * Samples are written as the device emits them, in the format loaded by the
+ * replay backend: the device identity as comments, followed by one sample
+ * per line. Lines are written right away, so that the recording is usable
+ * even if the program doesn't exit cleanly. */
+
+static gboolean
+recorder_write (MrmRecorder *self,
+                const gchar *line,
+                GError **error)
+{
+    return (g_output_stream_write_all (self->priv->stream, line, strlen (line), NULL, NULL, error) &&
+            g_output_stream_write_all (self->priv->stream, "\n", 1, NULL, NULL, error));
+}
+
+static void
+recorder_stop (MrmRecorder *self)
+{
+    if (self->priv->device) {
+        g_signal_handler_disconnect (self->priv->device, self->priv->sample_id);
+        g_object_remove_weak_pointer (G_OBJECT (self->priv->device), (gpointer *) &self->priv->device);
+        self->priv->device = NULL;
+    }
+    if (self->priv->stream) {
+        g_output_stream_close (self->priv->stream, NULL, NULL);
+        g_clear_object (&self->priv->stream);
+    }
+}
+
+static void
+sample_received (MrmDevice *device,
+                 const MrmSample *sample,
+                 MrmRecorder *self)
+{
+    GError *error = NULL;
+    gchar *line;
+
+    line = mrm_sample_serialize (sample);
+    if (!recorder_write (self, line, &error)) {
+        g_warning ("Cannot record samples of '%s' to '%s', recording stopped: %s",
+                   mrm_device_get_name (device), self->priv->path, error->message);
+        g_error_free (error);
+        recorder_stop (self);
+    }
+    g_free (line);
+}
+
+MrmRecorder *
+mrm_recorder_new (MrmDevice *device,
+                  GFile *file,
+                  GError **error)
+{
+    MrmRecorder *self;
+    GFileOutputStream *stream;
+    GString *header;
+    gboolean written;
+
+    g_return_val_if_fail (MRM_IS_DEVICE (device), NULL);
+    g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+    stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+    if (!stream)
+        return NULL;
+
+    self = g_object_new (MRM_TYPE_RECORDER, NULL);
+    self->priv->path = g_file_get_path (file);
+    self->priv->stream = G_OUTPUT_STREAM (stream);
+
+    /* Only the identity fields known so far */
+    header = g_string_new (NULL);
+    if (mrm_device_get_manufacturer (device))
+        g_string_append_printf (header, "# manufacturer: %s\n", mrm_device_get_manufacturer (device));
+    if (mrm_device_get_model (device))
+        g_string_append_printf (header, "# model: %s\n", mrm_device_get_model (device));
+    if (mrm_device_get_revision (device))
+        g_string_append_printf (header, "# revision: %s\n", mrm_device_get_revision (device));
+    written = g_output_stream_write_all (self->priv->stream, header->str, header->len, NULL, NULL, error);
+    g_string_free (header, TRUE);
+    if (!written) {
+        g_object_unref (self);
+        return NULL;
+    }
+
+    /* The device owns the recorder, so no reference is kept */
+    self->priv->device = device;
+    g_object_add_weak_pointer (G_OBJECT (device), (gpointer *) &self->priv->device);
+    self->priv->sample_id = g_signal_connect (device,
+                                              "sample",
+                                              G_CALLBACK (sample_received),
+                                              self);
+    return self;
+}
+
+static void
+mrm_recorder_init (MrmRecorder *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MRM_TYPE_RECORDER, MrmRecorderPrivate);
+}
+
+static void
+dispose (GObject *object)
+{
+    recorder_stop (MRM_RECORDER (object));
+
+    G_OBJECT_CLASS (mrm_recorder_parent_class)->dispose (object);
+}
+
+static void
+finalize (GObject *object)
+{
+    MrmRecorder *self = MRM_RECORDER (object);
+
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mrm_recorder_parent_class)->finalize (object);
+}
+
+static void
+mrm_recorder_class_init (MrmRecorderClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MrmRecorderPrivate));
+
+    object_class->dispose = dispose;
+    object_class->finalize = finalize;
+}
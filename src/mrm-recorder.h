@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_RECORDER_H__
+#define __MRM_RECORDER_H__
+
+#include <gio/gio.h>
+
+#include "mrm-device.h"
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_RECORDER         (mrm_recorder_get_type ())
+#define MRM_RECORDER(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), MRM_TYPE_RECORDER, MrmRecorder))
+#define MRM_RECORDER_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST ((k), MRM_TYPE_RECORDER, MrmRecorderClass))
+#define MRM_IS_RECORDER(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), MRM_TYPE_RECORDER))
+#define MRM_IS_RECORDER_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), MRM_TYPE_RECORDER))
+#define MRM_RECORDER_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), MRM_TYPE_RECORDER, MrmRecorderClass))
+
+typedef struct _MrmRecorder        MrmRecorder;
+typedef struct _MrmRecorderClass   MrmRecorderClass;
+typedef struct _MrmRecorderPrivate MrmRecorderPrivate;
+
+struct _MrmRecorder {
+    GObject parent_instance;
+    MrmRecorderPrivate *priv;
+};
+
+struct _MrmRecorderClass {
+    GObjectClass parent_class;
+};
+
+GType mrm_recorder_get_type (void) G_GNUC_CONST;
+
+MrmRecorder *mrm_recorder_new (MrmDevice *device,
+                               GFile *file,
+                               GError **error);
+
+G_END_DECLS
+
+#endif /* __MRM_RECORDER_H__ */
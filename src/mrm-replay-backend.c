@@ -0,0 +1,474 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <string.h>
+
+#include "mrm-replay-backend.h"
+#include "mrm-error.h"
+#include "mrm-error-types.h"
+
+static void device_backend_iface_init (MrmDeviceBackendInterface *iface);
+
+G_DEFINE_TYPE_EXTENDED (MrmReplayBackend, mrm_replay_backend, G_TYPE_OBJECT, 0,
+                        G_IMPLEMENT_INTERFACE (MRM_TYPE_DEVICE_BACKEND, device_backend_iface_init))
+
+enum {
+    PROP_0,
+    PROP_FILE,
+    PROP_LOOP,
+    PROP_LAST
+};
+
+static GParamSpec *properties[PROP_LAST];
+
+/* Groups replayed, each one from its own position in the recording, so that
+ * they keep their recorded sequence whatever their poll intervals are */
+static const MrmSampleGroup replay_groups[] = {
+    MRM_SAMPLE_GROUP_SIGNAL,
+    MRM_SAMPLE_GROUP_POWER,
+    MRM_SAMPLE_GROUP_TRAFFIC,
+};
+
+#define N_REPLAY_GROUPS G_N_ELEMENTS (replay_groups)
+
+struct _MrmReplayBackendPrivate {
+    GFile *file;
+    gchar *name;
+    gboolean loop;
+
+    /* Recording as loaded on open, worker only */
+    gchar *manufacturer;
+    gchar *model;
+    gchar *revision;
+    GPtrArray *samples;
+    guint positions[N_REPLAY_GROUPS];
+};
+
+/*****************************************************************************/
+/* Recording format
+ *
+ * A text file with one sample per line, as given by mrm_sample_serialize().
+ * Lines starting with '#' are comments, except for '# manufacturer: ...',
+ * '# model: ...' and '# revision: ...', which give the identity of the
+ * recorded device, as written by MrmRecorder. Recorded timestamps are
+ * ignored: samples are replayed as fast as the device polls for them, while
+ * recorded gaps are replayed as such. */
+
+static void
+recording_clear (MrmReplayBackend *self)
+{
+    g_clear_pointer (&self->priv->manufacturer, g_free);
+    g_clear_pointer (&self->priv->model, g_free);
+    g_clear_pointer (&self->priv->revision, g_free);
+    g_ptr_array_set_size (self->priv->samples, 0);
+}
+
+static void
+recording_parse_comment (MrmReplayBackend *self,
+                         const gchar *line)
+{
+    const gchar *keys[] = { "manufacturer:", "model:", "revision:" };
+    gchar **fields[] = { &self->priv->manufacturer, &self->priv->model, &self->priv->revision };
+    guint i;
+
+    while (g_ascii_isspace (*line))
+        line++;
+
+    for (i = 0; i < G_N_ELEMENTS (keys); i++) {
+        if (g_str_has_prefix (line, keys[i])) {
+            g_free (*fields[i]);
+            *fields[i] = g_strstrip (g_strdup (line + strlen (keys[i])));
+            return;
+        }
+    }
+}
+
+static gboolean
+recording_parse (MrmReplayBackend *self,
+                 const gchar *contents,
+                 GError **error)
+{
+    gchar **lines;
+    guint i;
+
+    recording_clear (self);
+
+    lines = g_strsplit (contents, "\n", -1);
+    for (i = 0; lines[i]; i++) {
+        GError *inner_error = NULL;
+        MrmSample *sample;
+        gchar *line;
+
+        line = g_strchomp (lines[i]);
+        if (!line[0])
+            continue;
+
+        if (line[0] == '#') {
+            recording_parse_comment (self, line + 1);
+            continue;
+        }
+
+        sample = mrm_sample_deserialize (line, &inner_error);
+        if (!sample) {
+            g_propagate_prefixed_error (error, inner_error, "line %u: ", i + 1);
+            g_strfreev (lines);
+            return FALSE;
+        }
+        g_ptr_array_add (self->priv->samples, sample);
+    }
+    g_strfreev (lines);
+
+    if (self->priv->samples->len == 0) {
+        g_set_error (error,
+                     MRM_CORE_ERROR,
+                     MRM_CORE_ERROR_INVALID_ARGS,
+                     "no samples recorded");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Next recorded sample loading the given group, if any left */
+static const MrmSample *
+recording_next (MrmReplayBackend *self,
+                guint group_i)
+{
+    guint n_samples = self->priv->samples->len;
+    guint i;
+
+    for (i = 0; i < n_samples; i++) {
+        const MrmSample *sample;
+        guint position;
+
+        position = self->priv->positions[group_i] + i;
+        if (position >= n_samples) {
+            if (!self->priv->loop)
+                break;
+            position -= n_samples;
+        }
+
+        sample = g_ptr_array_index (self->priv->samples, position);
+        if (sample->groups & replay_groups[group_i]) {
+            self->priv->positions[group_i] = position + 1;
+            return sample;
+        }
+    }
+
+    /* Nothing else to replay for this group */
+    self->priv->positions[group_i] = n_samples;
+    return NULL;
+}
+
+/*****************************************************************************/
+
+static const gchar *
+backend_get_name (MrmDeviceBackend *backend)
+{
+    return MRM_REPLAY_BACKEND (backend)->priv->name;
+}
+
+/*****************************************************************************/
+
+static gboolean
+backend_open_finish (MrmDeviceBackend *backend,
+                     GAsyncResult *res,
+                     gchar **manufacturer,
+                     gchar **model,
+                     gchar **revision,
+                     GError **error)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (backend);
+
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return FALSE;
+
+    *manufacturer = g_strdup (self->priv->manufacturer ? self->priv->manufacturer : "Unknown");
+    *model = g_strdup (self->priv->model ? self->priv->model : "Recording");
+    *revision = g_strdup (self->priv->revision ? self->priv->revision : "Unknown");
+    return TRUE;
+}
+
+static void
+load_contents_ready (GFile *file,
+                     GAsyncResult *res,
+                     GSimpleAsyncResult *simple)
+{
+    MrmReplayBackend *self;
+    GError *error = NULL;
+    gchar *contents = NULL;
+
+    self = MRM_REPLAY_BACKEND (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+
+    if (!g_file_load_contents_finish (file, res, &contents, NULL, NULL, &error) ||
+        !recording_parse (self, contents, &error)) {
+        gchar *path;
+
+        path = g_file_get_path (file);
+        g_prefix_error (&error, "Cannot load recording '%s': ", path);
+        g_simple_async_result_take_error (simple, error);
+        g_free (path);
+    } else {
+        g_debug ("Recording '%s' loaded: %u samples", self->priv->name, self->priv->samples->len);
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    }
+
+    g_free (contents);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+    g_object_unref (self);
+}
+
+static void
+backend_open (MrmDeviceBackend *backend,
+              GCancellable *cancellable,
+              GAsyncReadyCallback callback,
+              gpointer user_data)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (backend);
+
+    g_file_load_contents_async (self->priv->file,
+                                cancellable,
+                                (GAsyncReadyCallback) load_contents_ready,
+                                g_simple_async_result_new (G_OBJECT (backend),
+                                                           callback,
+                                                           user_data,
+                                                           backend_open));
+}
+
+static gboolean
+backend_close_finish (MrmDeviceBackend *backend,
+                      GAsyncResult *res,
+                      GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+backend_close (MrmDeviceBackend *backend,
+               GCancellable *cancellable,
+               GAsyncReadyCallback callback,
+               gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    recording_clear (MRM_REPLAY_BACKEND (backend));
+
+    simple = g_simple_async_result_new (G_OBJECT (backend), callback, user_data, backend_close);
+    g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+}
+
+/*****************************************************************************/
+
+/* Every session replays the recording from the start */
+static void
+backend_start (MrmDeviceBackend *backend)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (backend);
+
+    memset (self->priv->positions, 0, sizeof (self->priv->positions));
+}
+
+static gboolean
+backend_reload_finish (MrmDeviceBackend *backend,
+                       GAsyncResult *res,
+                       MrmSample *sample,
+                       GError **error)
+{
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return FALSE;
+
+    *sample = *((MrmSample *) g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res)));
+    return TRUE;
+}
+
+static void
+backend_reload (MrmDeviceBackend *backend,
+                guint groups,
+                GCancellable *cancellable,
+                GAsyncReadyCallback callback,
+                gpointer user_data)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (backend);
+    GSimpleAsyncResult *simple;
+    MrmSample *sample;
+    guint i;
+
+    sample = mrm_sample_new (0);
+
+    for (i = 0; i < N_REPLAY_GROUPS; i++) {
+        const MrmSample *recorded;
+        guint metric;
+
+        if (!(groups & replay_groups[i]))
+            continue;
+
+        recorded = recording_next (self, i);
+        if (!recorded)
+            continue;
+
+        if (recorded->gap)
+            sample->gap = TRUE;
+
+        for (metric = 0; metric < MRM_SAMPLE_METRIC_LAST; metric++) {
+            gdouble value;
+
+            if (mrm_sample_metric_get_info (metric)->group == replay_groups[i] &&
+                mrm_sample_get_value (recorded, metric, &value))
+                mrm_sample_set_value (sample, metric, value);
+        }
+
+        /* Access technologies are given along with the signal info */
+        if (replay_groups[i] == MRM_SAMPLE_GROUP_SIGNAL || !sample->act)
+            sample->act = recorded->act;
+        sample->groups |= replay_groups[i];
+    }
+
+    simple = g_simple_async_result_new (G_OBJECT (backend), callback, user_data, backend_reload);
+    g_simple_async_result_set_op_res_gpointer (simple, sample, (GDestroyNotify) mrm_sample_free);
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+}
+
+/*****************************************************************************/
+
+MrmDeviceBackend *
+mrm_replay_backend_new (GFile *file,
+                        gboolean loop)
+{
+    return MRM_DEVICE_BACKEND (g_object_new (MRM_TYPE_REPLAY_BACKEND,
+                                             "file", file,
+                                             "loop", loop,
+                                             NULL));
+}
+
+static void
+mrm_replay_backend_init (MrmReplayBackend *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MRM_TYPE_REPLAY_BACKEND, MrmReplayBackendPrivate);
+    self->priv->loop = TRUE;
+    self->priv->samples = g_ptr_array_new_with_free_func ((GDestroyNotify) mrm_sample_free);
+}
+
+static void
+set_property (GObject *object,
+              guint prop_id,
+              const GValue *value,
+              GParamSpec *pspec)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (object);
+
+    switch (prop_id) {
+    case PROP_FILE:
+        g_assert (self->priv->file == NULL);
+        self->priv->file = g_value_dup_object (value);
+        if (self->priv->file)
+            self->priv->name = g_file_get_basename (self->priv->file);
+        break;
+    case PROP_LOOP:
+        self->priv->loop = g_value_get_boolean (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject *object,
+              guint prop_id,
+              GValue *value,
+              GParamSpec *pspec)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (object);
+
+    switch (prop_id) {
+    case PROP_FILE:
+        g_value_set_object (value, self->priv->file);
+        break;
+    case PROP_LOOP:
+        g_value_set_boolean (value, self->priv->loop);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+dispose (GObject *object)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (object);
+
+    g_clear_object (&self->priv->file);
+
+    G_OBJECT_CLASS (mrm_replay_backend_parent_class)->dispose (object);
+}
+
+static void
+finalize (GObject *object)
+{
+    MrmReplayBackend *self = MRM_REPLAY_BACKEND (object);
+
+    recording_clear (self);
+    g_ptr_array_unref (self->priv->samples);
+    g_free (self->priv->name);
+
+    G_OBJECT_CLASS (mrm_replay_backend_parent_class)->finalize (object);
+}
+
+static void
+device_backend_iface_init (MrmDeviceBackendInterface *iface)
+{
+    iface->get_name = backend_get_name;
+    iface->open = backend_open;
+    iface->open_finish = backend_open_finish;
+    iface->close = backend_close;
+    iface->close_finish = backend_close_finish;
+    iface->start = backend_start;
+    iface->reload = backend_reload;
+    iface->reload_finish = backend_reload_finish;
+}
+
+static void
+mrm_replay_backend_class_init (MrmReplayBackendClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MrmReplayBackendPrivate));
+
+    object_class->get_property = get_property;
+    object_class->set_property = set_property;
+    object_class->dispose = dispose;
+    object_class->finalize = finalize;
+
+    properties[PROP_FILE] =
+        g_param_spec_object ("file",
+                             "File",
+                             "Recording to replay",
+                             G_TYPE_FILE,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_FILE, properties[PROP_FILE]);
+
+    properties[PROP_LOOP] =
+        g_param_spec_boolean ("loop",
+                              "Loop",
+                              "Whether the recording starts over once replayed",
+                              TRUE,
+                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_LOOP, properties[PROP_LOOP]);
+}
@@ -0,0 +1,52 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_REPLAY_BACKEND_H__
+#define __MRM_REPLAY_BACKEND_H__
+
+#include <gio/gio.h>
+
+#include "mrm-device-backend.h"
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_REPLAY_BACKEND         (mrm_replay_backend_get_type ())
+#define MRM_REPLAY_BACKEND(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), MRM_TYPE_REPLAY_BACKEND, MrmReplayBackend))
+#define MRM_REPLAY_BACKEND_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST ((k), MRM_TYPE_REPLAY_BACKEND, MrmReplayBackendClass))
+#define MRM_IS_REPLAY_BACKEND(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), MRM_TYPE_REPLAY_BACKEND))
+#define MRM_IS_REPLAY_BACKEND_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), MRM_TYPE_REPLAY_BACKEND))
+#define MRM_REPLAY_BACKEND_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), MRM_TYPE_REPLAY_BACKEND, MrmReplayBackendClass))
+
+typedef struct _MrmReplayBackend        MrmReplayBackend;
+typedef struct _MrmReplayBackendClass   MrmReplayBackendClass;
+typedef struct _MrmReplayBackendPrivate MrmReplayBackendPrivate;
+
+struct _MrmReplayBackend {
+    GObject parent_instance;
+    MrmReplayBackendPrivate *priv;
+};
+
+struct _MrmReplayBackendClass {
+    GObjectClass parent_class;
+};
+
+GType mrm_replay_backend_get_type (void) G_GNUC_CONST;
+
+MrmDeviceBackend *mrm_replay_backend_new (GFile *file,
+                                          gboolean loop);
+
+G_END_DECLS
+
+#endif /* __MRM_REPLAY_BACKEND_H__ */
@@ -0,0 +1,291 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <string.h>
+
+#include "mrm-sample.h"
+#include "mrm-device.h"
+#include "mrm-error.h"
+#include "mrm-error-types.h"
+
+/* The validity mask must be able to hold all metrics */
+G_STATIC_ASSERT (MRM_SAMPLE_METRIC_LAST <= 64);
+
+G_DEFINE_BOXED_TYPE (MrmSample, mrm_sample, mrm_sample_copy, mrm_sample_free)
+
+/*****************************************************************************/
+/* Metric descriptions */
+
+#define METRIC(ACT, KIND, GROUP)                                          \
+    [MRM_SAMPLE_METRIC_##ACT##_##KIND] = { #ACT " " #KIND, MRM_DEVICE_ACT_##ACT, \
+                                           MRM_SAMPLE_KIND_##KIND, MRM_SAMPLE_GROUP_##GROUP }
+
+/* Metrics of the data connection, regardless of the access technology */
+#define DATA_METRIC(KIND, GROUP)                                          \
+    [MRM_SAMPLE_METRIC_##KIND] = { #KIND, 0,                             \
+                                   MRM_SAMPLE_KIND_##KIND, MRM_SAMPLE_GROUP_##GROUP }
+
+static const MrmSampleMetricInfo metric_info[MRM_SAMPLE_METRIC_LAST] = {
+    METRIC (GSM,  RSSI,       SIGNAL),
+    METRIC (UMTS, RSSI,       SIGNAL),
+    METRIC (LTE,  RSSI,       SIGNAL),
+    METRIC (CDMA, RSSI,       SIGNAL),
+    METRIC (EVDO, RSSI,       SIGNAL),
+    METRIC (UMTS, ECIO,       SIGNAL),
+    METRIC (CDMA, ECIO,       SIGNAL),
+    METRIC (EVDO, ECIO,       SIGNAL),
+    METRIC (EVDO, SINR_LEVEL, SIGNAL),
+    METRIC (EVDO, IO,         SIGNAL),
+    METRIC (LTE,  RSRQ,       SIGNAL),
+    METRIC (LTE,  RSRP,       SIGNAL),
+    METRIC (LTE,  SNR,        SIGNAL),
+    METRIC (NR5G, RSRQ,       SIGNAL),
+    METRIC (NR5G, RSRP,       SIGNAL),
+    METRIC (NR5G, SNR,        SIGNAL),
+    METRIC (GSM,  RX0,        POWER),
+    METRIC (UMTS, RX0,        POWER),
+    METRIC (LTE,  RX0,        POWER),
+    METRIC (CDMA, RX0,        POWER),
+    METRIC (EVDO, RX0,        POWER),
+    METRIC (NR5G, RX0,        POWER),
+    METRIC (GSM,  RX1,        POWER),
+    METRIC (UMTS, RX1,        POWER),
+    METRIC (LTE,  RX1,        POWER),
+    METRIC (CDMA, RX1,        POWER),
+    METRIC (EVDO, RX1,        POWER),
+    METRIC (NR5G, RX1,        POWER),
+    METRIC (GSM,  TX,         POWER),
+    METRIC (UMTS, TX,         POWER),
+    METRIC (LTE,  TX,         POWER),
+    METRIC (CDMA, TX,         POWER),
+    METRIC (EVDO, TX,         POWER),
+    METRIC (NR5G, TX,         POWER),
+    DATA_METRIC (TX_RATE,        TRAFFIC),
+    DATA_METRIC (RX_RATE,        TRAFFIC),
+    DATA_METRIC (TX_PACKET_RATE, TRAFFIC),
+    DATA_METRIC (RX_PACKET_RATE, TRAFFIC),
+    DATA_METRIC (TX_DROP_RATE,   TRAFFIC),
+    DATA_METRIC (RX_DROP_RATE,   TRAFFIC),
+};
+
+#undef METRIC
+#undef DATA_METRIC
+
+const MrmSampleMetricInfo *
+mrm_sample_metric_get_info (MrmSampleMetric metric)
+{
+    g_return_val_if_fail (metric < MRM_SAMPLE_METRIC_LAST, NULL);
+
+    /* Every metric must be described */
+    g_assert (metric_info[metric].name);
+    return &metric_info[metric];
+}
+
+/* Returns MRM_SAMPLE_METRIC_LAST if there is no such metric for the given
+ * access technology */
+MrmSampleMetric
+mrm_sample_metric_find (guint act,
+                        MrmSampleKind kind)
+{
+    guint i;
+
+    for (i = 0; i < MRM_SAMPLE_METRIC_LAST; i++) {
+        if (metric_info[i].act == act && metric_info[i].kind == kind)
+            return i;
+    }
+    return MRM_SAMPLE_METRIC_LAST;
+}
+
+/* Returns MRM_SAMPLE_METRIC_LAST if there is no metric with the given name */
+MrmSampleMetric
+mrm_sample_metric_lookup (const gchar *name)
+{
+    guint i;
+
+    for (i = 0; i < MRM_SAMPLE_METRIC_LAST; i++) {
+        if (g_str_equal (metric_info[i].name, name))
+            return i;
+    }
+    return MRM_SAMPLE_METRIC_LAST;
+}
+
+/*****************************************************************************/
+
+void
+mrm_sample_set_value (MrmSample *self,
+                      MrmSampleMetric metric,
+                      gdouble value)
+{
+    g_return_if_fail (metric < MRM_SAMPLE_METRIC_LAST);
+
+    self->values[metric] = value;
+    self->valid |= (G_GUINT64_CONSTANT (1) << metric);
+}
+
+gboolean
+mrm_sample_get_value (const MrmSample *self,
+                      MrmSampleMetric metric,
+                      gdouble *value)
+{
+    g_return_val_if_fail (metric < MRM_SAMPLE_METRIC_LAST, FALSE);
+
+    if (!(self->valid & (G_GUINT64_CONSTANT (1) << metric)))
+        return FALSE;
+
+    if (value)
+        *value = self->values[metric];
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+MrmSample *
+mrm_sample_new (gint64 timestamp)
+{
+    MrmSample *self;
+
+    self = g_slice_new0 (MrmSample);
+    self->timestamp = timestamp;
+    return self;
+}
+
+MrmSample *
+mrm_sample_copy (const MrmSample *self)
+{
+    return g_slice_dup (MrmSample, self);
+}
+
+void
+mrm_sample_free (MrmSample *self)
+{
+    g_slice_free (MrmSample, self);
+}
+
+/*****************************************************************************/
+/* Serialization
+ *
+ * A sample is written as a single line of tab separated fields: timestamp,
+ * groups and access technologies, followed by a bare 'gap' field if sampling
+ * was interrupted, and one 'name=value' field per valid metric. Values are
+ * always written in the C locale. */
+
+gchar *
+mrm_sample_serialize (const MrmSample *self)
+{
+    GString *str;
+    guint i;
+
+    str = g_string_new (NULL);
+    g_string_append_printf (str, "%" G_GINT64_FORMAT "\t%u\t%u",
+                            self->timestamp, self->groups, self->act);
+
+    if (self->gap)
+        g_string_append (str, "\tgap");
+
+    for (i = 0; i < MRM_SAMPLE_METRIC_LAST; i++) {
+        gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+        if (!(self->valid & (G_GUINT64_CONSTANT (1) << i)))
+            continue;
+
+        g_string_append_printf (str, "\t%s=%s",
+                                metric_info[i].name,
+                                g_ascii_dtostr (buffer, sizeof (buffer), self->values[i]));
+    }
+
+    return g_string_free (str, FALSE);
+}
+
+static gboolean
+parse_uint (const gchar *str,
+            guint *out)
+{
+    guint64 value;
+    gchar *end;
+
+    value = g_ascii_strtoull (str, &end, 10);
+    if (end == str || *end || value > G_MAXUINT)
+        return FALSE;
+
+    *out = (guint) value;
+    return TRUE;
+}
+
+MrmSample *
+mrm_sample_deserialize (const gchar *line,
+                        GError **error)
+{
+    MrmSample *self;
+    gchar **fields;
+    gint64 timestamp;
+    guint groups;
+    guint act;
+    gchar *end;
+    guint i;
+
+    fields = g_strsplit (line, "\t", -1);
+    if (g_strv_length (fields) < 3) {
+        g_set_error (error, MRM_CORE_ERROR, MRM_CORE_ERROR_INVALID_ARGS,
+                     "Missing sample header fields");
+        g_strfreev (fields);
+        return NULL;
+    }
+
+    timestamp = g_ascii_strtoll (fields[0], &end, 10);
+    if (end == fields[0] || *end ||
+        !parse_uint (fields[1], &groups) ||
+        !parse_uint (fields[2], &act)) {
+        g_set_error (error, MRM_CORE_ERROR, MRM_CORE_ERROR_INVALID_ARGS,
+                     "Invalid sample header fields");
+        g_strfreev (fields);
+        return NULL;
+    }
+
+    self = mrm_sample_new (timestamp);
+    self->reply_timestamp = timestamp;
+    self->groups = groups;
+    self->act = act;
+
+    for (i = 3; fields[i]; i++) {
+        MrmSampleMetric metric = MRM_SAMPLE_METRIC_LAST;
+        gchar *value;
+        gdouble d = 0.0;
+
+        if (g_str_equal (fields[i], "gap")) {
+            self->gap = TRUE;
+            continue;
+        }
+
+        value = strchr (fields[i], '=');
+        if (value) {
+            *value++ = '\0';
+            metric = mrm_sample_metric_lookup (fields[i]);
+            d = g_ascii_strtod (value, &end);
+        }
+
+        if (metric == MRM_SAMPLE_METRIC_LAST || end == value || *end) {
+            g_set_error (error, MRM_CORE_ERROR, MRM_CORE_ERROR_INVALID_ARGS,
+                         "Invalid metric field '%s'", fields[i]);
+            mrm_sample_free (self);
+            g_strfreev (fields);
+            return NULL;
+        }
+
+        mrm_sample_set_value (self, metric, d);
+    }
+
+    g_strfreev (fields);
+    return self;
+}
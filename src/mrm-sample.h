@@ -0,0 +1,164 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_SAMPLE_H__
+#define __MRM_SAMPLE_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_SAMPLE (mrm_sample_get_type ())
+
+typedef enum {
+    MRM_SAMPLE_METRIC_GSM_RSSI,
+    MRM_SAMPLE_METRIC_UMTS_RSSI,
+    MRM_SAMPLE_METRIC_LTE_RSSI,
+    MRM_SAMPLE_METRIC_CDMA_RSSI,
+    MRM_SAMPLE_METRIC_EVDO_RSSI,
+    MRM_SAMPLE_METRIC_UMTS_ECIO,
+    MRM_SAMPLE_METRIC_CDMA_ECIO,
+    MRM_SAMPLE_METRIC_EVDO_ECIO,
+    MRM_SAMPLE_METRIC_EVDO_SINR_LEVEL,
+    MRM_SAMPLE_METRIC_EVDO_IO,
+    MRM_SAMPLE_METRIC_LTE_RSRQ,
+    MRM_SAMPLE_METRIC_LTE_RSRP,
+    MRM_SAMPLE_METRIC_LTE_SNR,
+    MRM_SAMPLE_METRIC_NR5G_RSRQ,
+    MRM_SAMPLE_METRIC_NR5G_RSRP,
+    MRM_SAMPLE_METRIC_NR5G_SNR,
+    MRM_SAMPLE_METRIC_GSM_RX0,
+    MRM_SAMPLE_METRIC_UMTS_RX0,
+    MRM_SAMPLE_METRIC_LTE_RX0,
+    MRM_SAMPLE_METRIC_CDMA_RX0,
+    MRM_SAMPLE_METRIC_EVDO_RX0,
+    MRM_SAMPLE_METRIC_NR5G_RX0,
+    MRM_SAMPLE_METRIC_GSM_RX1,
+    MRM_SAMPLE_METRIC_UMTS_RX1,
+    MRM_SAMPLE_METRIC_LTE_RX1,
+    MRM_SAMPLE_METRIC_CDMA_RX1,
+    MRM_SAMPLE_METRIC_EVDO_RX1,
+    MRM_SAMPLE_METRIC_NR5G_RX1,
+    MRM_SAMPLE_METRIC_GSM_TX,
+    MRM_SAMPLE_METRIC_UMTS_TX,
+    MRM_SAMPLE_METRIC_LTE_TX,
+    MRM_SAMPLE_METRIC_CDMA_TX,
+    MRM_SAMPLE_METRIC_EVDO_TX,
+    MRM_SAMPLE_METRIC_NR5G_TX,
+    MRM_SAMPLE_METRIC_TX_RATE,
+    MRM_SAMPLE_METRIC_RX_RATE,
+    MRM_SAMPLE_METRIC_TX_PACKET_RATE,
+    MRM_SAMPLE_METRIC_RX_PACKET_RATE,
+    MRM_SAMPLE_METRIC_TX_DROP_RATE,
+    MRM_SAMPLE_METRIC_RX_DROP_RATE,
+    MRM_SAMPLE_METRIC_LAST
+} MrmSampleMetric;
+
+/* Groups of metrics that are loaded together */
+typedef enum {
+    MRM_SAMPLE_GROUP_SIGNAL    = 1 << 0,
+    MRM_SAMPLE_GROUP_POWER     = 1 << 1,
+    MRM_SAMPLE_GROUP_NEIGHBORS = 1 << 2,
+    MRM_SAMPLE_GROUP_TRAFFIC   = 1 << 3,
+    MRM_SAMPLE_GROUP_CARRIERS  = 1 << 4,
+} MrmSampleGroup;
+
+/* What each metric measures, regardless of the access technology */
+typedef enum {
+    MRM_SAMPLE_KIND_RSSI,
+    MRM_SAMPLE_KIND_ECIO,
+    MRM_SAMPLE_KIND_SINR_LEVEL,
+    MRM_SAMPLE_KIND_IO,
+    MRM_SAMPLE_KIND_RSRQ,
+    MRM_SAMPLE_KIND_RSRP,
+    MRM_SAMPLE_KIND_SNR,
+    MRM_SAMPLE_KIND_RX0,
+    MRM_SAMPLE_KIND_RX1,
+    MRM_SAMPLE_KIND_TX,
+    MRM_SAMPLE_KIND_TX_RATE,        /* kbps */
+    MRM_SAMPLE_KIND_RX_RATE,        /* kbps */
+    MRM_SAMPLE_KIND_TX_PACKET_RATE, /* packets/s */
+    MRM_SAMPLE_KIND_RX_PACKET_RATE, /* packets/s */
+    MRM_SAMPLE_KIND_TX_DROP_RATE,   /* packets/s */
+    MRM_SAMPLE_KIND_RX_DROP_RATE,   /* packets/s */
+} MrmSampleKind;
+
+/**
+ * MrmSampleMetricInfo:
+ * @name: a short name for the metric.
+ * @act: the #MrmDeviceAct the metric applies to, or 0 if it doesn't depend on
+ *  the access technology.
+ * @kind: a #MrmSampleKind.
+ * @group: the #MrmSampleGroup the metric is loaded with.
+ *
+ * Static description of a #MrmSampleMetric, so that metrics can be handled
+ * generically instead of one access technology at a time.
+ */
+typedef struct {
+    const gchar *name;
+    guint act;
+    MrmSampleKind kind;
+    MrmSampleGroup group;
+} MrmSampleMetricInfo;
+
+/**
+ * MrmSample:
+ * @timestamp: monotonic time when the sample was requested, in microseconds.
+ * @reply_timestamp: monotonic time when the last reply for the sample was
+ *  received, in microseconds.
+ * @groups: mask of #MrmSampleGroup values loaded in this sample.
+ * @act: mask of #MrmDeviceAct values active when the sample was taken.
+ * @valid: mask of #MrmSampleMetric values with a valid value.
+ * @gap: whether sampling was interrupted at this point, e.g. because the
+ *  device got disconnected; such samples have no valid values.
+ * @values: metric values, only meaningful if flagged in @valid.
+ *
+ * A consistent snapshot of all the metrics loaded in a single cycle.
+ */
+typedef struct {
+    gint64 timestamp;
+    gint64 reply_timestamp;
+    guint groups;
+    guint act;
+    guint64 valid;
+    gboolean gap;
+    gdouble values[MRM_SAMPLE_METRIC_LAST];
+} MrmSample;
+
+GType mrm_sample_get_type (void) G_GNUC_CONST;
+
+MrmSample *mrm_sample_new  (gint64 timestamp);
+MrmSample *mrm_sample_copy (const MrmSample *self);
+void       mrm_sample_free (MrmSample *self);
+
+void     mrm_sample_set_value (MrmSample *self,
+                               MrmSampleMetric metric,
+                               gdouble value);
+gboolean mrm_sample_get_value (const MrmSample *self,
+                               MrmSampleMetric metric,
+                               gdouble *value);
+
+const MrmSampleMetricInfo *mrm_sample_metric_get_info (MrmSampleMetric metric);
+MrmSampleMetric            mrm_sample_metric_find     (guint act,
+                                                       MrmSampleKind kind);
+MrmSampleMetric            mrm_sample_metric_lookup   (const gchar *name);
+
+gchar     *mrm_sample_serialize   (const MrmSample *self);
+MrmSample *mrm_sample_deserialize (const gchar *line,
+                                   GError **error);
+
+G_END_DECLS
+
+#endif /* __MRM_SAMPLE_H__ */
@@ -0,0 +1,108 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include "mrm-serving-cell.h"
+#include "mrm-device.h"
+
+G_DEFINE_BOXED_TYPE (MrmServingCell, mrm_serving_cell, mrm_serving_cell_copy, mrm_serving_cell_free)
+
+/*****************************************************************************/
+
+void
+mrm_serving_cell_init (MrmServingCell *self,
+                       gint64 timestamp)
+{
+    self->timestamp = timestamp;
+    self->act = 0;
+    self->band = MRM_SERVING_CELL_UNKNOWN;
+    self->channel = MRM_SERVING_CELL_UNKNOWN;
+    self->pci = MRM_SERVING_CELL_UNKNOWN;
+    self->cell_id = MRM_SERVING_CELL_UNKNOWN;
+    self->area_code = MRM_SERVING_CELL_UNKNOWN;
+}
+
+/* The time it was seen doesn't make a different cell */
+gboolean
+mrm_serving_cell_equal (const MrmServingCell *a,
+                        const MrmServingCell *b)
+{
+    return (a->act == b->act &&
+            a->band == b->band &&
+            a->channel == b->channel &&
+            a->pci == b->pci &&
+            a->cell_id == b->cell_id &&
+            a->area_code == b->area_code);
+}
+
+gchar *
+mrm_serving_cell_build_label (const MrmServingCell *self)
+{
+    GString *str;
+
+    switch (self->act) {
+    case 0:
+        return g_strdup ("No service");
+    case MRM_DEVICE_ACT_LTE:
+        str = g_string_new ("LTE");
+        if (self->pci != MRM_SERVING_CELL_UNKNOWN)
+            g_string_append_printf (str, " PCI %u", self->pci);
+        break;
+    case MRM_DEVICE_ACT_UMTS:
+        str = g_string_new ("UMTS");
+        if (self->pci != MRM_SERVING_CELL_UNKNOWN)
+            g_string_append_printf (str, " PSC %u", self->pci);
+        break;
+    case MRM_DEVICE_ACT_GSM:
+        str = g_string_new ("GSM");
+        break;
+    case MRM_DEVICE_ACT_CDMA:
+        str = g_string_new ("CDMA");
+        break;
+    case MRM_DEVICE_ACT_EVDO:
+        str = g_string_new ("EVDO");
+        break;
+    case MRM_DEVICE_ACT_NR5G:
+        str = g_string_new ("5G NR");
+        if (self->pci != MRM_SERVING_CELL_UNKNOWN)
+            g_string_append_printf (str, " PCI %u", self->pci);
+        break;
+    default:
+        str = g_string_new ("");
+        break;
+    }
+
+    if (self->band != MRM_SERVING_CELL_UNKNOWN)
+        g_string_append_printf (str, " %s", qmi_nas_active_band_get_string ((QmiNasActiveBand) self->band));
+    if (self->channel != MRM_SERVING_CELL_UNKNOWN)
+        g_string_append_printf (str, " ch %u", self->channel);
+    if (self->cell_id != MRM_SERVING_CELL_UNKNOWN)
+        g_string_append_printf (str, " cell %X", self->cell_id);
+
+    return g_string_free (str, FALSE);
+}
+
+/*****************************************************************************/
+
+MrmServingCell *
+mrm_serving_cell_copy (const MrmServingCell *self)
+{
+    return g_slice_dup (MrmServingCell, self);
+}
+
+void
+mrm_serving_cell_free (MrmServingCell *self)
+{
+    g_slice_free (MrmServingCell, self);
+}
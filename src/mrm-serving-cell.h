@@ -0,0 +1,65 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_SERVING_CELL_H__
+#define __MRM_SERVING_CELL_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_SERVING_CELL (mrm_serving_cell_get_type ())
+
+/* Value of the fields not reported by the modem */
+#define MRM_SERVING_CELL_UNKNOWN G_MAXUINT32
+
+/**
+ * MrmServingCell:
+ * @timestamp: monotonic time when the serving cell was first seen, in
+ *  microseconds.
+ * @act: the #MrmDeviceAct value of the serving cell, or 0 if none.
+ * @band: the #QmiNasActiveBand in use.
+ * @channel: EARFCN in LTE, UARFCN in UMTS, ARFCN in GSM.
+ * @pci: PCI in LTE, PSC in UMTS.
+ * @cell_id: global cell ID.
+ * @area_code: TAC in LTE, LAC otherwise.
+ *
+ * Identity of the serving cell. All fields but @timestamp and @act may be
+ * %MRM_SERVING_CELL_UNKNOWN.
+ */
+typedef struct {
+    gint64 timestamp;
+    guint act;
+    guint32 band;
+    guint32 channel;
+    guint32 pci;
+    guint32 cell_id;
+    guint32 area_code;
+} MrmServingCell;
+
+GType mrm_serving_cell_get_type (void) G_GNUC_CONST;
+
+MrmServingCell *mrm_serving_cell_copy (const MrmServingCell *self);
+void            mrm_serving_cell_free (MrmServingCell *self);
+
+void      mrm_serving_cell_init        (MrmServingCell *self,
+                                        gint64 timestamp);
+gboolean  mrm_serving_cell_equal       (const MrmServingCell *a,
+                                        const MrmServingCell *b);
+gchar    *mrm_serving_cell_build_label (const MrmServingCell *self);
+
+G_END_DECLS
+
+#endif /* __MRM_SERVING_CELL_H__ */
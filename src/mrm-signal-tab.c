@@ -27,6 +27,20 @@ struct _MrmSignalTabPrivate {
     MrmDevice *current;
 
     guint act_updated_id;
+    guint sample_id;
+    guint serving_cell_changed_id;
+    guint carriers_id;
+
+    /* Last LTE carrier sample and how long it applies to the signal samples
+     * that follow, and the secondary cell series set up in each graph, as a
+     * mask of cell indices */
+    MrmCarrierSample *carriers;
+    gint64 carriers_max_age;
+    guint rsrq_scells;
+    guint rsrp_scells;
+    guint snr_scells;
+    guint poll_interval_updated_id;
+    guint carrier_poll_interval_updated_id;
 
     GtkWidget *legend_gsm_box;
     GtkWidget *legend_gsm_icon;
@@ -56,39 +70,79 @@ struct _MrmSignalTabPrivate {
     GtkWidget *legend_evdo_sinr_level_value_label;
     GtkWidget *legend_evdo_io_value_label;
 
+    GtkWidget *legend_nr5g_box;
+    GtkWidget *legend_nr5g_icon;
+    GtkWidget *legend_nr5g_rsrq_value_label;
+    GtkWidget *legend_nr5g_rsrp_value_label;
+    GtkWidget *legend_nr5g_snr_value_label;
+
     GtkWidget *rssi_graph;
     GtkWidget *rssi_graph_frame;
-    guint rssi_graph_updated_id;
 
     GtkWidget *ecio_graph;
     GtkWidget *ecio_graph_frame;
-    guint ecio_graph_updated_id;
 
     GtkWidget *sinr_level_graph;
     GtkWidget *sinr_level_graph_frame;
-    guint sinr_level_graph_updated_id;
 
     GtkWidget *io_graph;
     GtkWidget *io_graph_frame;
-    guint io_graph_updated_id;
 
     GtkWidget *rsrq_graph;
     GtkWidget *rsrq_graph_frame;
-    guint rsrq_graph_updated_id;
 
     GtkWidget *rsrp_graph;
     GtkWidget *rsrp_graph_frame;
-    guint rsrp_graph_updated_id;
 
     GtkWidget *snr_graph;
     GtkWidget *snr_graph_frame;
-    guint snr_graph_updated_id;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (MrmSignalTab, mrm_signal_tab, GTK_TYPE_BOX)
 
 /******************************************************************************/
 
+static void
+poll_interval_updated (MrmDevice *device,
+                       GParamSpec *pspec,
+                       MrmSignalTab *self)
+{
+    guint interval_ms;
+
+    /* Signal info reported via indications comes at no fixed interval, so
+     * the device gives a nominal one for the span of the graphs */
+    g_object_get (device, "signal-sample-interval-ms", &interval_ms, NULL);
+    g_object_set (self->priv->rssi_graph,       "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->ecio_graph,       "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->sinr_level_graph, "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->io_graph,         "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->rsrq_graph,       "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->rsrp_graph,       "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->snr_graph,        "step-duration-ms", interval_ms, NULL);
+}
+
+/* Carriers are loaded on their own, slower, schedule; they apply to the signal
+ * samples taken until the next ones are due, allowing for one missed cycle */
+static void
+carrier_poll_interval_updated (MrmDevice *device,
+                               GParamSpec *pspec,
+                               MrmSignalTab *self)
+{
+    guint interval_ms;
+
+    g_object_get (device, "carrier-poll-interval-ms", &interval_ms, NULL);
+    self->priv->carriers_max_age = 2 * ((gint64) interval_ms) * 1000;
+}
+
+static gdouble
+sample_value (const MrmSample *sample,
+              MrmSampleMetric metric)
+{
+    gdouble value;
+
+    return mrm_sample_get_value (sample, metric, &value) ? value : -G_MAXDOUBLE;
+}
+
 static void
 act_updated (MrmDevice *device,
              MrmDeviceAct act,
@@ -104,11 +158,14 @@ act_updated (MrmDevice *device,
     gtk_widget_set_sensitive (self->priv->io_graph_frame,
                               (act & (MRM_DEVICE_ACT_EVDO)));
     gtk_widget_set_sensitive (self->priv->rsrq_graph_frame,
-                              (act & (MRM_DEVICE_ACT_LTE)));
+                              (act & (MRM_DEVICE_ACT_LTE |
+                                      MRM_DEVICE_ACT_NR5G)));
     gtk_widget_set_sensitive (self->priv->rsrp_graph_frame,
-                              (act & (MRM_DEVICE_ACT_LTE)));
+                              (act & (MRM_DEVICE_ACT_LTE |
+                                      MRM_DEVICE_ACT_NR5G)));
     gtk_widget_set_sensitive (self->priv->snr_graph_frame,
-                              (act & (MRM_DEVICE_ACT_LTE)));
+                              (act & (MRM_DEVICE_ACT_LTE |
+                                      MRM_DEVICE_ACT_NR5G)));
 
     gtk_widget_set_sensitive (self->priv->legend_gsm_box,
                               (act & MRM_DEVICE_ACT_GSM));
@@ -120,6 +177,8 @@ act_updated (MrmDevice *device,
                               (act & MRM_DEVICE_ACT_CDMA));
     gtk_widget_set_sensitive (self->priv->legend_evdo_box,
                               (act & MRM_DEVICE_ACT_EVDO));
+    gtk_widget_set_sensitive (self->priv->legend_nr5g_box,
+                              (act & MRM_DEVICE_ACT_NR5G));
 }
 
 typedef enum {
@@ -131,34 +190,29 @@ typedef enum {
 } SeriesRssi;
 
 static void
-rssi_updated (MrmDevice *device,
-              gdouble gsm_rssi,
-              gdouble umts_rssi,
-              gdouble lte_rssi,
-              gdouble cdma_rssi,
-              gdouble evdo_rssi,
-              MrmSignalTab *self)
+rssi_updated (MrmSignalTab *self,
+              const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->rssi_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->rssi_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rssi_graph),
                               SERIES_RSSI_GSM,
-                              gsm_rssi,
+                              sample_value (sample, MRM_SAMPLE_METRIC_GSM_RSSI),
                               GTK_LABEL (self->priv->legend_gsm_rssi_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rssi_graph),
                               SERIES_RSSI_UMTS,
-                              umts_rssi,
+                              sample_value (sample, MRM_SAMPLE_METRIC_UMTS_RSSI),
                               GTK_LABEL (self->priv->legend_umts_rssi_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rssi_graph),
                               SERIES_RSSI_LTE,
-                              lte_rssi,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_RSSI),
                               GTK_LABEL (self->priv->legend_lte_rssi_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rssi_graph),
                               SERIES_RSSI_CDMA,
-                              cdma_rssi,
+                              sample_value (sample, MRM_SAMPLE_METRIC_CDMA_RSSI),
                               GTK_LABEL (self->priv->legend_cdma_rssi_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rssi_graph),
                               SERIES_RSSI_EVDO,
-                              evdo_rssi,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_RSSI),
                               GTK_LABEL (self->priv->legend_cdma_rssi_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->rssi_graph));
 }
@@ -170,24 +224,21 @@ typedef enum {
 } SeriesEcio;
 
 static void
-ecio_updated (MrmDevice *device,
-              gdouble umts_ecio,
-              gdouble cdma_ecio,
-              gdouble evdo_ecio,
-              MrmSignalTab *self)
+ecio_updated (MrmSignalTab *self,
+              const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->ecio_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->ecio_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->ecio_graph),
                               SERIES_ECIO_UMTS,
-                              umts_ecio,
+                              sample_value (sample, MRM_SAMPLE_METRIC_UMTS_ECIO),
                               GTK_LABEL (self->priv->legend_umts_ecio_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->ecio_graph),
                               SERIES_ECIO_CDMA,
-                              cdma_ecio,
+                              sample_value (sample, MRM_SAMPLE_METRIC_CDMA_ECIO),
                               GTK_LABEL (self->priv->legend_cdma_ecio_value_label));
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->ecio_graph),
                               SERIES_ECIO_EVDO,
-                              evdo_ecio,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_ECIO),
                               GTK_LABEL (self->priv->legend_evdo_ecio_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->ecio_graph));
 }
@@ -197,14 +248,13 @@ typedef enum {
 } SeriesSinrLevel;
 
 static void
-sinr_level_updated (MrmDevice *device,
-                    gdouble evdo_sinr_level,
-                    MrmSignalTab *self)
+sinr_level_updated (MrmSignalTab *self,
+                    const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->sinr_level_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->sinr_level_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->sinr_level_graph),
                               SERIES_SINR_LEVEL_EVDO,
-                              evdo_sinr_level,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_SINR_LEVEL),
                               GTK_LABEL (self->priv->legend_evdo_sinr_level_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->sinr_level_graph));
 }
@@ -214,73 +264,255 @@ typedef enum {
 } SeriesIo;
 
 static void
-io_updated (MrmDevice *device,
-            gdouble evdo_io,
-            MrmSignalTab *self)
+io_updated (MrmSignalTab *self,
+            const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->io_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->io_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->io_graph),
                               SERIES_IO_EVDO,
-                              evdo_io,
+                              sample_value (sample, MRM_SAMPLE_METRIC_EVDO_IO),
                               GTK_LABEL (self->priv->legend_evdo_io_value_label));
     mrm_graph_step_finish (MRM_GRAPH (self->priv->io_graph));
 }
 
+/* Secondary cells get their own series in the LTE graphs, after the ones
+ * of each access technology and indexed by cell index; set up only once
+ * seen */
+#define MAX_SCELL_INDEX 7
+#define SERIES_SCELL_FIRST 2
+
+static const guint8 scell_colors[][3] = {
+    { 0,   153, 153 }, /* teal */
+    { 102, 102, 0   }, /* olive */
+    { 102, 178, 255 }, /* light blue */
+    { 153, 76,  0   }, /* brown */
+    { 255, 102, 178 }, /* pink */
+    { 128, 128, 128 }, /* gray */
+    { 0,   0,   0   }, /* black */
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (scell_colors) == MAX_SCELL_INDEX);
+
+typedef enum {
+    CARRIER_VALUE_RSRQ,
+    CARRIER_VALUE_RSRP,
+    CARRIER_VALUE_SNR,
+} CarrierValue;
+
+static gint16
+carrier_get_value (const MrmCarrier *carrier,
+                   CarrierValue which)
+{
+    switch (which) {
+    case CARRIER_VALUE_RSRQ:
+        return carrier->rsrq;
+    case CARRIER_VALUE_RSRP:
+        return carrier->rsrp;
+    case CARRIER_VALUE_SNR:
+        return carrier->snr;
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+/* Must be called between the step init and finish of the graph */
+static void
+scells_updated (MrmSignalTab *self,
+                MrmGraph *graph,
+                guint *scells,
+                CarrierValue which,
+                const MrmSample *sample)
+{
+    const MrmCarrierSample *carriers = NULL;
+    guint i;
+
+    /* Only carriers recent enough apply to the sample */
+    if (self->priv->carriers &&
+        sample->timestamp - self->priv->carriers->timestamp <= self->priv->carriers_max_age)
+        carriers = self->priv->carriers;
+
+    for (i = 0; carriers && i < carriers->n_carriers; i++) {
+        const MrmCarrier *carrier = &carriers->carriers[i];
+        gchar *label;
+
+        if (carrier->index == 0 || carrier->index > MAX_SCELL_INDEX)
+            continue;
+        if (carrier_get_value (carrier, which) == MRM_CARRIER_VALUE_UNKNOWN)
+            continue;
+        if (*scells & (1 << carrier->index))
+            continue;
+
+        label = g_strdup_printf ("SCell %u", carrier->index);
+        mrm_graph_ensure_series (graph, SERIES_SCELL_FIRST + carrier->index);
+        mrm_graph_setup_series (graph, SERIES_SCELL_FIRST + carrier->index - 1, label,
+                                scell_colors[carrier->index - 1][0],
+                                scell_colors[carrier->index - 1][1],
+                                scell_colors[carrier->index - 1][2]);
+        *scells |= (1 << carrier->index);
+        g_free (label);
+    }
+
+    /* Series of secondary cells not reported in this sample go blank */
+    for (i = 1; i <= MAX_SCELL_INDEX; i++) {
+        const MrmCarrier *carrier;
+        gdouble value = -G_MAXDOUBLE;
+
+        if (!(*scells & (1 << i)))
+            continue;
+
+        carrier = (carriers ? mrm_carrier_sample_find (carriers, i) : NULL);
+        if (carrier && carrier_get_value (carrier, which) != MRM_CARRIER_VALUE_UNKNOWN)
+            value = 0.1 * carrier_get_value (carrier, which);
+        mrm_graph_step_set_value (graph, SERIES_SCELL_FIRST + i - 1, value, NULL);
+    }
+}
+
+static void
+scells_clear (MrmGraph *graph,
+              guint *scells)
+{
+    guint i;
+
+    for (i = 1; i <= MAX_SCELL_INDEX; i++) {
+        if (*scells & (1 << i))
+            mrm_graph_clear_series (graph, SERIES_SCELL_FIRST + i - 1);
+    }
+    *scells = 0;
+}
+
 typedef enum {
-    SERIES_RSRQ_LTE = 0,
+    SERIES_RSRQ_LTE  = 0,
+    SERIES_RSRQ_NR5G = 1,
 } SeriesRsrqLte;
 
 static void
-rsrq_updated (MrmDevice *device,
-              gdouble lte_rsrq,
-              MrmSignalTab *self)
+rsrq_updated (MrmSignalTab *self,
+              const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->rsrq_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->rsrq_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rsrq_graph),
                               SERIES_RSRQ_LTE,
-                              lte_rsrq,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_RSRQ),
                               GTK_LABEL (self->priv->legend_lte_rsrq_value_label));
+    mrm_graph_step_set_value (MRM_GRAPH (self->priv->rsrq_graph),
+                              SERIES_RSRQ_NR5G,
+                              sample_value (sample, MRM_SAMPLE_METRIC_NR5G_RSRQ),
+                              GTK_LABEL (self->priv->legend_nr5g_rsrq_value_label));
+    scells_updated (self, MRM_GRAPH (self->priv->rsrq_graph), &self->priv->rsrq_scells, CARRIER_VALUE_RSRQ, sample);
     mrm_graph_step_finish (MRM_GRAPH (self->priv->rsrq_graph));
 }
 
 typedef enum {
-    SERIES_RSRP_LTE = 0,
+    SERIES_RSRP_LTE  = 0,
+    SERIES_RSRP_NR5G = 1,
 } SeriesRsrpLte;
 
 static void
-rsrp_updated (MrmDevice *device,
-              gdouble lte_rsrp,
-              MrmSignalTab *self)
+rsrp_updated (MrmSignalTab *self,
+              const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->rsrp_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->rsrp_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->rsrp_graph),
                               SERIES_RSRP_LTE,
-                              lte_rsrp,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_RSRP),
                               GTK_LABEL (self->priv->legend_lte_rsrp_value_label));
+    mrm_graph_step_set_value (MRM_GRAPH (self->priv->rsrp_graph),
+                              SERIES_RSRP_NR5G,
+                              sample_value (sample, MRM_SAMPLE_METRIC_NR5G_RSRP),
+                              GTK_LABEL (self->priv->legend_nr5g_rsrp_value_label));
+    scells_updated (self, MRM_GRAPH (self->priv->rsrp_graph), &self->priv->rsrp_scells, CARRIER_VALUE_RSRP, sample);
     mrm_graph_step_finish (MRM_GRAPH (self->priv->rsrp_graph));
 }
 
 typedef enum {
-    SERIES_SNR_LTE = 0,
+    SERIES_SNR_LTE  = 0,
+    SERIES_SNR_NR5G = 1,
 } SeriesSnrLte;
 
 static void
-snr_updated (MrmDevice *device,
-             gdouble lte_snr,
-             MrmSignalTab *self)
+snr_updated (MrmSignalTab *self,
+             const MrmSample *sample)
 {
-    mrm_graph_step_init (MRM_GRAPH (self->priv->snr_graph));
+    mrm_graph_step_init (MRM_GRAPH (self->priv->snr_graph), sample->timestamp);
     mrm_graph_step_set_value (MRM_GRAPH (self->priv->snr_graph),
                               SERIES_SNR_LTE,
-                              lte_snr,
+                              sample_value (sample, MRM_SAMPLE_METRIC_LTE_SNR),
                               GTK_LABEL (self->priv->legend_lte_snr_value_label));
+    mrm_graph_step_set_value (MRM_GRAPH (self->priv->snr_graph),
+                              SERIES_SNR_NR5G,
+                              sample_value (sample, MRM_SAMPLE_METRIC_NR5G_SNR),
+                              GTK_LABEL (self->priv->legend_nr5g_snr_value_label));
+    scells_updated (self, MRM_GRAPH (self->priv->snr_graph), &self->priv->snr_scells, CARRIER_VALUE_SNR, sample);
     mrm_graph_step_finish (MRM_GRAPH (self->priv->snr_graph));
 }
 
+static void
+sample_received (MrmDevice *device,
+                 const MrmSample *sample,
+                 MrmSignalTab *self)
+{
+    /* Graphs only move on when their metrics were loaded */
+    if (sample->groups & MRM_SAMPLE_GROUP_SIGNAL) {
+        rssi_updated (self, sample);
+        ecio_updated (self, sample);
+        sinr_level_updated (self, sample);
+        io_updated (self, sample);
+        rsrq_updated (self, sample);
+        rsrp_updated (self, sample);
+        snr_updated (self, sample);
+
+        /* Don't bridge the time the device was away */
+        if (sample->gap) {
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->rssi_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->ecio_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->sinr_level_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->io_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->rsrq_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->rsrp_graph));
+            mrm_graph_mark_gap (MRM_GRAPH (self->priv->snr_graph));
+        }
+    }
+}
+
+static void
+carriers_received (MrmDevice *device,
+                   const MrmCarrierSample *carrier_sample,
+                   MrmSignalTab *self)
+{
+    /* Kept for the samples that follow */
+    g_clear_pointer (&self->priv->carriers, mrm_carrier_sample_free);
+    self->priv->carriers = mrm_carrier_sample_copy (carrier_sample);
+}
+
+static void
+serving_cell_changed (MrmDevice *device,
+                      const MrmServingCell *serving_cell,
+                      MrmSignalTab *self)
+{
+    gchar *label;
+
+    /* Cell changes are marked in all graphs, so that jumps in any of the
+     * metrics can be told apart from actual radio conditions */
+    label = mrm_serving_cell_build_label (serving_cell);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->rssi_graph),       serving_cell->timestamp, label);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->ecio_graph),       serving_cell->timestamp, label);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->sinr_level_graph), serving_cell->timestamp, label);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->io_graph),         serving_cell->timestamp, label);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->rsrq_graph),       serving_cell->timestamp, label);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->rsrp_graph),       serving_cell->timestamp, label);
+    mrm_graph_add_marker (MRM_GRAPH (self->priv->snr_graph),        serving_cell->timestamp, label);
+    g_free (label);
+}
+
 void
 mrm_signal_tab_change_current_device (MrmSignalTab *self,
                                       MrmDevice *new_device)
 {
+    GArray *history;
+    GPtrArray *carrier_history;
+    guint i;
+    guint j;
+
     if (self->priv->current) {
         /* If same device, nothing else needed */
         if (new_device &&
@@ -294,41 +526,33 @@ mrm_signal_tab_change_current_device (MrmSignalTab *self,
             self->priv->act_updated_id = 0;
         }
 
-        if (self->priv->rssi_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->rssi_graph_updated_id);
-            self->priv->rssi_graph_updated_id = 0;
-        }
-
-        if (self->priv->ecio_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->ecio_graph_updated_id);
-            self->priv->ecio_graph_updated_id = 0;
+        if (self->priv->sample_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->sample_id);
+            self->priv->sample_id = 0;
         }
 
-        if (self->priv->sinr_level_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->sinr_level_graph_updated_id);
-            self->priv->sinr_level_graph_updated_id = 0;
+        if (self->priv->serving_cell_changed_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->serving_cell_changed_id);
+            self->priv->serving_cell_changed_id = 0;
         }
 
-        if (self->priv->io_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->io_graph_updated_id);
-            self->priv->io_graph_updated_id = 0;
+        if (self->priv->carriers_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->carriers_id);
+            self->priv->carriers_id = 0;
         }
+        g_clear_pointer (&self->priv->carriers, mrm_carrier_sample_free);
 
-        if (self->priv->rsrq_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->rsrq_graph_updated_id);
-            self->priv->rsrq_graph_updated_id = 0;
+        if (self->priv->poll_interval_updated_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->poll_interval_updated_id);
+            self->priv->poll_interval_updated_id = 0;
         }
 
-        if (self->priv->rsrp_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->rsrp_graph_updated_id);
-            self->priv->rsrp_graph_updated_id = 0;
-        }
-
-        if (self->priv->snr_graph_updated_id) {
-            g_signal_handler_disconnect (self->priv->current, self->priv->snr_graph_updated_id);
-            self->priv->snr_graph_updated_id = 0;
+        if (self->priv->carrier_poll_interval_updated_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->carrier_poll_interval_updated_id);
+            self->priv->carrier_poll_interval_updated_id = 0;
         }
 
+        mrm_device_unsubscribe (self->priv->current, MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_CARRIERS);
         g_clear_object (&self->priv->current);
 
         /* Clear graphs */
@@ -348,10 +572,25 @@ mrm_signal_tab_change_current_device (MrmSignalTab *self,
         mrm_graph_clear_series (MRM_GRAPH (self->priv->io_graph), SERIES_IO_EVDO);
 
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rsrq_graph), SERIES_RSRQ_LTE);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->rsrq_graph), SERIES_RSRQ_NR5G);
 
         mrm_graph_clear_series (MRM_GRAPH (self->priv->rsrp_graph), SERIES_RSRP_LTE);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->rsrp_graph), SERIES_RSRP_NR5G);
 
         mrm_graph_clear_series (MRM_GRAPH (self->priv->snr_graph), SERIES_SNR_LTE);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->snr_graph), SERIES_SNR_NR5G);
+
+        scells_clear (MRM_GRAPH (self->priv->rsrq_graph), &self->priv->rsrq_scells);
+        scells_clear (MRM_GRAPH (self->priv->rsrp_graph), &self->priv->rsrp_scells);
+        scells_clear (MRM_GRAPH (self->priv->snr_graph),  &self->priv->snr_scells);
+
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->rssi_graph));
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->ecio_graph));
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->sinr_level_graph));
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->io_graph));
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->rsrq_graph));
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->rsrp_graph));
+        mrm_graph_clear_markers (MRM_GRAPH (self->priv->snr_graph));
     }
 
     if (new_device) {
@@ -361,34 +600,56 @@ mrm_signal_tab_change_current_device (MrmSignalTab *self,
                                                        "act-updated",
                                                        G_CALLBACK (act_updated),
                                                        self);
-        self->priv->rssi_graph_updated_id = g_signal_connect (new_device,
-                                                              "rssi-updated",
-                                                              G_CALLBACK (rssi_updated),
-                                                              self);
-        self->priv->ecio_graph_updated_id = g_signal_connect (new_device,
-                                                              "ecio-updated",
-                                                              G_CALLBACK (ecio_updated),
-                                                              self);
-        self->priv->sinr_level_graph_updated_id = g_signal_connect (new_device,
-                                                                    "sinr-level-updated",
-                                                                    G_CALLBACK (sinr_level_updated),
-                                                                    self);
-        self->priv->io_graph_updated_id = g_signal_connect (new_device,
-                                                            "io-updated",
-                                                            G_CALLBACK (io_updated),
-                                                            self);
-        self->priv->rsrq_graph_updated_id = g_signal_connect (new_device,
-                                                              "rsrq-updated",
-                                                              G_CALLBACK (rsrq_updated),
-                                                              self);
-        self->priv->rsrp_graph_updated_id = g_signal_connect (new_device,
-                                                              "rsrp-updated",
-                                                              G_CALLBACK (rsrp_updated),
-                                                              self);
-        self->priv->snr_graph_updated_id = g_signal_connect (new_device,
-                                                             "snr-updated",
-                                                             G_CALLBACK (snr_updated),
-                                                             self);
+        act_updated (new_device, mrm_device_get_act (new_device), self);
+        self->priv->sample_id = g_signal_connect (new_device,
+                                                  "sample",
+                                                  G_CALLBACK (sample_received),
+                                                  self);
+        self->priv->carriers_id = g_signal_connect (new_device,
+                                                    "carriers",
+                                                    G_CALLBACK (carriers_received),
+                                                    self);
+        self->priv->serving_cell_changed_id = g_signal_connect (new_device,
+                                                                "serving-cell-changed",
+                                                                G_CALLBACK (serving_cell_changed),
+                                                                self);
+        self->priv->poll_interval_updated_id = g_signal_connect (new_device,
+                                                                 "notify::signal-sample-interval-ms",
+                                                                 G_CALLBACK (poll_interval_updated),
+                                                                 self);
+        poll_interval_updated (new_device, NULL, self);
+        self->priv->carrier_poll_interval_updated_id = g_signal_connect (new_device,
+                                                                         "notify::carrier-poll-interval-ms",
+                                                                         G_CALLBACK (carrier_poll_interval_updated),
+                                                                         self);
+        carrier_poll_interval_updated (new_device, NULL, self);
+
+        /* Metrics are only polled while someone wants them */
+        mrm_device_subscribe (new_device, MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_CARRIERS);
+
+        /* Replay whatever the device sampled while not shown; carriers are
+         * replayed right before the samples taken after them */
+        history = mrm_device_dup_history (new_device);
+        carrier_history = mrm_device_dup_carrier_history (new_device);
+        for (i = 0, j = 0; i < history->len; i++) {
+            const MrmSample *sample = &g_array_index (history, MrmSample, i);
+
+            for (; j < carrier_history->len; j++) {
+                const MrmCarrierSample *carrier_sample = g_ptr_array_index (carrier_history, j);
+
+                if (carrier_sample->timestamp > sample->timestamp)
+                    break;
+                carriers_received (new_device, carrier_sample, self);
+            }
+            sample_received (new_device, sample, self);
+        }
+        g_ptr_array_unref (carrier_history);
+        g_array_unref (history);
+
+        history = mrm_device_dup_serving_cell_log (new_device);
+        for (i = 0; i < history->len; i++)
+            serving_cell_changed (new_device, &g_array_index (history, MrmServingCell, i), self);
+        g_array_unref (history);
     }
 }
 
@@ -411,6 +672,7 @@ mrm_signal_tab_init (MrmSignalTab *self)
 #define LTE_RGB  0,   76,  153 /* blue */
 #define CDMA_RGB 153, 153, 0   /* yellow */
 #define EVDO_RGB 153, 0,   153 /* purple */
+#define NR5G_RGB 255, 128, 0   /* orange */
 
     /* Main legend box */
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_gsm_icon),  GSM_RGB);
@@ -418,6 +680,7 @@ mrm_signal_tab_init (MrmSignalTab *self)
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_lte_icon),  LTE_RGB);
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_cdma_icon), CDMA_RGB);
     mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_evdo_icon), EVDO_RGB);
+    mrm_color_icon_set_color (MRM_COLOR_ICON (self->priv->legend_nr5g_icon), NR5G_RGB);
 
     /* RSSI graph */
     mrm_graph_setup_series (MRM_GRAPH (self->priv->rssi_graph), SERIES_RSSI_GSM,  "GSM",  GSM_RGB);
@@ -438,13 +701,16 @@ mrm_signal_tab_init (MrmSignalTab *self)
     mrm_graph_setup_series (MRM_GRAPH (self->priv->io_graph), SERIES_IO_EVDO, "EVDO", EVDO_RGB);
 
     /* RSRQ graph */
-    mrm_graph_setup_series (MRM_GRAPH (self->priv->rsrq_graph), SERIES_RSRQ_LTE, "LTE", LTE_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->rsrq_graph), SERIES_RSRQ_LTE,  "LTE",   LTE_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->rsrq_graph), SERIES_RSRQ_NR5G, "5G NR", NR5G_RGB);
 
     /* RSRP graph */
-    mrm_graph_setup_series (MRM_GRAPH (self->priv->rsrp_graph), SERIES_RSRP_LTE, "LTE", LTE_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->rsrp_graph), SERIES_RSRP_LTE,  "LTE",   LTE_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->rsrp_graph), SERIES_RSRP_NR5G, "5G NR", NR5G_RGB);
 
     /* SNR graph */
-    mrm_graph_setup_series (MRM_GRAPH (self->priv->snr_graph), SERIES_SNR_LTE, "LTE", LTE_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->snr_graph), SERIES_SNR_LTE,  "LTE",   LTE_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->snr_graph), SERIES_SNR_NR5G, "5G NR", NR5G_RGB);
 }
 
 static void
@@ -452,7 +718,8 @@ dispose (GObject *object)
 {
     MrmSignalTab *self = MRM_SIGNAL_TAB (object);
 
-    g_clear_object (&self->priv->current);
+    /* Disconnects from the device and drops the subscription */
+    mrm_signal_tab_change_current_device (self, NULL);
 
     G_OBJECT_CLASS (mrm_signal_tab_parent_class)->dispose (object);
 }
@@ -504,5 +771,10 @@ mrm_signal_tab_class_init (MrmSignalTabClass *klass)
     gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_lte_rsrq_value_label);
     gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_lte_rsrp_value_label);
     gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_lte_snr_value_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_nr5g_box);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_nr5g_icon);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_nr5g_rsrq_value_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_nr5g_rsrp_value_label);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmSignalTab, legend_nr5g_snr_value_label);
 
 }
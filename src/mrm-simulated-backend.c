@@ -0,0 +1,334 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include "mrm-simulated-backend.h"
+#include "mrm-device.h"
+#include "mrm-enum-types.h"
+
+static void device_backend_iface_init (MrmDeviceBackendInterface *iface);
+
+G_DEFINE_TYPE_EXTENDED (MrmSimulatedBackend, mrm_simulated_backend, G_TYPE_OBJECT, 0,
+                        G_IMPLEMENT_INTERFACE (MRM_TYPE_DEVICE_BACKEND, device_backend_iface_init))
+
+enum {
+    PROP_0,
+    PROP_NAME,
+    PROP_ACT,
+    PROP_SEED,
+    PROP_LAST
+};
+
+static GParamSpec *properties[PROP_LAST];
+
+/* Each metric follows a bounded random walk, in the units of its kind */
+typedef struct {
+    gdouble initial;
+    gdouble min;
+    gdouble max;
+    gdouble step;
+} MetricRange;
+
+static const MetricRange kind_ranges[] = {
+    [MRM_SAMPLE_KIND_RSSI]           = {  -70.0, -110.0,    -40.0,   2.0 },
+    [MRM_SAMPLE_KIND_ECIO]           = {   -8.0,  -20.0,      0.0,   1.0 },
+    [MRM_SAMPLE_KIND_SINR_LEVEL]     = {    3.0,   -9.0,      9.0,   1.5 },
+    [MRM_SAMPLE_KIND_IO]             = {  -80.0, -110.0,    -50.0,   2.0 },
+    [MRM_SAMPLE_KIND_RSRQ]           = {  -10.0,  -20.0,     -3.0,   1.0 },
+    [MRM_SAMPLE_KIND_RSRP]           = {  -95.0, -140.0,    -44.0,   2.0 },
+    [MRM_SAMPLE_KIND_SNR]            = {   10.0,  -20.0,     30.0,   1.0 },
+    [MRM_SAMPLE_KIND_RX0]            = {  -70.0, -110.0,    -40.0,   2.0 },
+    [MRM_SAMPLE_KIND_RX1]            = {  -72.0, -110.0,    -40.0,   2.0 },
+    [MRM_SAMPLE_KIND_TX]             = {    0.0,  -50.0,     23.0,   2.0 },
+    [MRM_SAMPLE_KIND_TX_RATE]        = {  200.0,    0.0,  50000.0, 100.0 },
+    [MRM_SAMPLE_KIND_RX_RATE]        = { 1000.0,    0.0, 150000.0, 500.0 },
+    [MRM_SAMPLE_KIND_TX_PACKET_RATE] = {   30.0,    0.0,   5000.0,  10.0 },
+    [MRM_SAMPLE_KIND_RX_PACKET_RATE] = {  100.0,    0.0,  15000.0,  40.0 },
+    [MRM_SAMPLE_KIND_TX_DROP_RATE]   = {    0.0,    0.0,    100.0,   0.5 },
+    [MRM_SAMPLE_KIND_RX_DROP_RATE]   = {    0.0,    0.0,    100.0,   0.5 },
+};
+
+struct _MrmSimulatedBackendPrivate {
+    gchar *name;
+    guint act;
+    guint32 seed;
+
+    /* Generator state, worker only */
+    GRand *rand;
+    gdouble values[MRM_SAMPLE_METRIC_LAST];
+};
+
+/*****************************************************************************/
+
+static const gchar *
+backend_get_name (MrmDeviceBackend *backend)
+{
+    return MRM_SIMULATED_BACKEND (backend)->priv->name;
+}
+
+/*****************************************************************************/
+
+static gboolean
+backend_open_finish (MrmDeviceBackend *backend,
+                     GAsyncResult *res,
+                     gchar **manufacturer,
+                     gchar **model,
+                     gchar **revision,
+                     GError **error)
+{
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return FALSE;
+
+    *manufacturer = g_strdup ("Mobile Radio Monitor");
+    *model = g_strdup ("Simulated modem");
+    *revision = g_strdup_printf ("seed %u", MRM_SIMULATED_BACKEND (backend)->priv->seed);
+    return TRUE;
+}
+
+static void
+backend_open (MrmDeviceBackend *backend,
+              GCancellable *cancellable,
+              GAsyncReadyCallback callback,
+              gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    simple = g_simple_async_result_new (G_OBJECT (backend), callback, user_data, backend_open);
+    g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+}
+
+static gboolean
+backend_close_finish (MrmDeviceBackend *backend,
+                      GAsyncResult *res,
+                      GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+backend_close (MrmDeviceBackend *backend,
+               GCancellable *cancellable,
+               GAsyncReadyCallback callback,
+               gpointer user_data)
+{
+    GSimpleAsyncResult *simple;
+
+    simple = g_simple_async_result_new (G_OBJECT (backend), callback, user_data, backend_close);
+    g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+}
+
+/*****************************************************************************/
+
+/* Every session generates the same sequence for the same seed */
+static void
+backend_start (MrmDeviceBackend *backend)
+{
+    MrmSimulatedBackend *self = MRM_SIMULATED_BACKEND (backend);
+    guint i;
+
+    g_rand_set_seed (self->priv->rand, self->priv->seed);
+    for (i = 0; i < MRM_SAMPLE_METRIC_LAST; i++)
+        self->priv->values[i] = kind_ranges[mrm_sample_metric_get_info (i)->kind].initial;
+}
+
+static gboolean
+backend_reload_finish (MrmDeviceBackend *backend,
+                       GAsyncResult *res,
+                       MrmSample *sample,
+                       GError **error)
+{
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return FALSE;
+
+    *sample = *((MrmSample *) g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res)));
+    return TRUE;
+}
+
+static void
+backend_reload (MrmDeviceBackend *backend,
+                guint groups,
+                GCancellable *cancellable,
+                GAsyncReadyCallback callback,
+                gpointer user_data)
+{
+    MrmSimulatedBackend *self = MRM_SIMULATED_BACKEND (backend);
+    GSimpleAsyncResult *simple;
+    MrmSample *sample;
+    guint i;
+
+    sample = mrm_sample_new (0);
+    sample->act = self->priv->act;
+
+    for (i = 0; i < MRM_SAMPLE_METRIC_LAST; i++) {
+        const MrmSampleMetricInfo *info;
+        const MetricRange *range;
+
+        info = mrm_sample_metric_get_info (i);
+        if (!(groups & info->group))
+            continue;
+        /* Only metrics of the simulated access technologies */
+        if (info->act && !(info->act & self->priv->act))
+            continue;
+
+        range = &kind_ranges[info->kind];
+        self->priv->values[i] = CLAMP (self->priv->values[i] + g_rand_double_range (self->priv->rand, -range->step, range->step),
+                                       range->min,
+                                       range->max);
+        mrm_sample_set_value (sample, i, self->priv->values[i]);
+        sample->groups |= info->group;
+    }
+
+    simple = g_simple_async_result_new (G_OBJECT (backend), callback, user_data, backend_reload);
+    g_simple_async_result_set_op_res_gpointer (simple, sample, (GDestroyNotify) mrm_sample_free);
+    g_simple_async_result_complete_in_idle (simple);
+    g_object_unref (simple);
+}
+
+/*****************************************************************************/
+
+MrmDeviceBackend *
+mrm_simulated_backend_new (const gchar *name,
+                           guint act,
+                           guint32 seed)
+{
+    return MRM_DEVICE_BACKEND (g_object_new (MRM_TYPE_SIMULATED_BACKEND,
+                                             "name", name,
+                                             "act",  act,
+                                             "seed", seed,
+                                             NULL));
+}
+
+static void
+mrm_simulated_backend_init (MrmSimulatedBackend *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MRM_TYPE_SIMULATED_BACKEND, MrmSimulatedBackendPrivate);
+    self->priv->act = MRM_DEVICE_ACT_LTE;
+    self->priv->rand = g_rand_new ();
+}
+
+static void
+set_property (GObject *object,
+              guint prop_id,
+              const GValue *value,
+              GParamSpec *pspec)
+{
+    MrmSimulatedBackend *self = MRM_SIMULATED_BACKEND (object);
+
+    switch (prop_id) {
+    case PROP_NAME:
+        g_free (self->priv->name);
+        self->priv->name = g_value_dup_string (value);
+        break;
+    case PROP_ACT:
+        self->priv->act = g_value_get_flags (value);
+        break;
+    case PROP_SEED:
+        self->priv->seed = g_value_get_uint (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject *object,
+              guint prop_id,
+              GValue *value,
+              GParamSpec *pspec)
+{
+    MrmSimulatedBackend *self = MRM_SIMULATED_BACKEND (object);
+
+    switch (prop_id) {
+    case PROP_NAME:
+        g_value_set_string (value, self->priv->name);
+        break;
+    case PROP_ACT:
+        g_value_set_flags (value, self->priv->act);
+        break;
+    case PROP_SEED:
+        g_value_set_uint (value, self->priv->seed);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+finalize (GObject *object)
+{
+    MrmSimulatedBackend *self = MRM_SIMULATED_BACKEND (object);
+
+    g_rand_free (self->priv->rand);
+    g_free (self->priv->name);
+
+    G_OBJECT_CLASS (mrm_simulated_backend_parent_class)->finalize (object);
+}
+
+static void
+device_backend_iface_init (MrmDeviceBackendInterface *iface)
+{
+    iface->get_name = backend_get_name;
+    iface->open = backend_open;
+    iface->open_finish = backend_open_finish;
+    iface->close = backend_close;
+    iface->close_finish = backend_close_finish;
+    iface->start = backend_start;
+    iface->reload = backend_reload;
+    iface->reload_finish = backend_reload_finish;
+}
+
+static void
+mrm_simulated_backend_class_init (MrmSimulatedBackendClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MrmSimulatedBackendPrivate));
+
+    object_class->get_property = get_property;
+    object_class->set_property = set_property;
+    object_class->finalize = finalize;
+
+    properties[PROP_NAME] =
+        g_param_spec_string ("name",
+                             "Name",
+                             "Name of the simulated device",
+                             "simulated",
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_NAME, properties[PROP_NAME]);
+
+    properties[PROP_ACT] =
+        g_param_spec_flags ("act",
+                            "Access technologies",
+                            "Radio interfaces whose metrics are generated",
+                            MRM_TYPE_DEVICE_ACT,
+                            MRM_DEVICE_ACT_LTE,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_ACT, properties[PROP_ACT]);
+
+    properties[PROP_SEED] =
+        g_param_spec_uint ("seed",
+                           "Seed",
+                           "Seed of the generator, so that runs can be reproduced",
+                           0,
+                           G_MAXUINT32,
+                           0,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_SEED, properties[PROP_SEED]);
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef __MRM_SIMULATED_BACKEND_H__
+#define __MRM_SIMULATED_BACKEND_H__
+
+#include <glib-object.h>
+
+#include "mrm-device-backend.h"
+
+G_BEGIN_DECLS
+
+#define MRM_TYPE_SIMULATED_BACKEND         (mrm_simulated_backend_get_type ())
+#define MRM_SIMULATED_BACKEND(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), MRM_TYPE_SIMULATED_BACKEND, MrmSimulatedBackend))
+#define MRM_SIMULATED_BACKEND_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST ((k), MRM_TYPE_SIMULATED_BACKEND, MrmSimulatedBackendClass))
+#define MRM_IS_SIMULATED_BACKEND(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), MRM_TYPE_SIMULATED_BACKEND))
+#define MRM_IS_SIMULATED_BACKEND_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), MRM_TYPE_SIMULATED_BACKEND))
+#define MRM_SIMULATED_BACKEND_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), MRM_TYPE_SIMULATED_BACKEND, MrmSimulatedBackendClass))
+
+typedef struct _MrmSimulatedBackend        MrmSimulatedBackend;
+typedef struct _MrmSimulatedBackendClass   MrmSimulatedBackendClass;
+typedef struct _MrmSimulatedBackendPrivate MrmSimulatedBackendPrivate;
+
+struct _MrmSimulatedBackend {
+    GObject parent_instance;
+    MrmSimulatedBackendPrivate *priv;
+};
+
+struct _MrmSimulatedBackendClass {
+    GObjectClass parent_class;
+};
+
+GType mrm_simulated_backend_get_type (void) G_GNUC_CONST;
+
+MrmDeviceBackend *mrm_simulated_backend_new (const gchar *name,
+                                             guint act,
+                                             guint32 seed);
+
+G_END_DECLS
+
+#endif /* __MRM_SIMULATED_BACKEND_H__ */
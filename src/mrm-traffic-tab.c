@@ -0,0 +1,252 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef CMAKE_BUILD
+#include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include "mrm-traffic-tab.h"
+#include "mrm-graph.h"
+
+struct _MrmTrafficTabPrivate {
+    MrmDevice *current;
+
+    guint sample_id;
+    guint poll_interval_updated_id;
+
+    GtkWidget *throughput_graph;
+    GtkWidget *packets_graph;
+    GtkWidget *drops_graph;
+
+    /* Initial ranges, as given in the template */
+    gdouble throughput_y_max;
+    gdouble packets_y_max;
+    gdouble drops_y_max;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (MrmTrafficTab, mrm_traffic_tab, GTK_TYPE_BOX)
+
+typedef enum {
+    SERIES_TX = 0,
+    SERIES_RX = 1,
+} Series;
+
+/******************************************************************************/
+
+static void
+poll_interval_updated (MrmDevice *device,
+                       GParamSpec *pspec,
+                       MrmTrafficTab *self)
+{
+    guint interval_ms;
+
+    g_object_get (device, "traffic-poll-interval-ms", &interval_ms, NULL);
+    g_object_set (self->priv->throughput_graph, "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->packets_graph,    "step-duration-ms", interval_ms, NULL);
+    g_object_set (self->priv->drops_graph,      "step-duration-ms", interval_ms, NULL);
+}
+
+static gdouble
+sample_value (const MrmSample *sample,
+              MrmSampleMetric metric)
+{
+    gdouble value;
+
+    return mrm_sample_get_value (sample, metric, &value) ? value : -G_MAXDOUBLE;
+}
+
+/* Rates may span several orders of magnitude, so the range of the graph is
+ * doubled until the value fits in it */
+static void
+graph_fit_value (GtkWidget *graph,
+                 gdouble value)
+{
+    gdouble y_max;
+
+    g_object_get (graph, "y-max", &y_max, NULL);
+    if (value <= y_max)
+        return;
+
+    while (value > y_max)
+        y_max *= 2.0;
+    g_object_set (graph, "y-max", y_max, NULL);
+}
+
+static void
+graph_update (GtkWidget *graph,
+              const MrmSample *sample,
+              MrmSampleMetric tx_metric,
+              MrmSampleMetric rx_metric)
+{
+    gdouble tx;
+    gdouble rx;
+
+    tx = sample_value (sample, tx_metric);
+    rx = sample_value (sample, rx_metric);
+    graph_fit_value (graph, MAX (tx, rx));
+
+    mrm_graph_step_init (MRM_GRAPH (graph), sample->timestamp);
+    mrm_graph_step_set_value (MRM_GRAPH (graph), SERIES_TX, tx, NULL);
+    mrm_graph_step_set_value (MRM_GRAPH (graph), SERIES_RX, rx, NULL);
+    mrm_graph_step_finish (MRM_GRAPH (graph));
+}
+
+static void
+sample_received (MrmDevice *device,
+                 const MrmSample *sample,
+                 MrmTrafficTab *self)
+{
+    /* Graphs only move on when their metrics were loaded */
+    if (!(sample->groups & MRM_SAMPLE_GROUP_TRAFFIC))
+        return;
+
+    graph_update (self->priv->throughput_graph, sample,
+                  MRM_SAMPLE_METRIC_TX_RATE, MRM_SAMPLE_METRIC_RX_RATE);
+    graph_update (self->priv->packets_graph, sample,
+                  MRM_SAMPLE_METRIC_TX_PACKET_RATE, MRM_SAMPLE_METRIC_RX_PACKET_RATE);
+    graph_update (self->priv->drops_graph, sample,
+                  MRM_SAMPLE_METRIC_TX_DROP_RATE, MRM_SAMPLE_METRIC_RX_DROP_RATE);
+
+    /* Don't bridge the time the device was away */
+    if (sample->gap) {
+        mrm_graph_mark_gap (MRM_GRAPH (self->priv->throughput_graph));
+        mrm_graph_mark_gap (MRM_GRAPH (self->priv->packets_graph));
+        mrm_graph_mark_gap (MRM_GRAPH (self->priv->drops_graph));
+    }
+}
+
+void
+mrm_traffic_tab_change_current_device (MrmTrafficTab *self,
+                                       MrmDevice *new_device)
+{
+    GArray *history;
+    guint i;
+
+    if (self->priv->current) {
+        /* If same device, nothing else needed */
+        if (new_device &&
+            (self->priv->current == new_device ||
+             g_str_equal (mrm_device_get_name (self->priv->current), mrm_device_get_name (new_device))))
+            return;
+
+        /* Changing current device, cleanup */
+        if (self->priv->sample_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->sample_id);
+            self->priv->sample_id = 0;
+        }
+
+        if (self->priv->poll_interval_updated_id) {
+            g_signal_handler_disconnect (self->priv->current, self->priv->poll_interval_updated_id);
+            self->priv->poll_interval_updated_id = 0;
+        }
+
+        mrm_device_unsubscribe (self->priv->current, MRM_SAMPLE_GROUP_TRAFFIC);
+        g_clear_object (&self->priv->current);
+
+        /* Clear graphs, and go back to the initial ranges */
+
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->throughput_graph), SERIES_TX);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->throughput_graph), SERIES_RX);
+        g_object_set (self->priv->throughput_graph, "y-max", self->priv->throughput_y_max, NULL);
+
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->packets_graph), SERIES_TX);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->packets_graph), SERIES_RX);
+        g_object_set (self->priv->packets_graph, "y-max", self->priv->packets_y_max, NULL);
+
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->drops_graph), SERIES_TX);
+        mrm_graph_clear_series (MRM_GRAPH (self->priv->drops_graph), SERIES_RX);
+        g_object_set (self->priv->drops_graph, "y-max", self->priv->drops_y_max, NULL);
+    }
+
+    if (new_device) {
+        /* Keep a ref to current device */
+        self->priv->current = g_object_ref (new_device);
+        self->priv->sample_id = g_signal_connect (new_device,
+                                                  "sample",
+                                                  G_CALLBACK (sample_received),
+                                                  self);
+        self->priv->poll_interval_updated_id = g_signal_connect (new_device,
+                                                                 "notify::traffic-poll-interval-ms",
+                                                                 G_CALLBACK (poll_interval_updated),
+                                                                 self);
+        poll_interval_updated (new_device, NULL, self);
+
+        /* Metrics are only polled while someone wants them */
+        mrm_device_subscribe (new_device, MRM_SAMPLE_GROUP_TRAFFIC);
+
+        /* Replay whatever the device sampled while not shown */
+        history = mrm_device_dup_history (new_device);
+        for (i = 0; i < history->len; i++)
+            sample_received (new_device, &g_array_index (history, MrmSample, i), self);
+        g_array_unref (history);
+    }
+}
+
+/******************************************************************************/
+
+static void
+mrm_traffic_tab_init (MrmTrafficTab *self)
+{
+    self->priv = mrm_traffic_tab_get_instance_private (self);
+
+    /* Ensure we register the MrmGraph before initiating the template */
+    g_warn_if_fail (mrm_graph_get_type ());
+
+    gtk_widget_init_template (GTK_WIDGET (self));
+
+    g_object_get (self->priv->throughput_graph, "y-max", &self->priv->throughput_y_max, NULL);
+    g_object_get (self->priv->packets_graph,    "y-max", &self->priv->packets_y_max,    NULL);
+    g_object_get (self->priv->drops_graph,      "y-max", &self->priv->drops_y_max,      NULL);
+
+#define TX_RGB 204, 0,  0   /* red */
+#define RX_RGB 0,   76, 153 /* blue */
+
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->throughput_graph), SERIES_TX, "Tx", TX_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->throughput_graph), SERIES_RX, "Rx", RX_RGB);
+
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->packets_graph), SERIES_TX, "Tx", TX_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->packets_graph), SERIES_RX, "Rx", RX_RGB);
+
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->drops_graph), SERIES_TX, "Tx", TX_RGB);
+    mrm_graph_setup_series (MRM_GRAPH (self->priv->drops_graph), SERIES_RX, "Rx", RX_RGB);
+}
+
+static void
+dispose (GObject *object)
+{
+    MrmTrafficTab *self = MRM_TRAFFIC_TAB (object);
+
+    /* Disconnects from the device and drops the subscription */
+    mrm_traffic_tab_change_current_device (self, NULL);
+
+    G_OBJECT_CLASS (mrm_traffic_tab_parent_class)->dispose (object);
+}
+
+static void
+mrm_traffic_tab_class_init (MrmTrafficTabClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+    object_class->dispose = dispose;
+
+    /* Bind class to template */
+    gtk_widget_class_set_template_from_resource  (widget_class, "/es/aleksander/mrm/mrm-traffic-tab.ui");
+    gtk_widget_class_bind_template_child_private (widget_class, MrmTrafficTab, throughput_graph);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmTrafficTab, packets_graph);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmTrafficTab, drops_graph);
+}
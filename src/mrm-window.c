@@ -24,6 +24,9 @@
 #include "mrm-device.h"
 #include "mrm-signal-tab.h"
 #include "mrm-power-tab.h"
+#include "mrm-traffic-tab.h"
+#include "mrm-neighbors-tab.h"
+#include "mrm-networks-tab.h"
 
 #define NOTEBOOK_TAB_DEVICE_LIST 0
 #define NOTEBOOK_TAB_GRAPHS      1
@@ -53,6 +56,9 @@ struct _MrmWindowPrivate {
     /* Graphs */
     GtkWidget *signal_box;
     GtkWidget *power_box;
+    GtkWidget *traffic_box;
+    GtkWidget *neighbors_box;
+    GtkWidget *networks_box;
 
     guint initial_scan_done_id;
     guint device_detection_id;
@@ -79,6 +85,13 @@ change_current_device (MrmWindow *self,
 
     mrm_signal_tab_change_current_device (MRM_SIGNAL_TAB (self->priv->signal_box), new_device);
     mrm_power_tab_change_current_device (MRM_POWER_TAB (self->priv->power_box), new_device);
+    mrm_traffic_tab_change_current_device (MRM_TRAFFIC_TAB (self->priv->traffic_box), new_device);
+    mrm_neighbors_tab_change_current_device (MRM_NEIGHBORS_TAB (self->priv->neighbors_box), new_device);
+    mrm_networks_tab_change_current_device (MRM_NETWORKS_TAB (self->priv->networks_box), new_device);
+
+    /* Devices with a backend have no neighbor cells nor network scans */
+    gtk_widget_set_visible (self->priv->neighbors_box, !new_device || !mrm_device_peek_backend (new_device));
+    gtk_widget_set_visible (self->priv->networks_box, !new_device || !mrm_device_peek_backend (new_device));
 
     if (new_device)
         /* Keep a ref to current device */
@@ -301,6 +314,19 @@ update_modem_status_label_text (MrmDevice *device,
                                 GParamSpec *unused,
                                 GtkWidget *status)
 {
+    switch (mrm_device_get_connection (device)) {
+    case MRM_DEVICE_CONNECTION_CONNECTED:
+        break;
+    case MRM_DEVICE_CONNECTION_DISCONNECTED:
+        gtk_label_set_text (GTK_LABEL (status), "Disconnected");
+        return;
+    case MRM_DEVICE_CONNECTION_RECONNECTING:
+        gtk_label_set_text (GTK_LABEL (status), "Reconnecting...");
+        return;
+    default:
+        g_assert_not_reached ();
+    }
+
     switch (mrm_device_get_status (device)) {
     case MRM_DEVICE_STATUS_UNKNOWN:
         gtk_label_set_text (GTK_LABEL (status), "Unknown status");
@@ -322,6 +348,21 @@ update_modem_status_label_text (MrmDevice *device,
     }
 }
 
+static void
+update_device_label_markup (MrmDevice *device,
+                            GParamSpec *unused,
+                            GtkWidget *label)
+{
+    gchar *markup;
+
+    markup = g_markup_printf_escaped ("[%s]\n\t<span weight=\"bold\">%s</span>\n\t<span style=\"italic\">%s</span>",
+                                      mrm_device_get_name (device),
+                                      mrm_device_get_model (device),
+                                      mrm_device_get_manufacturer (device));
+    gtk_label_set_markup (GTK_LABEL (label), markup);
+    g_free (markup);
+}
+
 static void
 device_added_cb (MrmApp *application,
                  MrmDevice *device,
@@ -330,7 +371,6 @@ device_added_cb (MrmApp *application,
     GtkWidget *row;
     GtkWidget *box;
     GtkWidget *button_label;
-    gchar *button_label_markup;
     GtkWidget *status;
 
     row = gtk_list_box_row_new ();
@@ -343,12 +383,7 @@ device_added_cb (MrmApp *application,
                             g_object_unref);
     gtk_container_add (GTK_CONTAINER (self->priv->device_list_box), row);
 
-    button_label_markup = g_strdup_printf ("[%s]\n\t<span weight=\"bold\">%s</span>\n\t<span style=\"italic\">%s</span>",
-                                           mrm_device_get_name (device),
-                                           mrm_device_get_model (device),
-                                           mrm_device_get_manufacturer (device));
     button_label = gtk_label_new (NULL);
-    gtk_label_set_markup (GTK_LABEL (button_label), button_label_markup);
     gtk_widget_set_valign (GTK_WIDGET (button_label), 0.5f);
 
 #if GTK_CHECK_VERSION(3,12,0)
@@ -388,8 +423,25 @@ device_added_cb (MrmApp *application,
                       "notify::status",
                       G_CALLBACK (update_modem_status_label_text),
                       status);
+    g_signal_connect (device,
+                      "notify::connection",
+                      G_CALLBACK (update_modem_status_label_text),
+                      status);
     update_modem_status_label_text (device, NULL, status);
 
+    /* The identity may have been cached, and get refreshed later */
+    g_signal_connect_object (device,
+                             "notify::model",
+                             G_CALLBACK (update_device_label_markup),
+                             button_label,
+                             0);
+    g_signal_connect_object (device,
+                             "notify::manufacturer",
+                             G_CALLBACK (update_device_label_markup),
+                             button_label,
+                             0);
+    update_device_label_markup (device, NULL, button_label);
+
     gtk_widget_show_all (row);
 
     gtk_widget_hide (self->priv->device_list_label);
@@ -534,10 +586,13 @@ mrm_window_init (MrmWindow *self)
 {
     self->priv = mrm_window_get_instance_private (self);
 
-    /* Ensure we register the MrmSignalTab and MrmPowerTab before initiating
-     * the template */
+    /* Ensure we register the MrmSignalTab, MrmPowerTab, MrmTrafficTab and
+     * MrmNeighborsTab before initiating the template */
     g_warn_if_fail (mrm_signal_tab_get_type ());
     g_warn_if_fail (mrm_power_tab_get_type ());
+    g_warn_if_fail (mrm_traffic_tab_get_type ());
+    g_warn_if_fail (mrm_neighbors_tab_get_type ());
+    g_warn_if_fail (mrm_networks_tab_get_type ());
 
     gtk_widget_init_template (GTK_WIDGET (self));
 
@@ -628,4 +683,7 @@ mrm_window_class_init (MrmWindowClass *klass)
     gtk_widget_class_bind_template_child_private (widget_class, MrmWindow, pin_check_spinner_box);
     gtk_widget_class_bind_template_child_private (widget_class, MrmWindow, signal_box);
     gtk_widget_class_bind_template_child_private (widget_class, MrmWindow, power_box);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmWindow, traffic_box);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmWindow, neighbors_box);
+    gtk_widget_class_bind_template_child_private (widget_class, MrmWindow, networks_box);
 }
@@ -0,0 +1,312 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2013-2015 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "mrm-device.h"
+#include "mrm-error.h"
+#include "mrm-error-types.h"
+#include "mrm-neighbor.h"
+#include "mrm-sample.h"
+
+/*****************************************************************************/
+/* Neighbor lists */
+
+#define NEIGHBOR(RAT, CHANNEL, CELL_ID, LEVEL) \
+    { MRM_NEIGHBOR_RAT_##RAT, FALSE, CELL_ID, CHANNEL, LEVEL, MRM_NEIGHBOR_QUALITY_UNKNOWN }
+
+static GArray *
+neighbor_list_build (const MrmNeighbor *neighbors,
+                     guint n_neighbors)
+{
+    GArray *list;
+
+    list = mrm_neighbor_list_new ();
+    g_array_append_vals (list, neighbors, n_neighbors);
+    mrm_neighbor_list_sort (list);
+    return list;
+}
+
+static void
+neighbor_list_assert_equal (GArray *list,
+                            GArray *expected)
+{
+    guint i;
+
+    g_assert_cmpuint (list->len, ==, expected->len);
+    for (i = 0; i < list->len; i++) {
+        const MrmNeighbor *a = &g_array_index (list, MrmNeighbor, i);
+        const MrmNeighbor *b = &g_array_index (expected, MrmNeighbor, i);
+
+        g_assert_cmpint (mrm_neighbor_compare (a, b), ==, 0);
+        g_assert_cmpuint (a->intra, ==, b->intra);
+        g_assert_cmpint (a->level, ==, b->level);
+        g_assert_cmpint (a->quality, ==, b->quality);
+    }
+}
+
+/* Applying the diff of two lists to the first one gives the second one */
+static void
+neighbor_list_assert_diff_apply (GArray *old_list,
+                                 GArray *new_list)
+{
+    MrmNeighborDelta *delta;
+    GArray *list;
+
+    list = mrm_neighbor_list_new ();
+    g_array_append_vals (list, old_list->data, old_list->len);
+
+    delta = mrm_neighbor_list_diff (old_list, new_list, 1);
+    if (delta) {
+        mrm_neighbor_list_apply (list, delta);
+        mrm_neighbor_delta_free (delta);
+    }
+
+    neighbor_list_assert_equal (list, new_list);
+    g_array_unref (list);
+}
+
+static void
+test_neighbor_list_sort (void)
+{
+    static const MrmNeighbor neighbors[] = {
+        NEIGHBOR (LTE,  1300, 7, -950),
+        NEIGHBOR (GSM,  30,   2, -800),
+        NEIGHBOR (LTE,  1300, 7, -990),
+        NEIGHBOR (UMTS, 10700, 5, -870),
+        NEIGHBOR (GSM,  30,   2, -810),
+    };
+    static const MrmNeighbor expected[] = {
+        NEIGHBOR (GSM,  30,   2, -800),
+        NEIGHBOR (UMTS, 10700, 5, -870),
+        NEIGHBOR (LTE,  1300, 7, -950),
+    };
+    GArray *list;
+    GArray *expected_list;
+
+    /* Duplicates keep their first measurement */
+    list = neighbor_list_build (neighbors, G_N_ELEMENTS (neighbors));
+    expected_list = mrm_neighbor_list_new ();
+    g_array_append_vals (expected_list, expected, G_N_ELEMENTS (expected));
+    neighbor_list_assert_equal (list, expected_list);
+
+    g_assert (mrm_neighbor_list_find (list, MRM_NEIGHBOR_RAT_UMTS, 10700, 5) != NULL);
+    g_assert (mrm_neighbor_list_find (list, MRM_NEIGHBOR_RAT_UMTS, 10700, 6) == NULL);
+
+    g_array_unref (expected_list);
+    g_array_unref (list);
+}
+
+static void
+test_neighbor_list_diff (void)
+{
+    static const MrmNeighbor old_neighbors[] = {
+        NEIGHBOR (LTE,  1300, 1, -950),
+        NEIGHBOR (LTE,  1300, 2, -960),
+        NEIGHBOR (LTE,  6300, 3, -1000),
+        NEIGHBOR (UMTS, 10700, 4, -870),
+    };
+    static const MrmNeighbor new_neighbors[] = {
+        NEIGHBOR (LTE,  1300, 2, -940),
+        NEIGHBOR (LTE,  6300, 3, -1000),
+        NEIGHBOR (GSM,  30,   6, -800),
+        NEIGHBOR (LTE,  1300, 2, -930),
+    };
+    MrmNeighborDelta *delta;
+    GArray *old_list;
+    GArray *new_list;
+
+    old_list = neighbor_list_build (old_neighbors, G_N_ELEMENTS (old_neighbors));
+    new_list = neighbor_list_build (new_neighbors, G_N_ELEMENTS (new_neighbors));
+
+    delta = mrm_neighbor_list_diff (old_list, new_list, 1234);
+    g_assert (delta != NULL);
+    g_assert_cmpint (delta->timestamp, ==, 1234);
+
+    /* New and updated neighbors, but not the unchanged one */
+    g_assert_cmpuint (delta->updated->len, ==, 2);
+    g_assert_cmpuint (g_array_index (delta->updated, MrmNeighbor, 0).rat, ==, MRM_NEIGHBOR_RAT_GSM);
+    g_assert_cmpuint (g_array_index (delta->updated, MrmNeighbor, 1).cell_id, ==, 2);
+    g_assert_cmpint (g_array_index (delta->updated, MrmNeighbor, 1).level, ==, -940);
+
+    /* Sorted as the lists, UMTS before LTE */
+    g_assert_cmpuint (delta->removed->len, ==, 2);
+    g_assert_cmpuint (g_array_index (delta->removed, MrmNeighbor, 0).cell_id, ==, 4);
+    g_assert_cmpuint (g_array_index (delta->removed, MrmNeighbor, 1).cell_id, ==, 1);
+    mrm_neighbor_delta_free (delta);
+
+    /* Nothing changed */
+    g_assert (mrm_neighbor_list_diff (new_list, new_list, 1234) == NULL);
+
+    g_array_unref (new_list);
+    g_array_unref (old_list);
+}
+
+static void
+test_neighbor_list_apply (void)
+{
+    static const MrmNeighbor old_neighbors[] = {
+        NEIGHBOR (GSM,  30,   1, -800),
+        NEIGHBOR (LTE,  1300, 1, -950),
+        NEIGHBOR (LTE,  1300, 2, -960),
+        NEIGHBOR (LTE,  6300, 3, -1000),
+        NEIGHBOR (UMTS, 10700, 4, -870),
+    };
+    static const MrmNeighbor new_neighbors[] = {
+        NEIGHBOR (LTE,  100,  9, -1100),
+        NEIGHBOR (LTE,  1300, 2, -940),
+        NEIGHBOR (LTE,  6300, 3, -1000),
+        NEIGHBOR (LTE,  9000, 8, -1050),
+        NEIGHBOR (UMTS, 10700, 5, -880),
+    };
+    GArray *old_list;
+    GArray *new_list;
+    GArray *empty_list;
+
+    old_list = neighbor_list_build (old_neighbors, G_N_ELEMENTS (old_neighbors));
+    new_list = neighbor_list_build (new_neighbors, G_N_ELEMENTS (new_neighbors));
+    empty_list = mrm_neighbor_list_new ();
+
+    neighbor_list_assert_diff_apply (old_list, new_list);
+    neighbor_list_assert_diff_apply (new_list, old_list);
+    neighbor_list_assert_diff_apply (old_list, old_list);
+    neighbor_list_assert_diff_apply (empty_list, new_list);
+    neighbor_list_assert_diff_apply (new_list, empty_list);
+
+    g_array_unref (empty_list);
+    g_array_unref (new_list);
+    g_array_unref (old_list);
+}
+
+/*****************************************************************************/
+/* Sample serialization */
+
+static MrmSample *
+sample_round_trip (const MrmSample *sample)
+{
+    GError *error = NULL;
+    MrmSample *parsed;
+    gchar *line;
+
+    line = mrm_sample_serialize (sample);
+    g_assert (strchr (line, '\n') == NULL);
+
+    parsed = mrm_sample_deserialize (line, &error);
+    g_assert_no_error (error);
+    g_assert (parsed != NULL);
+    g_free (line);
+
+    g_assert_cmpint (parsed->timestamp, ==, sample->timestamp);
+    g_assert_cmpuint (parsed->groups, ==, sample->groups);
+    g_assert_cmpuint (parsed->act, ==, sample->act);
+    g_assert_cmpuint (parsed->valid, ==, sample->valid);
+    g_assert_cmpint (parsed->gap, ==, sample->gap);
+    return parsed;
+}
+
+static void
+test_sample_serialize (void)
+{
+    MrmSample *sample;
+    MrmSample *parsed;
+    gdouble value;
+
+    sample = mrm_sample_new (123456789);
+    sample->groups = MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_TRAFFIC;
+    sample->act = MRM_DEVICE_ACT_LTE;
+    mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_LTE_RSRP, -95.5);
+    mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_LTE_RSRQ, 1.0 / 3.0);
+    mrm_sample_set_value (sample, MRM_SAMPLE_METRIC_TX_RATE, 0.0);
+
+    parsed = sample_round_trip (sample);
+
+    /* Values are written so that they are read back exactly */
+    g_assert (mrm_sample_get_value (parsed, MRM_SAMPLE_METRIC_LTE_RSRP, &value));
+    g_assert_cmpfloat (value, ==, -95.5);
+    g_assert (mrm_sample_get_value (parsed, MRM_SAMPLE_METRIC_LTE_RSRQ, &value));
+    g_assert_cmpfloat (value, ==, 1.0 / 3.0);
+    g_assert (mrm_sample_get_value (parsed, MRM_SAMPLE_METRIC_TX_RATE, &value));
+    g_assert_cmpfloat (value, ==, 0.0);
+    g_assert (!mrm_sample_get_value (parsed, MRM_SAMPLE_METRIC_LTE_SNR, &value));
+
+    mrm_sample_free (parsed);
+    mrm_sample_free (sample);
+}
+
+static void
+test_sample_serialize_gap (void)
+{
+    MrmSample *sample;
+    MrmSample *parsed;
+
+    sample = mrm_sample_new (42);
+    sample->groups = MRM_SAMPLE_GROUP_SIGNAL | MRM_SAMPLE_GROUP_POWER | MRM_SAMPLE_GROUP_TRAFFIC;
+    sample->gap = TRUE;
+
+    parsed = sample_round_trip (sample);
+
+    mrm_sample_free (parsed);
+    mrm_sample_free (sample);
+}
+
+static void
+test_sample_deserialize_invalid (void)
+{
+    static const gchar *lines[] = {
+        "",
+        "100",
+        "100\t1",
+        "abc\t1\t4",
+        "100\t-1\t4",
+        "100\t1\t4x",
+        "100\t1\t4\tgaps",
+        "100\t1\t4\tLTE RSRP",
+        "100\t1\t4\tLTE RSRP=",
+        "100\t1\t4\tLTE RSRP=-95.5dBm",
+        "100\t1\t4\tLTE XYZ=-95.5",
+        "100\t1\t4\t=-95.5",
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (lines); i++) {
+        GError *error = NULL;
+        MrmSample *sample;
+
+        sample = mrm_sample_deserialize (lines[i], &error);
+        g_assert (sample == NULL);
+        g_assert_error (error, MRM_CORE_ERROR, MRM_CORE_ERROR_INVALID_ARGS);
+        g_error_free (error);
+    }
+}
+
+/*****************************************************************************/
+
+gint
+main (gint argc, gchar **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/neighbor/list/sort",  test_neighbor_list_sort);
+    g_test_add_func ("/neighbor/list/diff",  test_neighbor_list_diff);
+    g_test_add_func ("/neighbor/list/apply", test_neighbor_list_apply);
+
+    g_test_add_func ("/sample/serialize",          test_sample_serialize);
+    g_test_add_func ("/sample/serialize/gap",      test_sample_serialize_gap);
+    g_test_add_func ("/sample/deserialize/invalid", test_sample_deserialize_invalid);
+
+    return g_test_run ();
+}